@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+	// keeps the optimizer from dropping a result.
+	template<typename T>
+	inline void DoNotOptimize(const T& value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+		static volatile const void* sink;
+		sink = &value;
+#else
+		asm volatile("" : : "r,m"(value) : "memory");
+#endif
+	}
+
+	struct Result {
+		std::string name;
+		double nanoseconds;
+	};
+
+	// best of `runs`, in nanoseconds per `iterations`.
+	template<typename Fn>
+	inline double Measure(uint32_t iterations, uint32_t runs, Fn&& fn) {
+		double best = 1e300;
+
+		for (uint32_t run = 0; run < runs; run++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			fn();
+			auto end = std::chrono::steady_clock::now();
+
+			double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+			best = std::min(best, ns / iterations);
+		}
+
+		return best;
+	}
+
+	// prints core vs std side by side.
+	inline void Report(const std::string& name, double core, double stl) {
+		std::cout << std::left << std::setw(40) << name
+			<< std::right << std::fixed << std::setprecision(2)
+			<< std::setw(10) << core << " ns"
+			<< std::setw(10) << stl << " ns"
+			<< std::setw(8) << stl / core << "x\n";
+	}
+
+	inline void Header(const std::string& group) {
+		std::cout << "\n" << std::left << std::setw(40) << group
+			<< std::right << std::setw(13) << "core"
+			<< std::setw(13) << "std"
+			<< std::setw(9) << "speedup\n";
+	}
+}
@@ -0,0 +1,215 @@
+#include "Benchmark.h"
+
+#include <datastructures/SmallVector.h>
+#include <datastructures/FlatHashMap.h>
+#include <datastructures/RingBuffer.h>
+#include <datastructures/RadixSort.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+constexpr uint32_t Runs = 5;
+
+// many short lived lists, the per-frame pattern (barriers, waits, attributes).
+void SmallVectorBenchmarks() {
+	Bench::Header("small_vector vs std::vector");
+
+	constexpr uint32_t Lists = 200000;
+
+	auto fill = [](auto& list, uint32_t count) {
+		for (uint32_t i = 0; i < count; i++)
+			list.push_back(i);
+		Bench::DoNotOptimize(list.data());
+	};
+
+	for (uint32_t count : { 4u, 8u, 32u })
+	{
+		double core = Bench::Measure(Lists, Runs, [&] {
+			for (uint32_t i = 0; i < Lists; i++) {
+				SmallVector<uint64_t, 8> list;
+				fill(list, count);
+			}
+		});
+
+		double stl = Bench::Measure(Lists, Runs, [&] {
+			for (uint32_t i = 0; i < Lists; i++) {
+				std::vector<uint64_t> list;
+				fill(list, count);
+			}
+		});
+
+		Bench::Report("build + destroy " + std::to_string(count) + " (inline 8)", core, stl);
+	}
+}
+
+void FlatHashMapBenchmarks() {
+	Bench::Header("flat_hash_map vs std::unordered_map");
+
+	constexpr uint32_t Count = 1 << 18;
+
+	std::mt19937_64 rng(42);
+	std::vector<uint64_t> keys(Count);
+	for (auto& key : keys)
+		key = rng();
+
+	std::vector<uint64_t> misses(Count);
+	for (auto& key : misses)
+		key = rng();
+
+	FlatHashMap<uint64_t, uint64_t> flat;
+	std::unordered_map<uint64_t, uint64_t> stl;
+
+	Bench::Report("insert",
+		Bench::Measure(Count, 1, [&] { for (uint64_t key : keys) flat[key] = key; }),
+		Bench::Measure(Count, 1, [&] { for (uint64_t key : keys) stl[key] = key; }));
+
+	auto lookup = [&](auto& map, const std::vector<uint64_t>& queries) {
+		uint64_t sum = 0;
+		for (uint64_t key : queries) {
+			auto it = map.find(key);
+			if (it != map.end())
+				sum += it->second;
+		}
+		Bench::DoNotOptimize(sum);
+	};
+
+	Bench::Report("lookup hit",
+		Bench::Measure(Count, Runs, [&] { lookup(flat, keys); }),
+		Bench::Measure(Count, Runs, [&] { lookup(stl, keys); }));
+
+	Bench::Report("lookup miss",
+		Bench::Measure(Count, Runs, [&] { lookup(flat, misses); }),
+		Bench::Measure(Count, Runs, [&] { lookup(stl, misses); }));
+
+	auto iterate = [](auto& map) {
+		uint64_t sum = 0;
+		for (auto it = map.begin(); it != map.end(); ++it)
+			sum += it->second;
+		Bench::DoNotOptimize(sum);
+	};
+
+	Bench::Report("iterate",
+		Bench::Measure(Count, Runs, [&] { iterate(flat); }),
+		Bench::Measure(Count, Runs, [&] { iterate(stl); }));
+
+	Bench::Report("erase",
+		Bench::Measure(Count, 1, [&] { for (uint64_t key : keys) flat.erase(key); }),
+		Bench::Measure(Count, 1, [&] { for (uint64_t key : keys) stl.erase(key); }));
+}
+
+// producers and consumers hammering one queue, against a mutex guarded std::queue.
+template<typename Queue>
+double QueueThroughput(Queue& queue, uint32_t producers, uint32_t consumers, uint64_t count) {
+	return Bench::Measure((uint32_t)count, 1, [&] {
+		std::atomic<uint64_t> popped{ 0 };
+		std::vector<std::thread> threads;
+
+		for (uint32_t p = 0; p < producers; p++)
+			threads.emplace_back([&, p] {
+				for (uint64_t i = p; i < count; i += producers)
+					while (!queue.try_push(i))
+						std::this_thread::yield();
+			});
+
+		for (uint32_t c = 0; c < consumers; c++)
+			threads.emplace_back([&] {
+				uint64_t value;
+				while (popped.load(std::memory_order_relaxed) < count)
+				{
+					if (queue.try_pop(value))
+						popped.fetch_add(1, std::memory_order_relaxed);
+					else
+						std::this_thread::yield();
+				}
+			});
+
+		for (auto& thread : threads)
+			thread.join();
+	});
+}
+
+template<typename T>
+struct LockedQueue {
+	bool try_push(const T& value) {
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push(value);
+		return true;
+	}
+
+	bool try_pop(T& out) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (queue.empty())
+			return false;
+		out = queue.front();
+		queue.pop();
+		return true;
+	}
+
+	std::mutex mutex;
+	std::queue<T> queue;
+};
+
+void RingBufferBenchmarks() {
+	Bench::Header("ring buffers vs locked std::queue");
+
+	constexpr uint64_t Count = 1 << 20;
+
+	{
+		auto spsc = std::make_unique<SPSCRingBuffer<uint64_t, 1024>>();
+		LockedQueue<uint64_t> locked;
+		Bench::Report("spsc 1 -> 1", QueueThroughput(*spsc, 1, 1, Count), QueueThroughput(locked, 1, 1, Count));
+	}
+
+	{
+		auto mpmc = std::make_unique<MPMCRingBuffer<uint64_t, 1024>>();
+		LockedQueue<uint64_t> locked;
+		Bench::Report("mpmc 2 -> 2", QueueThroughput(*mpmc, 2, 2, Count), QueueThroughput(locked, 2, 2, Count));
+	}
+}
+
+// sprite sort keys: few layers and pipelines, many textures.
+void RadixSortBenchmarks() {
+	Bench::Header("radix sort vs std::stable_sort");
+
+	constexpr uint32_t Count = 100000;
+
+	std::mt19937_64 rng(7);
+	std::vector<uint64_t> keys(Count);
+	for (auto& key : keys)
+		key = ((rng() % 4) << 48) | ((rng() % 8) << 28) | (rng() % 64);
+
+	std::vector<uint32_t> order, scratch;
+
+	double core = Bench::Measure(Count, Runs, [&] {
+		RadixSortIndices(keys.data(), Count, order, scratch);
+		Bench::DoNotOptimize(order.data());
+	});
+
+	double stl = Bench::Measure(Count, Runs, [&] {
+		order.resize(Count);
+		for (uint32_t i = 0; i < Count; i++)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+		Bench::DoNotOptimize(order.data());
+	});
+
+	Bench::Report("sort 100k sprite keys", core, stl);
+}
+
+int main() {
+	std::cout << "Temporal Core Benchmarks (best of " << Runs << ", per operation)\n";
+
+	SmallVectorBenchmarks();
+	FlatHashMapBenchmarks();
+	RingBufferBenchmarks();
+	RadixSortBenchmarks();
+
+	return 0;
+}
@@ -4,12 +4,18 @@
 
 #include "graphics/tests.h"
 #include "memory/tests.h"
+#include "jobs/tests.h"
+#include "datastructures/tests.h"
+#include "filesystem/tests.h"
 
 
 void AllTests() {
 
 	GRAPHICS_TESTS;
 	MEMORY_TESTS;
+	JOBS_TESTS;
+	DATASTRUCTURES_TESTS;
+	FILESYSTEM_TESTS;
 }
 
 #define _ AllTests(); RUN_TEST_SUITE();
\ No newline at end of file
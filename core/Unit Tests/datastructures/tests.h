@@ -0,0 +1,145 @@
+#pragma once
+/** Data Structure Tests
+*/
+
+#include <datastructures/SlotMap.h>
+#include <datastructures/SmallVector.h>
+#include <datastructures/FlatHashMap.h>
+#include <datastructures/RingBuffer.h>
+#include <datastructures/RadixSort.h>
+
+#include <string>
+
+namespace DataStructures {
+	void Tests() {
+
+		SlotMap<int> slots;
+
+		auto a = slots.insert(1);
+		auto b = slots.insert(2);
+		auto c = slots.insert(3);
+
+		TEST_CASE("slot map lookup", "[DataStructures]")
+			->Then("handles resolve to the value they were issued for")
+			->REQUIRE(*slots.get(b) == 2);
+
+		slots.erase(a);
+
+		TEST_CASE("slot map stale handles", "[DataStructures]")
+			->Then("an erased handle no longer resolves")
+			->REQUIRE(slots.get(a) == nullptr);
+
+		TEST_CASE("slot map swap remove", "[DataStructures]")
+			->Then("erasing keeps the remaining handles valid")
+			->REQUIRE(*slots.get(c) + *slots.get(b) == 5);
+
+		auto d = slots.insert(4);
+
+		TEST_CASE("slot map slot reuse", "[DataStructures]")
+			->Then("a reused slot gets a new generation")
+			->REQUIRE((d.Index() == a.Index() && d != a && slots.get(a) == nullptr) == true);
+
+		int sum = 0;
+		for (int value : slots)
+			sum += value;
+
+		TEST_CASE("slot map iteration", "[DataStructures]")
+			->Then("iteration walks the dense values")
+			->REQUIRE(sum == 9);
+
+		SlotMap<int, Handle64<int>> wide;
+		auto e = wide.insert(7);
+
+		TEST_CASE("slot map 64 bit handles", "[DataStructures]")
+			->Then("64 bit handles resolve")
+			->REQUIRE(*wide.get(e) == 7);
+
+		SmallVector<std::string, 4> small = { "a", "b", "c" };
+
+		TEST_CASE("small vector inline storage", "[DataStructures]")
+			->Then("stays inline up to its inline capacity")
+			->REQUIRE(small.is_inline() == true);
+
+		small.push_back("d");
+		small.push_back("e");
+
+		TEST_CASE("small vector spill", "[DataStructures]")
+			->Then("moves to the heap past the inline capacity and keeps its elements")
+			->REQUIRE((!small.is_inline() && small.size() == 5 && small[0] == "a" && small[4] == "e") == true);
+
+		SmallVector<std::string, 4> moved = std::move(small);
+
+		TEST_CASE("small vector move", "[DataStructures]")
+			->Then("moving steals the heap buffer")
+			->REQUIRE((moved.size() == 5 && small.empty() && small.is_inline()) == true);
+
+		// long enough to live on the heap, a dangling copy shows up.
+		std::string value = "an element long enough to skip the small string buffer";
+
+		SmallVector<std::string, 2> full = { value, "b" };
+		full.push_back(full[0]);
+
+		TEST_CASE("small vector self insert inline", "[DataStructures]")
+			->Then("pushing an element of a full inline vector copies it before spilling")
+			->REQUIRE((full.size() == 3 && full[2] == value && full[0] == value) == true);
+
+		full.push_back("d");
+		full.push_back(full[0]);
+
+		TEST_CASE("small vector self insert heap", "[DataStructures]")
+			->Then("pushing an element of a full heap vector copies it before growing")
+			->REQUIRE((full.size() == 5 && full[4] == value && full[0] == value) == true);
+
+		FlatHashMap<int, int> map;
+		for (int i = 0; i < 1000; i++)
+			map[i] = i * 2;
+
+		for (int i = 0; i < 1000; i += 2)
+			map.erase(i);
+
+		int found = 0;
+		for (int i = 0; i < 1000; i++)
+			found += map.contains(i) ? 1 : 0;
+
+		TEST_CASE("flat hash map insert erase", "[DataStructures]")
+			->Then("only the keys that were not erased remain")
+			->REQUIRE((found == 500 && map.size() == 500 && map.at(999) == 1998) == true);
+
+		// reinserting over tombstones must not duplicate keys.
+		for (int i = 0; i < 1000; i++)
+			map.insert({ i, -i });
+
+		int total = 0;
+		for (auto it = map.begin(); it != map.end(); ++it)
+			total++;
+
+		TEST_CASE("flat hash map reinsert", "[DataStructures]")
+			->Then("keeps one entry per key and existing values")
+			->REQUIRE((total == 1000 && map.at(1) == 2 && map.at(2) == -2) == true);
+
+		MPMCRingBuffer<int, 4> ring;
+		bool pushed = ring.try_push(1) && ring.try_push(2) && ring.try_push(3) && ring.try_push(4);
+		bool overflow = ring.try_push(5);
+
+		int first = 0;
+		ring.try_pop(first);
+
+		TEST_CASE("mpmc ring buffer", "[DataStructures]")
+			->Then("is bounded and first in first out")
+			->REQUIRE((pushed && !overflow && first == 1 && ring.size() == 3) == true);
+
+		std::vector<uint64_t> keys = { 5ull << 40, 3, 5ull << 40, 1, 0xFFull << 56, 3 };
+		std::vector<uint32_t> order, scratch;
+		RadixSortIndices(keys.data(), (uint32_t)keys.size(), order, scratch);
+
+		TEST_CASE("radix sort order", "[DataStructures]")
+			->Then("indices come out in ascending key order")
+			->REQUIRE((order == std::vector<uint32_t>{ 3, 1, 5, 0, 2, 4 }) == true);
+
+		TEST_CASE("radix sort stability", "[DataStructures]")
+			->Then("equal keys keep their submission order")
+			->REQUIRE((order[1] < order[2] && order[3] < order[4]) == true);
+	}
+}
+
+#define DATASTRUCTURES_TESTS DataStructures::Tests();
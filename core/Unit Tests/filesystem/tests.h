@@ -0,0 +1,89 @@
+#pragma once
+/** File System Tests
+*/
+
+#include <filesystem/Archive.h>
+#include <filesystem/AsyncIO.h>
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+
+namespace FileSystem {
+	void Tests() {
+
+		auto path = (std::filesystem::temp_directory_path() / "temporal_tests.pak").generic_string();
+
+		std::string text;
+		for (int i = 0; i < 64; i++)
+			text += "layout(location = 0) in vec4 Color;\n";
+
+		std::vector<uint8_t> stored = { 1, 2, 3, 4, 5, 6, 7 };
+		std::vector<uint8_t> packed(text.begin(), text.end());
+
+		ArchiveWriter writer;
+		writer.Add("stored", stored);
+		writer.Add("packed", packed, true);
+
+		Archive archive;
+		bool opened = writer.Write(path) && archive.Open(path);
+
+		TEST_CASE("archive round trip", "[FileSystem]")
+			->Then("a written archive opens with every blob")
+			->REQUIRE((opened && archive.GetEntryCount() == 2) == true);
+
+		const ArchiveEntry* entry = archive.Find("stored");
+		auto view = entry ? archive.GetView(*entry) : std::span<const uint8_t>{};
+
+		TEST_CASE("archive views", "[FileSystem]")
+			->Then("stored blobs are viewed in place, aligned")
+			->REQUIRE((std::equal(view.begin(), view.end(), stored.begin(), stored.end()) && (uintptr_t)view.data() % 16 == 0) == true);
+
+		entry = archive.Find("packed");
+		std::vector<uint8_t> unpacked;
+
+		TEST_CASE("archive compression", "[FileSystem]")
+			->Then("compressed blobs are smaller and read back unchanged")
+			->REQUIRE((entry && entry->size < entry->rawSize && archive.Read(*entry, unpacked) && unpacked == packed) == true);
+
+		TEST_CASE("archive missing blobs", "[FileSystem]")
+			->Then("unknown names are not found")
+			->REQUIRE(archive.Find("missing") == nullptr);
+
+		archive.Close();
+
+		AsyncIO::Initialize(8, 2);
+
+		std::vector<uint8_t> file = AsyncIO::ReadFile(path).get();
+
+		TEST_CASE("async whole file", "[FileSystem]")
+			->Then("a file is read back whole")
+			->REQUIRE((file.size() == std::filesystem::file_size(path)) == true);
+
+		std::vector<uint8_t> buffers[3] = { std::vector<uint8_t>(16), std::vector<uint8_t>(16), std::vector<uint8_t>(16) };
+		AsyncIO::Request requests[3] = {
+			{ .path = path, .offset = 0, .buffer = buffers[0] },
+			{ .path = path, .offset = 16, .buffer = buffers[1] },
+			{ .path = path + ".missing", .offset = 0, .buffer = buffers[2] },
+		};
+
+		std::atomic<int64_t> results[3];
+		AsyncIO::ReadBatch(requests, [&](uint32_t index, int64_t result) { results[index] = result; }, AsyncIO::Priority::High);
+		AsyncIO::WaitIdle();
+
+		TEST_CASE("async batched reads", "[FileSystem]")
+			->Then("every read lands in its own buffer at its offset")
+			->REQUIRE((results[0] == 16 && results[1] == 16 && std::equal(buffers[1].begin(), buffers[1].end(), file.begin() + 16)) == true);
+
+		TEST_CASE("async read errors", "[FileSystem]")
+			->Then("a missing file completes with an error")
+			->REQUIRE((results[2] < 0 && AsyncIO::GetPendingCount() == 0) == true);
+
+		AsyncIO::Shutdown();
+
+		std::error_code error;
+		std::filesystem::remove(path, error);
+	}
+}
+
+#define FILESYSTEM_TESTS FileSystem::Tests();
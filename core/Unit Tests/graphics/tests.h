@@ -1,6 +1,252 @@
 #pragma once
+/** Graphics Tests
+*/
+
+#include <graphics/Rendering/Shaders/CodeGraph.h>
+#include <graphics/Rendering/Shaders/ShaderGraph.h>
+#include <graphics/Rendering/Pipelines/RenderPipelines.h>
+#include <graphics/Rendering/Resolution/DynamicResolution.h>
+
+#include <cmath>
+#include <string>
+
 namespace Graphics {
 
+	// `left` op `right`, returns the operator node.
+	inline NodeId CodeGraphBinary(CodeGraph& graph, CG_Op op, ShaderVarType type, NodeId left, NodeId right) {
+		NodeId node = graph.Add(CG_Node::Operator(op, type));
+		graph.Connect(left, node, 0);
+		graph.Connect(right, node, 1);
+		return node;
+	}
+
+	inline void CodeGraphTests() {
+
+		std::string glsl;
+
+		{
+			// the example from CodeGraph.h, 0.5 * 2.0 folds to 1.0 and the multiply drops.
+			CodeGraph graph;
+			NodeId color = graph.Add(CG_Node::Variable(ShaderVarType::_VEC4_, "Color"));
+			NodeId scale = CodeGraphBinary(graph, CG_Op::Multiply, ShaderVarType::_FLOAT_, graph.Add(CG_Node::Constant(0.5f)), graph.Add(CG_Node::Constant(2.0f)));
+			NodeId result = CodeGraphBinary(graph, CG_Op::Multiply, ShaderVarType::_VEC4_, color, scale);
+
+			NodeId out = graph.Add(CG_Node::Output("FragColor"));
+			graph.Connect(result, out, 0);
+
+			bool emitted = graph.Emit(glsl);
+
+			TEST_CASE("code graph folding", "[Graphics]")
+				->Then("constants fold and multiplying by one is removed")
+				->REQUIRE((emitted && glsl == "\tFragColor = Color;\n") == true);
+		}
+
+		{
+			CodeGraph graph;
+			NodeId a = graph.Add(CG_Node::Variable(ShaderVarType::_FLOAT_, "a"));
+			NodeId b = graph.Add(CG_Node::Variable(ShaderVarType::_FLOAT_, "b"));
+
+			NodeId first = CodeGraphBinary(graph, CG_Op::Add, ShaderVarType::_FLOAT_, a, b);
+			NodeId second = CodeGraphBinary(graph, CG_Op::Add, ShaderVarType::_FLOAT_, b, a);
+			NodeId product = CodeGraphBinary(graph, CG_Op::Multiply, ShaderVarType::_FLOAT_, first, second);
+
+			NodeId out = graph.Add(CG_Node::Output("x"));
+			graph.Connect(product, out, 0);
+
+			bool emitted = graph.Emit(glsl);
+
+			TEST_CASE("code graph common subexpressions", "[Graphics]")
+				->Then("a repeated a + b is computed once into a local")
+				->REQUIRE((emitted && glsl == "\tfloat _cg0 = a + b;\n\tx = _cg0 * _cg0;\n") == true);
+		}
+
+		{
+			CodeGraph graph;
+			NodeId a = graph.Add(CG_Node::Variable(ShaderVarType::_FLOAT_, "a"));
+			NodeId b = graph.Add(CG_Node::Variable(ShaderVarType::_FLOAT_, "b"));
+			NodeId c = graph.Add(CG_Node::Variable(ShaderVarType::_FLOAT_, "c"));
+
+			NodeId inner = CodeGraphBinary(graph, CG_Op::Subtract, ShaderVarType::_FLOAT_, b, c);
+			NodeId outer = CodeGraphBinary(graph, CG_Op::Subtract, ShaderVarType::_FLOAT_, a, inner);
+
+			NodeId out = graph.Add(CG_Node::Output("x"));
+			graph.Connect(outer, out, 0);
+
+			bool emitted = graph.Emit(glsl);
+
+			TEST_CASE("code graph precedence", "[Graphics]")
+				->Then("a nested subtraction keeps its parentheses")
+				->REQUIRE((emitted && glsl == "\tx = a - (b - c);\n") == true);
+		}
+
+		{
+			CodeGraph graph;
+			NodeId big = graph.Add(CG_Node::Constant(3.0e38f));
+			NodeId overflow = CodeGraphBinary(graph, CG_Op::Multiply, ShaderVarType::_FLOAT_, big, big);
+
+			NodeId out = graph.Add(CG_Node::Output("x"));
+			graph.Connect(overflow, out, 0);
+
+			bool emitted = graph.Emit(glsl);
+
+			TEST_CASE("code graph overflow", "[Graphics]")
+				->Then("a fold that overflows is left unfolded")
+				->REQUIRE((emitted && glsl.find("inf") == std::string::npos && glsl.find('*') != std::string::npos) == true);
+		}
+
+		{
+			CodeGraph graph;
+			NodeId a = graph.Add(CG_Node::Variable(ShaderVarType::_FLOAT_, "a"));
+			NodeId first = graph.Add(CG_Node::Operator(CG_Op::Add, ShaderVarType::_FLOAT_));
+			NodeId second = CodeGraphBinary(graph, CG_Op::Add, ShaderVarType::_FLOAT_, a, first);
+			graph.Connect(a, first, 0);
+			graph.Connect(second, first, 1);
+
+			NodeId out = graph.Add(CG_Node::Output("x"));
+			graph.Connect(second, out, 0);
+
+			TEST_CASE("code graph cycles", "[Graphics]")
+				->Then("a graph with a cycle is rejected")
+				->REQUIRE(graph.Emit(glsl) == false);
+		}
+
+		{
+			CodeGraph graph;
+			NodeId a = graph.Add(CG_Node::Variable(ShaderVarType::_FLOAT_, "a"));
+			NodeId sum = graph.Add(CG_Node::Operator(CG_Op::Add, ShaderVarType::_FLOAT_));
+			graph.Connect(a, sum, 1);
+
+			NodeId out = graph.Add(CG_Node::Output("x"));
+			graph.Connect(sum, out, 0);
+
+			TEST_CASE("code graph unconnected inputs", "[Graphics]")
+				->Then("an operator missing an input is rejected")
+				->REQUIRE(graph.Emit(glsl) == false);
+		}
+	}
+
+	inline void DynamicResolutionTests() {
+
+		{
+			// the band around the default 60hz budget is [15, 18.3] ms.
+			DynamicResolution resolution;
+			bool changed = resolution.Update(15.5) || resolution.Update(18.0) || resolution.Update(16.0);
+
+			TEST_CASE("dynamic resolution band", "[Graphics]")
+				->Then("frame times inside the headroom keep the scale")
+				->REQUIRE((!changed && resolution.GetScale() == 1.0f) == true);
+		}
+
+		{
+			DynamicResolution resolution;
+			bool changed = resolution.Update(1000.0 / 30.0);
+
+			TEST_CASE("dynamic resolution over budget", "[Graphics]")
+				->Then("twice the budget halves the pixels, the scale drops by the square root")
+				->REQUIRE((changed && std::abs(resolution.GetScale() - 0.7071f) < 0.001f) == true);
+		}
+
+		{
+			// a cheap frame pulls the running average back into the band.
+			DynamicResolution resolution;
+			resolution.Update(17.0);
+			bool changed = resolution.Update(10.0);
+
+			TEST_CASE("dynamic resolution hysteresis", "[Graphics]")
+				->Then("one outlier is smoothed instead of moving the scale")
+				->REQUIRE((!changed && std::abs(resolution.GetAverage() - 15.6) < 1e-6) == true);
+		}
+
+		{
+			// every sample replaces the average.
+			DynamicResolution resolution({ .smoothing = 1.0f, .settleFrames = 0 });
+			resolution.Update(1000.0);
+			float low = resolution.GetScale();
+			bool pinned = !resolution.Update(1000.0);
+
+			resolution.Update(1.0);
+			float high = resolution.GetScale();
+
+			TEST_CASE("dynamic resolution clamping", "[Graphics]")
+				->Then("the scale stays within the min and max scale")
+				->REQUIRE((low == 0.5f && pinned && high == 1.0f) == true);
+		}
+
+		{
+			DynamicResolution resolution({ .settleFrames = 4 });
+			resolution.Update(1000.0);
+
+			bool settling = false;
+			for (int i = 0; i < 4; i++)
+				settling |= resolution.Update(1.0);
+
+			bool settled = resolution.Update(1.0);
+
+			TEST_CASE("dynamic resolution settle frames", "[Graphics]")
+				->Then("samples right after a change are ignored")
+				->REQUIRE((!settling && settled && resolution.GetScale() == 1.0f) == true);
+		}
+
+		{
+			DynamicResolution resolution({ .minScale = 0.5f, .maxScale = 0.5f, .alignment = 8 });
+			Resolution scaled = resolution.Apply({ 1918, 1080 });
+			Resolution tiny = resolution.Apply({ 5, 5 });
+
+			TEST_CASE("dynamic resolution alignment", "[Graphics]")
+				->Then("scaled sizes round down to the alignment and are never empty")
+				->REQUIRE((scaled.width == 952 && scaled.height == 536 && tiny.width == 5 && tiny.height == 5) == true);
+		}
+	}
+
+	inline void ShaderSwitchTests() {
+
+		// nothing is compiled, switches only shape the permutations and specialization data.
+		ShaderGraph graph(VK_NULL_HANDLE, "Shaders/switches.hlsl", VK_SHADER_STAGE_FRAGMENT_BIT);
+		ShaderVariant fog = graph.AddSwitch("FOG");
+		ShaderVariant shadows = graph.AddSwitch("SHADOWS", ShaderSwitchMode::Define);
+		ShaderVariant tint = graph.AddSwitch("TINT");
+		ShaderVariant skin = graph.AddSwitch("SKIN", ShaderSwitchMode::Define);
+
+		TEST_CASE("shader switch bits", "[Graphics]")
+			->Then("each switch gets the next bit in the order it was added")
+			->REQUIRE((fog == 1 && shadows == 2 && tint == 4 && skin == 8 && graph.GetModuleCount() == 0) == true);
+
+		TEST_CASE("shader switch permutations", "[Graphics]")
+			->Then("only define switches pick the module, packed in the order they were added")
+			->REQUIRE((graph.GetPermutation(0) == 0 && graph.GetPermutation(fog | tint) == 0
+				&& graph.GetPermutation(shadows) == 1 && graph.GetPermutation(skin | fog) == 2
+				&& graph.GetPermutation(fog | shadows | tint | skin) == 3) == true);
+
+		TEST_CASE("shader switch defines", "[Graphics]")
+			->Then("every define switch is passed to the compiler, specialization switches are not")
+			->REQUIRE((graph.GetDefines(0) == " -DSHADOWS=0 -DSKIN=0" && graph.GetDefines(1) == " -DSHADOWS=1 -DSKIN=0"
+				&& graph.GetDefines(2) == " -DSHADOWS=0 -DSKIN=1" && graph.GetDefines(3) == " -DSHADOWS=1 -DSKIN=1") == true);
+
+		{
+			ShaderSpecialization specialization = graph.GetSpecialization(tint | skin);
+
+			bool entries = specialization.entries.size() == 2
+				&& specialization.entries[0].constantID == 0 && specialization.entries[0].offset == 0 && specialization.entries[0].size == sizeof(VkBool32)
+				&& specialization.entries[1].constantID == 1 && specialization.entries[1].offset == sizeof(VkBool32) && specialization.entries[1].size == sizeof(VkBool32);
+			bool values = specialization.values.size() == 2
+				&& specialization.values[0] == VK_FALSE && specialization.values[1] == VK_TRUE;
+
+			TEST_CASE("shader switch specialization", "[Graphics]")
+				->Then("one packed VkBool32 per specialization switch, numbered from constant 0")
+				->REQUIRE((entries && values) == true);
+		}
+
+		{
+			ShaderGraph fragment(VK_NULL_HANDLE, RenderPipelines::Basic2D::FragmentShader.GetPath(), VK_SHADER_STAGE_FRAGMENT_BIT);
+			RenderPipelines::Basic2D::DefineFragment(fragment);
+
+			TEST_CASE("basic 2d opaque switch", "[Graphics]")
+				->Then("the opaque variant runs its own module built with OPAQUE=1")
+				->REQUIRE((fragment.GetPermutation(RenderPipelines::Basic2D::Opaque) == 1 && fragment.GetDefines(1) == " -DOPAQUE=1"
+					&& fragment.GetSpecialization(RenderPipelines::Basic2D::Opaque).entries.size() == 0) == true);
+		}
+	}
+
 	void Tests() {
 		TEST_CASE("some test", "[Graphics]")
 			->Then("something should happen")
@@ -10,6 +256,9 @@ namespace Graphics {
 			->Then("something should happen")
 			->REQUIRE(6 == 5);
 
+		CodeGraphTests();
+		DynamicResolutionTests();
+		ShaderSwitchTests();
 	}
 
 }
@@ -0,0 +1,48 @@
+#pragma once
+/** Job System Tests
+*/
+
+#include <jobs/JobSystem.h>
+
+namespace Jobs {
+	void Tests() {
+
+		Jobs::Initialize(4);
+
+		std::atomic<uint64_t> sum = 0;
+		Jobs::ParallelFor(1000, 64, [&](uint32_t begin, uint32_t end) {
+			for (uint32_t i = begin; i < end; i++)
+				sum += i;
+		});
+
+		TEST_CASE("parallel for", "[Jobs]")
+			->Then("every index is visited exactly once")
+			->REQUIRE(sum.load() == 499500);
+
+		std::atomic<int> stage = 0;
+		Counter first;
+		Counter second;
+
+		Jobs::Run([&] { stage = 1; }, &first);
+		Jobs::Run([&] { stage = stage == 1 ? 2 : -1; }, &second, &first);
+		Jobs::Wait(second);
+
+		TEST_CASE("job dependencies", "[Jobs]")
+			->Then("a dependent job only runs after its dependency")
+			->REQUIRE(stage.load() == 2);
+
+		std::atomic<uint32_t> nested = 0;
+		Jobs::ParallelFor(8, 1, [&](uint32_t, uint32_t) {
+			// waiting inside a worker keeps it executing other jobs.
+			Jobs::ParallelFor(16, 4, [&](uint32_t b, uint32_t e) { nested += e - b; });
+		});
+
+		TEST_CASE("nested parallel for", "[Jobs]")
+			->Then("workers waiting on children do not deadlock")
+			->REQUIRE(nested.load() == 128);
+
+		Jobs::Shutdown();
+	}
+}
+
+#define JOBS_TESTS Jobs::Tests();
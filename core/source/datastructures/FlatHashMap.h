@@ -0,0 +1,431 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAT_HASH_MAP_SSE2 1
+#include <emmintrin.h>
+#else
+#define FLAT_HASH_MAP_SSE2 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace FlatHash {
+
+	// one control byte per slot. full slots store the low 7 bits of the hash,
+	// so a probe compares 16 slots at once and only touches the keys that match.
+	enum Control : int8_t {
+		Empty = -128,
+		Deleted = -2,
+	};
+
+	constexpr size_t GroupSize = 16;
+
+	// bitmask of the slots in a group, bit i set means slot i.
+	struct BitMask {
+		uint32_t mask;
+
+		explicit operator bool() const { return mask != 0; }
+
+		uint32_t Lowest() const {
+#if defined(_MSC_VER) && !defined(__clang__)
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return (uint32_t)index;
+#else
+			return (uint32_t)__builtin_ctz(mask);
+#endif
+		}
+
+		BitMask& operator++() { mask &= mask - 1; return *this; }
+	};
+
+	struct Group {
+#if FLAT_HASH_MAP_SSE2
+		__m128i ctrl;
+
+		explicit Group(const int8_t* pos) : ctrl{ _mm_load_si128(reinterpret_cast<const __m128i*>(pos)) } {}
+
+		BitMask Match(int8_t h2) const {
+			return { (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)) };
+		}
+
+		BitMask MatchEmpty() const {
+			return { (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(Empty), ctrl)) };
+		}
+
+		// empty and deleted are the only negative bytes.
+		BitMask MatchFree() const {
+			return { (uint32_t)_mm_movemask_epi8(ctrl) };
+		}
+#else
+		const int8_t* ctrl;
+
+		explicit Group(const int8_t* pos) : ctrl{ pos } {}
+
+		BitMask Match(int8_t h2) const {
+			uint32_t mask = 0;
+			for (uint32_t i = 0; i < GroupSize; i++)
+				mask |= uint32_t(ctrl[i] == h2) << i;
+			return { mask };
+		}
+
+		BitMask MatchEmpty() const { return Match(Empty); }
+
+		BitMask MatchFree() const {
+			uint32_t mask = 0;
+			for (uint32_t i = 0; i < GroupSize; i++)
+				mask |= uint32_t(ctrl[i] < 0) << i;
+			return { mask };
+		}
+#endif
+	};
+
+	// spreads poor hashes (std::hash of integers is the identity) over all bits.
+	inline size_t Mix(size_t hash) {
+		uint64_t h = (uint64_t)hash;
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		return (size_t)h;
+	}
+}
+
+// open addressing hash map with SIMD group probing (swiss table layout).
+//
+// keys and values live inline in one flat slot array next to a byte array of
+// control bytes, a lookup is a hash, one 16 byte compare and usually a single
+// key compare. erased slots become tombstones until the next rehash.
+//
+// pointers and references are invalidated by any insert that grows the table.
+template<typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<K>>
+class FlatHashMap {
+public:
+	using key_type = K;
+	using mapped_type = V;
+	using value_type = std::pair<K, V>;
+
+	template<bool Const>
+	class Iterator {
+		using Map = std::conditional_t<Const, const FlatHashMap, FlatHashMap>;
+		using Value = std::conditional_t<Const, const value_type, value_type>;
+
+	public:
+		Iterator(Map* map, size_t index) : map{ map }, index{ index } { Skip(); }
+
+		Value& operator*() const { return map->slots[index]; }
+		Value* operator->() const { return &map->slots[index]; }
+
+		Iterator& operator++() { index++; Skip(); return *this; }
+
+		bool operator==(const Iterator& other) const { return index == other.index; }
+		bool operator!=(const Iterator& other) const { return index != other.index; }
+
+	private:
+		friend class FlatHashMap;
+
+		void Skip() {
+			while (index < map->cap && map->ctrl[index] < 0)
+				index++;
+		}
+
+		Map* map;
+		size_t index;
+	};
+
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+
+	FlatHashMap() = default;
+
+	explicit FlatHashMap(size_t count) {
+		reserve(count);
+	}
+
+	FlatHashMap(std::initializer_list<value_type> list) {
+		reserve(list.size());
+		for (const auto& value : list)
+			insert(value);
+	}
+
+	FlatHashMap(const FlatHashMap& other) {
+		reserve(other.count);
+		for (const auto& value : other)
+			insert(value);
+	}
+
+	FlatHashMap(FlatHashMap&& other) noexcept {
+		Swap(other);
+	}
+
+	~FlatHashMap() {
+		Destroy();
+	}
+
+	FlatHashMap& operator=(const FlatHashMap& other) {
+		if (this != &other) {
+			FlatHashMap copy(other);
+			Swap(copy);
+		}
+		return *this;
+	}
+
+	FlatHashMap& operator=(FlatHashMap&& other) noexcept {
+		if (this != &other) {
+			Destroy();
+			Swap(other);
+		}
+		return *this;
+	}
+
+	iterator find(const K& key) {
+		return { this, FindIndex(key) };
+	}
+
+	const_iterator find(const K& key) const {
+		return { this, FindIndex(key) };
+	}
+
+	bool contains(const K& key) const {
+		return FindIndex(key) != cap;
+	}
+
+	template<typename... Args>
+	std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+		size_t hash = Hash{}(key);
+
+		size_t index = FindIndex(key, hash);
+		if (index != cap)
+			return { iterator(this, index), false };
+
+		index = PrepareInsert(hash);
+		new (slots + index) value_type(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+		return { iterator(this, index), true };
+	}
+
+	std::pair<iterator, bool> insert(const value_type& value) {
+		return try_emplace(value.first, value.second);
+	}
+
+	std::pair<iterator, bool> insert(value_type&& value) {
+		return try_emplace(value.first, std::move(value.second));
+	}
+
+	template<typename U>
+	std::pair<iterator, bool> insert_or_assign(const K& key, U&& value) {
+		auto result = try_emplace(key, std::forward<U>(value));
+		if (!result.second)
+			result.first->second = std::forward<U>(value);
+		return result;
+	}
+
+	V& operator[](const K& key) {
+		return try_emplace(key).first->second;
+	}
+
+	V& at(const K& key) {
+		size_t index = FindIndex(key);
+		assert(index != cap && "Key Not Found.");
+		return slots[index].second;
+	}
+
+	const V& at(const K& key) const {
+		size_t index = FindIndex(key);
+		assert(index != cap && "Key Not Found.");
+		return slots[index].second;
+	}
+
+	size_t erase(const K& key) {
+		size_t index = FindIndex(key);
+		if (index == cap)
+			return 0;
+
+		EraseAt(index);
+		return 1;
+	}
+
+	iterator erase(iterator it) {
+		EraseAt(it.index);
+		++it;
+		return it;
+	}
+
+	void clear() {
+		for (size_t i = 0; i < cap; i++)
+			if (ctrl[i] >= 0)
+				slots[i].~value_type();
+
+		if (cap)
+			std::memset(ctrl, FlatHash::Empty, cap);
+
+		count = 0;
+		tombstones = 0;
+	}
+
+	void reserve(size_t n) {
+		size_t wanted = FlatHash::GroupSize;
+		while (MaxLoad(wanted) < n)
+			wanted *= 2;
+
+		if (wanted > cap)
+			Rehash(wanted);
+	}
+
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	size_t capacity() const { return cap; }
+
+	iterator begin() { return { this, 0 }; }
+	iterator end() { return { this, cap }; }
+	const_iterator begin() const { return { this, 0 }; }
+	const_iterator end() const { return { this, cap }; }
+
+private:
+	// 7/8 load factor, groups stay mostly probe-once.
+	static size_t MaxLoad(size_t capacity) { return capacity - capacity / 8; }
+
+	static size_t H1(size_t hash) { return FlatHash::Mix(hash) >> 7; }
+	static int8_t H2(size_t hash) { return (int8_t)(FlatHash::Mix(hash) & 0x7f); }
+
+	size_t FindIndex(const K& key) const {
+		return FindIndex(key, Hash{}(key));
+	}
+
+	size_t FindIndex(const K& key, size_t hash) const {
+		if (cap == 0)
+			return cap;
+
+		size_t groupMask = cap / FlatHash::GroupSize - 1;
+		size_t group = H1(hash) & groupMask;
+		int8_t h2 = H2(hash);
+
+		// triangular probing visits every group once when the group count is a power of two.
+		for (size_t step = 1; step <= groupMask + 1; step++)
+		{
+			size_t base = group * FlatHash::GroupSize;
+			FlatHash::Group g(ctrl + base);
+
+			for (FlatHash::BitMask match = g.Match(h2); match; ++match) {
+				size_t index = base + match.Lowest();
+				if (Eq{}(slots[index].first, key))
+					return index;
+			}
+
+			if (g.MatchEmpty())
+				return cap;
+
+			group = (group + step) & groupMask;
+		}
+
+		return cap;
+	}
+
+	// finds a free slot for `hash` and marks it full, growing if needed.
+	size_t PrepareInsert(size_t hash) {
+		if (count + tombstones + 1 > MaxLoad(cap))
+		{
+			// mostly tombstones, rehashing in place is enough.
+			if (cap && count + 1 <= MaxLoad(cap) / 2)
+				Rehash(cap);
+			else
+				Rehash(cap ? cap * 2 : FlatHash::GroupSize);
+		}
+
+		size_t index = FindFree(hash);
+		if (ctrl[index] == FlatHash::Deleted)
+			tombstones--;
+
+		ctrl[index] = H2(hash);
+		count++;
+		return index;
+	}
+
+	size_t FindFree(size_t hash) const {
+		size_t groupMask = cap / FlatHash::GroupSize - 1;
+		size_t group = H1(hash) & groupMask;
+
+		for (size_t step = 1; ; step++)
+		{
+			size_t base = group * FlatHash::GroupSize;
+			FlatHash::BitMask free = FlatHash::Group(ctrl + base).MatchFree();
+			if (free)
+				return base + free.Lowest();
+
+			group = (group + step) & groupMask;
+		}
+	}
+
+	void EraseAt(size_t index) {
+		slots[index].~value_type();
+		ctrl[index] = FlatHash::Deleted;
+		count--;
+		tombstones++;
+	}
+
+	void Rehash(size_t newCap) {
+		int8_t* oldCtrl = ctrl;
+		value_type* oldSlots = slots;
+		size_t oldCap = cap;
+
+		ctrl = static_cast<int8_t*>(::operator new(newCap, std::align_val_t(FlatHash::GroupSize)));
+		slots = static_cast<value_type*>(::operator new(newCap * sizeof(value_type), std::align_val_t(alignof(value_type))));
+		std::memset(ctrl, FlatHash::Empty, newCap);
+		cap = newCap;
+		tombstones = 0;
+
+		for (size_t i = 0; i < oldCap; i++)
+		{
+			if (oldCtrl[i] < 0)
+				continue;
+
+			size_t hash = Hash{}(oldSlots[i].first);
+			size_t index = FindFree(hash);
+			ctrl[index] = H2(hash);
+			new (slots + index) value_type(std::move(oldSlots[i]));
+			oldSlots[i].~value_type();
+		}
+
+		Free(oldCtrl, oldSlots);
+	}
+
+	void Destroy() {
+		clear();
+		Free(ctrl, slots);
+		ctrl = nullptr;
+		slots = nullptr;
+		cap = 0;
+	}
+
+	static void Free(int8_t* ctrl, value_type* slots) {
+		if (ctrl)
+			::operator delete(ctrl, std::align_val_t(FlatHash::GroupSize));
+		if (slots)
+			::operator delete(slots, std::align_val_t(alignof(value_type)));
+	}
+
+	void Swap(FlatHashMap& other) {
+		std::swap(ctrl, other.ctrl);
+		std::swap(slots, other.slots);
+		std::swap(cap, other.cap);
+		std::swap(count, other.count);
+		std::swap(tombstones, other.tombstones);
+	}
+
+	int8_t* ctrl = nullptr;
+	value_type* slots = nullptr;
+	size_t cap = 0;
+	size_t count = 0;
+	size_t tombstones = 0;
+};
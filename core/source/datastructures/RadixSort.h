@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// stable LSD radix sort of 64 bit keys, 8 bits per pass.
+//
+// sorts an index permutation instead of moving the payload: `order` receives
+// the indices of `keys` in ascending key order, equal keys keep their
+// submission order. passes whose digit is the same for every key are skipped,
+// so keys that only use a few bytes only pay for those bytes.
+// `scratch` is reused between calls to avoid reallocating.
+inline void RadixSortIndices(const uint64_t* keys, uint32_t count, std::vector<uint32_t>& order, std::vector<uint32_t>& scratch)
+{
+	order.resize(count);
+	scratch.resize(count);
+
+	for (uint32_t i = 0; i < count; i++)
+		order[i] = i;
+
+	if (count < 2)
+		return;
+
+	// one histogram per byte, built in a single walk over the keys.
+	uint32_t histograms[8][256];
+	std::memset(histograms, 0, sizeof(histograms));
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint64_t key = keys[i];
+		for (uint32_t pass = 0; pass < 8; pass++)
+			histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+	}
+
+	uint32_t* src = order.data();
+	uint32_t* dst = scratch.data();
+
+	for (uint32_t pass = 0; pass < 8; pass++)
+	{
+		uint32_t* counts = histograms[pass];
+		uint32_t shift = pass * 8;
+
+		// every key has the same digit, this pass would not move anything.
+		if (counts[(keys[0] >> shift) & 0xFF] == count)
+			continue;
+
+		uint32_t offsets[256];
+		uint32_t sum = 0;
+		for (uint32_t digit = 0; digit < 256; digit++)
+		{
+			offsets[digit] = sum;
+			sum += counts[digit];
+		}
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint32_t index = src[i];
+			dst[offsets[(keys[index] >> shift) & 0xFF]++] = index;
+		}
+
+		std::swap(src, dst);
+	}
+
+	// an odd number of passes left the result in the scratch buffer.
+	if (src != order.data())
+		order.swap(scratch);
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// fixed capacity, lock-free single producer / single consumer queue.
+// one thread may push and one (other) thread may pop concurrently.
+template<typename T, size_t Capacity>
+class SPSCRingBuffer {
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	bool try_push(const T& value) {
+		return emplace(value);
+	}
+
+	bool try_push(T&& value) {
+		return emplace(std::move(value));
+	}
+
+	bool try_pop(T& out) {
+		size_t head = this->head.load(std::memory_order_relaxed);
+
+		if (head == cachedTail) {
+			cachedTail = tail.load(std::memory_order_acquire);
+			if (head == cachedTail)
+				return false;
+		}
+
+		out = std::move(slots[head & Mask]);
+		this->head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// approximate when called while the other side is active.
+	size_t size() const {
+		return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+	}
+
+	bool empty() const { return size() == 0; }
+
+	static constexpr size_t capacity() { return Capacity; }
+
+private:
+	template<typename U>
+	bool emplace(U&& value) {
+		size_t tail = this->tail.load(std::memory_order_relaxed);
+
+		if (tail - cachedHead == Capacity) {
+			cachedHead = head.load(std::memory_order_acquire);
+			if (tail - cachedHead == Capacity)
+				return false;
+		}
+
+		slots[tail & Mask] = std::forward<U>(value);
+		this->tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	static constexpr size_t Mask = Capacity - 1;
+
+	// consumer side
+	alignas(64) std::atomic<size_t> head{ 0 };
+	size_t cachedTail = 0;
+
+	// producer side
+	alignas(64) std::atomic<size_t> tail{ 0 };
+	size_t cachedHead = 0;
+
+	alignas(64) std::array<T, Capacity> slots{};
+};
+
+// fixed capacity, lock-free multi producer / multi consumer queue.
+// each slot carries a sequence number that tells producers and consumers
+// whose turn it is, so neither side ever takes a lock (Vyukov's bounded queue).
+template<typename T, size_t Capacity>
+class MPMCRingBuffer {
+	static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	MPMCRingBuffer() {
+		for (size_t i = 0; i < Capacity; i++)
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	bool try_push(const T& value) {
+		return emplace(value);
+	}
+
+	bool try_push(T&& value) {
+		return emplace(std::move(value));
+	}
+
+	bool try_pop(T& out) {
+		size_t pos = head.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			Slot& slot = slots[pos & Mask];
+			size_t sequence = slot.sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+
+			if (diff == 0) {
+				if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					out = std::move(slot.value);
+					// free for the producer one lap ahead.
+					slot.sequence.store(pos + Capacity, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0) {
+				return false;
+			}
+			else {
+				pos = head.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// approximate when called while other threads are active.
+	size_t size() const {
+		size_t tail = this->tail.load(std::memory_order_acquire);
+		size_t head = this->head.load(std::memory_order_acquire);
+		return tail > head ? tail - head : 0;
+	}
+
+	bool empty() const { return size() == 0; }
+
+	static constexpr size_t capacity() { return Capacity; }
+
+private:
+	template<typename U>
+	bool emplace(U&& value) {
+		size_t pos = tail.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			Slot& slot = slots[pos & Mask];
+			size_t sequence = slot.sequence.load(std::memory_order_acquire);
+			intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+			if (diff == 0) {
+				if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					slot.value = std::forward<U>(value);
+					slot.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0) {
+				return false;
+			}
+			else {
+				pos = tail.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	static constexpr size_t Mask = Capacity - 1;
+
+	struct Slot {
+		std::atomic<size_t> sequence;
+		T value{};
+	};
+
+	alignas(64) std::atomic<size_t> head{ 0 };
+	alignas(64) std::atomic<size_t> tail{ 0 };
+	alignas(64) std::array<Slot, Capacity> slots;
+};
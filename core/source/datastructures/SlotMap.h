@@ -0,0 +1,180 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// typed, generational handle into a SlotMap.
+// packs a slot index and the slot's generation into a single integer, a
+// handle whose generation no longer matches its slot is stale. the zero
+// value is never issued and means "no handle".
+template<typename Tag, typename Storage = uint32_t>
+struct Handle {
+	static_assert(std::is_same_v<Storage, uint32_t> || std::is_same_v<Storage, uint64_t>, "handles are 32 or 64 bit");
+
+	// 32 bit: 1M slots, 4096 generations. 64 bit: 4G slots, 4G generations.
+	static constexpr uint32_t IndexBits = sizeof(Storage) == 4 ? 20 : 32;
+	static constexpr uint32_t GenerationBits = sizeof(Storage) * 8 - IndexBits;
+
+	static constexpr Storage IndexMask = (Storage(1) << IndexBits) - 1;
+	static constexpr Storage GenerationMask = (Storage(1) << GenerationBits) - 1;
+
+	Storage value = 0;
+
+	constexpr Handle() = default;
+	constexpr Handle(uint32_t index, uint32_t generation)
+		: value{ (Storage(generation & GenerationMask) << IndexBits) | (Storage(index) & IndexMask) } {}
+
+	constexpr uint32_t Index() const { return uint32_t(value & IndexMask); }
+	constexpr uint32_t Generation() const { return uint32_t((value >> IndexBits) & GenerationMask); }
+	constexpr bool IsValid() const { return value != 0; }
+
+	constexpr bool operator==(const Handle& other) const { return value == other.value; }
+	constexpr bool operator!=(const Handle& other) const { return value != other.value; }
+};
+
+template<typename Tag>
+using Handle32 = Handle<Tag, uint32_t>;
+
+template<typename Tag>
+using Handle64 = Handle<Tag, uint64_t>;
+
+// generational slot map.
+//
+// values live densely packed in insertion order (swap-removed on erase) so
+// iteration is a linear walk, lookups go handle -> slot -> dense index in O(1).
+// erasing bumps the slot's generation so every outstanding handle to it
+// stops resolving.
+template<typename T, typename THandle = Handle32<T>>
+class SlotMap {
+public:
+	using handle_type = THandle;
+	using value_type = T;
+	using iterator = typename std::vector<T>::iterator;
+	using const_iterator = typename std::vector<T>::const_iterator;
+
+	THandle insert(T value) {
+		return emplace(std::move(value));
+	}
+
+	template<typename... Args>
+	THandle emplace(Args&&... args) {
+		uint32_t slotIndex;
+
+		if (freeHead != InvalidIndex) {
+			slotIndex = freeHead;
+			freeHead = slots[slotIndex].dense;
+		}
+		else {
+			slotIndex = (uint32_t)slots.size();
+			assert(slotIndex < THandle::IndexMask && "SlotMap is out of slots.");
+			slots.push_back({ InvalidIndex, 1 });
+		}
+
+		Slot& slot = slots[slotIndex];
+		slot.dense = (uint32_t)values.size();
+
+		values.emplace_back(std::forward<Args>(args)...);
+		denseToSlot.push_back(slotIndex);
+
+		return THandle(slotIndex, slot.generation);
+	}
+
+	bool erase(THandle handle) {
+		if (!contains(handle))
+			return false;
+
+		uint32_t slotIndex = handle.Index();
+		uint32_t dense = slots[slotIndex].dense;
+		uint32_t last = (uint32_t)values.size() - 1;
+
+		// keep the values packed, the last one moves into the hole.
+		if (dense != last) {
+			values[dense] = std::move(values[last]);
+			denseToSlot[dense] = denseToSlot[last];
+			slots[denseToSlot[dense]].dense = dense;
+		}
+
+		values.pop_back();
+		denseToSlot.pop_back();
+
+		Slot& slot = slots[slotIndex];
+		// generation 0 is reserved so a live handle is never zero.
+		slot.generation = (slot.generation + 1) & THandle::GenerationMask;
+		if (slot.generation == 0)
+			slot.generation = 1;
+
+		slot.dense = freeHead;
+		freeHead = slotIndex;
+
+		return true;
+	}
+
+	bool contains(THandle handle) const {
+		uint32_t index = handle.Index();
+		return handle.IsValid()
+			&& index < slots.size()
+			&& slots[index].generation == handle.Generation()
+			&& slots[index].dense < values.size()
+			&& denseToSlot[slots[index].dense] == index;
+	}
+
+	// nullptr for stale or invalid handles.
+	T* get(THandle handle) {
+		return contains(handle) ? &values[slots[handle.Index()].dense] : nullptr;
+	}
+
+	const T* get(THandle handle) const {
+		return contains(handle) ? &values[slots[handle.Index()].dense] : nullptr;
+	}
+
+	T& operator[](THandle handle) {
+		assert(contains(handle) && "Stale Or Invalid Handle.");
+		return values[slots[handle.Index()].dense];
+	}
+
+	// handle of the value at `dense` position, for iterating with handles.
+	THandle handle_at(size_t dense) const {
+		uint32_t slotIndex = denseToSlot[dense];
+		return THandle(slotIndex, slots[slotIndex].generation);
+	}
+
+	void clear() {
+		for (size_t i = values.size(); i > 0; i--)
+			erase(handle_at(i - 1));
+	}
+
+	void reserve(size_t count) {
+		values.reserve(count);
+		denseToSlot.reserve(count);
+		slots.reserve(count);
+	}
+
+	size_t size() const { return values.size(); }
+	bool empty() const { return values.empty(); }
+
+	T* data() { return values.data(); }
+	const T* data() const { return values.data(); }
+
+	iterator begin() { return values.begin(); }
+	iterator end() { return values.end(); }
+	const_iterator begin() const { return values.begin(); }
+	const_iterator end() const { return values.end(); }
+
+private:
+	static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+	struct Slot {
+		// dense index while alive, next free slot while free.
+		uint32_t dense;
+		uint32_t generation;
+	};
+
+	std::vector<T> values;
+	std::vector<uint32_t> denseToSlot;
+	std::vector<Slot> slots;
+	uint32_t freeHead = InvalidIndex;
+};
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// vector with inline storage for the first N elements.
+// only spills to the heap past N, so short per-frame lists never allocate.
+// mirrors the std::vector interface it is used through.
+template<typename T, size_t N>
+class SmallVector {
+	static_assert(N > 0, "SmallVector needs inline capacity");
+
+public:
+	using value_type = T;
+	using size_type = size_t;
+	using iterator = T*;
+	using const_iterator = const T*;
+	using reference = T&;
+	using const_reference = const T&;
+
+	SmallVector() = default;
+
+	explicit SmallVector(size_t count, const T& value = T()) {
+		assign(count, value);
+	}
+
+	SmallVector(std::initializer_list<T> list) {
+		reserve(list.size());
+		for (const auto& value : list)
+			emplace_back(value);
+	}
+
+	template<typename It, typename = typename std::iterator_traits<It>::iterator_category>
+	SmallVector(It first, It last) {
+		for (; first != last; ++first)
+			emplace_back(*first);
+	}
+
+	SmallVector(const SmallVector& other) {
+		reserve(other.count);
+		std::uninitialized_copy(other.begin(), other.end(), ptr);
+		count = other.count;
+	}
+
+	SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+		MoveFrom(std::move(other));
+	}
+
+	~SmallVector() {
+		clear();
+		Release();
+	}
+
+	SmallVector& operator=(const SmallVector& other) {
+		if (this != &other) {
+			clear();
+			reserve(other.count);
+			std::uninitialized_copy(other.begin(), other.end(), ptr);
+			count = other.count;
+		}
+		return *this;
+	}
+
+	SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+		if (this != &other) {
+			clear();
+			Release();
+			MoveFrom(std::move(other));
+		}
+		return *this;
+	}
+
+	void assign(size_t n, const T& value) {
+		clear();
+		reserve(n);
+		std::uninitialized_fill_n(ptr, n, value);
+		count = n;
+	}
+
+	template<typename... Args>
+	T& emplace_back(Args&&... args) {
+		if (count == cap)
+			return GrowAndEmplace(std::forward<Args>(args)...);
+
+		T* slot = new (ptr + count) T(std::forward<Args>(args)...);
+		count++;
+		return *slot;
+	}
+
+	void push_back(const T& value) { emplace_back(value); }
+	void push_back(T&& value) { emplace_back(std::move(value)); }
+
+	void pop_back() {
+		assert(count > 0);
+		ptr[--count].~T();
+	}
+
+	iterator erase(const_iterator pos) {
+		T* at = const_cast<T*>(pos);
+		std::move(at + 1, end(), at);
+		pop_back();
+		return at;
+	}
+
+	void resize(size_t n) {
+		if (n < count) {
+			std::destroy(ptr + n, ptr + count);
+		}
+		else {
+			reserve(n);
+			std::uninitialized_value_construct(ptr + count, ptr + n);
+		}
+		count = n;
+	}
+
+	void resize(size_t n, const T& value) {
+		if (n < count) {
+			std::destroy(ptr + n, ptr + count);
+		}
+		else {
+			reserve(n);
+			std::uninitialized_fill(ptr + count, ptr + n, value);
+		}
+		count = n;
+	}
+
+	void reserve(size_t n) {
+		if (n > cap)
+			Grow(n);
+	}
+
+	void clear() {
+		std::destroy(ptr, ptr + count);
+		count = 0;
+	}
+
+	T& operator[](size_t i) { assert(i < count); return ptr[i]; }
+	const T& operator[](size_t i) const { assert(i < count); return ptr[i]; }
+
+	T& front() { return ptr[0]; }
+	const T& front() const { return ptr[0]; }
+	T& back() { return ptr[count - 1]; }
+	const T& back() const { return ptr[count - 1]; }
+
+	T* data() { return ptr; }
+	const T* data() const { return ptr; }
+
+	iterator begin() { return ptr; }
+	iterator end() { return ptr + count; }
+	const_iterator begin() const { return ptr; }
+	const_iterator end() const { return ptr + count; }
+
+	size_t size() const { return count; }
+	size_t capacity() const { return cap; }
+	bool empty() const { return count == 0; }
+
+	// true while the elements still live in the inline buffer.
+	bool is_inline() const { return ptr == Inline(); }
+
+private:
+	T* Inline() { return std::launder(reinterpret_cast<T*>(storage)); }
+	const T* Inline() const { return std::launder(reinterpret_cast<const T*>(storage)); }
+
+	static T* Allocate(size_t n) {
+		return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+	}
+
+	void Grow(size_t n) {
+		n = std::max(n, cap * 2);
+
+		T* heap = Allocate(n);
+		std::uninitialized_move(ptr, ptr + count, heap);
+		std::destroy(ptr, ptr + count);
+
+		Release();
+
+		ptr = heap;
+		cap = n;
+	}
+
+	// the arguments may refer to an element, the new one is built before the old ones move out.
+	template<typename... Args>
+	T& GrowAndEmplace(Args&&... args) {
+		size_t n = cap * 2;
+
+		T* heap = Allocate(n);
+		T* slot;
+		try {
+			slot = new (heap + count) T(std::forward<Args>(args)...);
+		}
+		catch (...) {
+			::operator delete(heap, std::align_val_t(alignof(T)));
+			throw;
+		}
+
+		std::uninitialized_move(ptr, ptr + count, heap);
+		std::destroy(ptr, ptr + count);
+
+		Release();
+
+		ptr = heap;
+		cap = n;
+		count++;
+		return *slot;
+	}
+
+	void Release() {
+		if (!is_inline())
+			::operator delete(ptr, std::align_val_t(alignof(T)));
+
+		ptr = Inline();
+		cap = N;
+	}
+
+	void MoveFrom(SmallVector&& other) {
+		if (other.is_inline()) {
+			std::uninitialized_move(other.begin(), other.end(), ptr);
+			count = other.count;
+			other.clear();
+		}
+		else {
+			// steal the heap buffer
+			ptr = other.ptr;
+			cap = other.cap;
+			count = other.count;
+
+			other.ptr = other.Inline();
+			other.cap = N;
+			other.count = 0;
+		}
+	}
+
+	alignas(T) unsigned char storage[sizeof(T) * N];
+	T* ptr = Inline();
+	size_t count = 0;
+	size_t cap = N;
+};
@@ -23,3 +23,10 @@
 #include <algorithm>
 
 #include <type_traits>
+
+// core containers
+#include "SmallVector.h"
+#include "FlatHashMap.h"
+#include "RingBuffer.h"
+#include "SlotMap.h"
+#include "RadixSort.h"
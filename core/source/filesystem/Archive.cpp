@@ -0,0 +1,481 @@
+#include "Archive.h"
+
+#include <debug/Console.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	// "TPAK"
+	constexpr uint32_t ArchiveMagic = 0x4B415054;
+	constexpr uint32_t ArchiveVersion = 1;
+
+	struct ArchiveHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t count;
+		uint32_t alignment;
+	};
+
+	static_assert(sizeof(ArchiveHeader) == 16 && sizeof(FileSystem::ArchiveEntry) == 32, "Archive Layout Changed, Bump ArchiveVersion.");
+
+	// LZ77 in the LZ4 block layout: a token holding the literal and match lengths,
+	// the literals, then a 16 bit offset back into the output. the last sequence
+	// only has literals. small and dependency free, decoding is a copy loop.
+	constexpr uint32_t MinMatch = 4;
+	constexpr uint32_t HashBits = 12;
+
+	uint32_t Read32(const uint8_t* p)
+	{
+		uint32_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	void WriteLength(std::vector<uint8_t>& out, size_t length)
+	{
+		for (; length >= 255; length -= 255)
+			out.push_back(255);
+		out.push_back((uint8_t)length);
+	}
+
+	void WriteSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength)
+	{
+		size_t match = matchLength ? matchLength - MinMatch : 0;
+
+		out.push_back((uint8_t)((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(match, 15)));
+		if (literalCount >= 15)
+			WriteLength(out, literalCount - 15);
+
+		out.insert(out.end(), literals, literals + literalCount);
+
+		if (!matchLength)
+			return;
+
+		out.push_back((uint8_t)(offset & 0xff));
+		out.push_back((uint8_t)(offset >> 8));
+
+		if (match >= 15)
+			WriteLength(out, match - 15);
+	}
+
+	std::vector<uint8_t> Compress(std::span<const uint8_t> data)
+	{
+		std::vector<uint8_t> out;
+		out.reserve(data.size());
+
+		std::vector<int64_t> table(1u << HashBits, -1);
+
+		const uint8_t* in = data.data();
+		size_t count = data.size();
+		size_t anchor = 0;
+		size_t i = 0;
+
+		while (i + MinMatch <= count)
+		{
+			uint32_t value = Read32(in + i);
+			uint32_t slot = (value * 2654435761u) >> (32 - HashBits);
+
+			int64_t candidate = table[slot];
+			table[slot] = (int64_t)i;
+
+			if (candidate < 0 || i - (size_t)candidate > 0xffff || Read32(in + candidate) != value)
+			{
+				i++;
+				continue;
+			}
+
+			size_t length = MinMatch;
+			while (i + length < count && in[candidate + length] == in[i + length])
+				length++;
+
+			WriteSequence(out, in + anchor, i - anchor, i - (size_t)candidate, length);
+
+			i += length;
+			anchor = i;
+		}
+
+		WriteSequence(out, in + anchor, count - anchor, 0, 0);
+		return out;
+	}
+
+	bool ReadLength(const uint8_t*& ip, const uint8_t* end, size_t& length)
+	{
+		uint8_t byte;
+		do {
+			if (ip == end)
+				return false;
+
+			byte = *ip++;
+			length += byte;
+		} while (byte == 255);
+
+		return true;
+	}
+
+	// every length and offset is checked, a corrupt blob fails instead of writing out of bounds.
+	bool Decompress(std::span<const uint8_t> data, uint8_t* out, size_t outSize)
+	{
+		const uint8_t* ip = data.data();
+		const uint8_t* end = ip + data.size();
+		size_t op = 0;
+
+		while (ip < end)
+		{
+			uint8_t token = *ip++;
+
+			size_t literals = token >> 4;
+			if (literals == 15 && !ReadLength(ip, end, literals))
+				return false;
+
+			if (literals > (size_t)(end - ip) || literals > outSize - op)
+				return false;
+
+			std::memcpy(out + op, ip, literals);
+			ip += literals;
+			op += literals;
+
+			// the last sequence ends the block.
+			if (ip == end)
+				break;
+
+			if (end - ip < 2)
+				return false;
+
+			size_t offset = ip[0] | (ip[1] << 8);
+			ip += 2;
+
+			size_t length = token & 15;
+			if (length == 15 && !ReadLength(ip, end, length))
+				return false;
+			length += MinMatch;
+
+			if (offset == 0 || offset > op || length > outSize - op)
+				return false;
+
+			// byte by byte, a match may overlap what it is copying.
+			for (size_t n = 0; n < length; n++, op++)
+				out[op] = out[op - offset];
+		}
+
+		return op == outSize;
+	}
+}
+
+namespace FileSystem {
+
+	Archive::~Archive()
+	{
+		Close();
+	}
+
+	bool Archive::Open(const std::string& path)
+	{
+		Close();
+
+#ifdef _WIN32
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			file = nullptr;
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			Close();
+			return false;
+		}
+
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping)
+		{
+			Close();
+			return false;
+		}
+
+		base = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		size = (size_t)fileSize.QuadPart;
+#else
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+
+		struct stat info;
+		if (fstat(fd, &info) != 0 || info.st_size == 0)
+		{
+			close(fd);
+			return false;
+		}
+
+		// the mapping keeps the file alive on its own.
+		void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+
+		if (view != MAP_FAILED)
+		{
+			base = (const uint8_t*)view;
+			size = (size_t)info.st_size;
+		}
+#endif
+
+		if (!base)
+		{
+			Close();
+			return false;
+		}
+
+		ArchiveHeader header;
+		if (size < sizeof(header))
+		{
+			Close();
+			return false;
+		}
+
+		std::memcpy(&header, base, sizeof(header));
+
+		if (header.magic != ArchiveMagic || header.version != ArchiveVersion || (size - sizeof(header)) / sizeof(ArchiveEntry) < header.count)
+		{
+			Console::Warn("Not A Valid Archive: ", path);
+			Close();
+			return false;
+		}
+
+		entries = { reinterpret_cast<const ArchiveEntry*>(base + sizeof(header)), header.count };
+
+		// checked once here so lookups can trust the table.
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			const ArchiveEntry& entry = entries[i];
+
+			bool sorted = i == 0 || entries[i - 1].hash < entry.hash;
+			bool inside = entry.offset <= size && entry.size <= size - entry.offset;
+
+			if (!sorted || !inside)
+			{
+				Console::Warn("Corrupt Archive: ", path);
+				Close();
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void Archive::Close()
+	{
+#ifdef _WIN32
+		if (base)
+			UnmapViewOfFile(base);
+		if (mapping)
+			CloseHandle(mapping);
+		if (file)
+			CloseHandle(file);
+
+		mapping = nullptr;
+		file = nullptr;
+#else
+		if (base)
+			munmap(const_cast<uint8_t*>(base), size);
+#endif
+
+		base = nullptr;
+		size = 0;
+		entries = {};
+	}
+
+	bool Archive::IsOpen() const
+	{
+		return base != nullptr;
+	}
+
+	uint64_t Archive::Hash(std::string_view name)
+	{
+		uint64_t hash = 14695981039346656037ull;
+
+		for (unsigned char c : name)
+		{
+			hash ^= c;
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
+	}
+
+	const ArchiveEntry* Archive::Find(uint64_t hash) const
+	{
+		auto found = std::lower_bound(entries.begin(), entries.end(), hash, [](const ArchiveEntry& entry, uint64_t hash) { return entry.hash < hash; });
+
+		if (found == entries.end() || found->hash != hash)
+			return nullptr;
+
+		return &*found;
+	}
+
+	const ArchiveEntry* Archive::Find(std::string_view name) const
+	{
+		return Find(Hash(name));
+	}
+
+	std::span<const uint8_t> Archive::GetView(const ArchiveEntry& entry) const
+	{
+		if (entry.flags & ArchiveCompressed)
+			return {};
+
+		return { base + entry.offset, entry.size };
+	}
+
+	bool Archive::Read(const ArchiveEntry& entry, std::vector<uint8_t>& data) const
+	{
+		std::span<const uint8_t> stored{ base + entry.offset, entry.size };
+
+		if (!(entry.flags & ArchiveCompressed))
+		{
+			data.assign(stored.begin(), stored.end());
+			return true;
+		}
+
+		data.resize(entry.rawSize);
+		return Decompress(stored, data.data(), data.size());
+	}
+
+	uint32_t Archive::GetEntryCount() const
+	{
+		return (uint32_t)entries.size();
+	}
+
+	ArchiveWriter::ArchiveWriter(uint32_t alignment)
+		: alignment{ std::max(alignment, 8u) }
+	{
+	}
+
+	void ArchiveWriter::Add(std::string_view name, std::span<const uint8_t> data, bool compress)
+	{
+		Add(Archive::Hash(name), data, compress);
+	}
+
+	void ArchiveWriter::Add(uint64_t hash, std::span<const uint8_t> data, bool compress)
+	{
+		Blob blob{
+			.hash = hash,
+			.rawSize = (uint32_t)data.size(),
+			.compressed = false,
+			.data = {},
+		};
+
+		if (compress)
+		{
+			std::vector<uint8_t> packed = Compress(data);
+
+			if (packed.size() < data.size())
+			{
+				blob.compressed = true;
+				blob.data = std::move(packed);
+			}
+		}
+
+		if (!blob.compressed)
+			blob.data.assign(data.begin(), data.end());
+
+		blobs.push_back(std::move(blob));
+	}
+
+	bool ArchiveWriter::Write(const std::string& path)
+	{
+		std::sort(blobs.begin(), blobs.end(), [](const Blob& a, const Blob& b) { return a.hash < b.hash; });
+
+		for (size_t i = 1; i < blobs.size(); i++)
+		{
+			if (blobs[i - 1].hash == blobs[i].hash)
+			{
+				Console::Error("Archive Blobs Share A Hash: ", blobs[i].hash);
+				return false;
+			}
+		}
+
+		auto align = [&](uint64_t offset) { return (offset + alignment - 1) & ~(uint64_t)(alignment - 1); };
+
+		std::vector<ArchiveEntry> table;
+		table.reserve(blobs.size());
+
+		uint64_t offset = align(sizeof(ArchiveHeader) + blobs.size() * sizeof(ArchiveEntry));
+		for (const Blob& blob : blobs)
+		{
+			table.push_back({
+				.hash = blob.hash,
+				.offset = offset,
+				.size = (uint32_t)blob.data.size(),
+				.rawSize = blob.rawSize,
+				.flags = blob.compressed ? (uint32_t)ArchiveCompressed : 0u,
+				.reserved = 0,
+			});
+
+			offset = align(offset + blob.data.size());
+		}
+
+		// written next to the target and renamed over it, a reader never maps a half written archive.
+		std::string temporary = path + ".tmp";
+
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+			return false;
+
+		ArchiveHeader header{
+			.magic = ArchiveMagic,
+			.version = ArchiveVersion,
+			.count = (uint32_t)table.size(),
+			.alignment = alignment,
+		};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(ArchiveEntry));
+
+		std::vector<char> padding(alignment);
+		uint64_t written = sizeof(header) + table.size() * sizeof(ArchiveEntry);
+
+		for (size_t i = 0; i < blobs.size(); i++)
+		{
+			file.write(padding.data(), table[i].offset - written);
+			file.write(reinterpret_cast<const char*>(blobs[i].data.data()), blobs[i].data.size());
+
+			written = table[i].offset + blobs[i].data.size();
+		}
+
+		file.close();
+
+		std::error_code error;
+		if (file.fail())
+		{
+			std::filesystem::remove(temporary, error);
+			return false;
+		}
+
+		std::filesystem::rename(temporary, path, error);
+		if (error)
+		{
+			Console::Error("Could Not Replace Archive: ", path, ", ", error.message());
+			std::filesystem::remove(temporary, error);
+			return false;
+		}
+
+		return true;
+	}
+
+	uint32_t ArchiveWriter::GetEntryCount() const
+	{
+		return (uint32_t)blobs.size();
+	}
+}
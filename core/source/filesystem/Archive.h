@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace FileSystem {
+
+	// one blob in an archive, the table of contents is sorted by `hash`.
+	struct ArchiveEntry {
+		uint64_t hash;
+		// from the start of the file, a multiple of the archive's alignment.
+		uint64_t offset;
+		// bytes stored in the file.
+		uint32_t size;
+		// bytes once decompressed, equal to `size` for stored blobs.
+		uint32_t rawSize;
+		uint32_t flags;
+		uint32_t reserved;
+	};
+
+	enum ArchiveFlags : uint32_t {
+		ArchiveCompressed = 1 << 0,
+	};
+
+	// many assets packed into one file, opened once and memory mapped.
+	//
+	// blobs are found by the hash of their name with a binary search over the
+	// table of contents, nothing is read until a blob is touched. stored blobs
+	// are handed out as views straight into the mapping, compressed ones are
+	// decompressed by Read(). the mapping and every view live until Close().
+	// read only after Open(), any thread may look up blobs.
+	class Archive {
+	public:
+		Archive() = default;
+		~Archive();
+
+		Archive(const Archive&) = delete;
+		Archive& operator=(const Archive&) = delete;
+
+		// false when the file is missing or not a valid archive.
+		bool Open(const std::string& path);
+		void Close();
+		bool IsOpen() const;
+
+		// FNV-1a of the name, what entries are keyed by.
+		static uint64_t Hash(std::string_view name);
+
+		// nullptr when there is no such blob.
+		const ArchiveEntry* Find(uint64_t hash) const;
+		const ArchiveEntry* Find(std::string_view name) const;
+
+		// the blob in place, empty for compressed blobs.
+		std::span<const uint8_t> GetView(const ArchiveEntry& entry) const;
+		// a copy of the blob, decompressed. false when it is corrupt.
+		bool Read(const ArchiveEntry& entry, std::vector<uint8_t>& data) const;
+
+		uint32_t GetEntryCount() const;
+
+	private:
+		const uint8_t* base = nullptr;
+		size_t size = 0;
+
+		std::span<const ArchiveEntry> entries;
+
+#ifdef _WIN32
+		void* file = nullptr;
+		void* mapping = nullptr;
+#endif
+	};
+
+	// collects blobs and writes them as an archive.
+	class ArchiveWriter {
+	public:
+		// every blob starts at a multiple of `alignment`, a power of two.
+		explicit ArchiveWriter(uint32_t alignment = 16);
+
+		// compressed blobs can not be viewed in place, they are stored when compression does not pay off.
+		void Add(std::string_view name, std::span<const uint8_t> data, bool compress = false);
+		void Add(uint64_t hash, std::span<const uint8_t> data, bool compress = false);
+
+		// false when two blobs share a hash or the file can not be written.
+		bool Write(const std::string& path);
+
+		uint32_t GetEntryCount() const;
+
+	private:
+		struct Blob {
+			uint64_t hash;
+			uint32_t rawSize;
+			bool compressed;
+			std::vector<uint8_t> data;
+		};
+
+		uint32_t alignment;
+		std::vector<Blob> blobs;
+	};
+}
@@ -0,0 +1,520 @@
+#include "AsyncIO.h"
+
+#include <debug/Console.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define ASYNC_IO_URING 1
+#else
+#define ASYNC_IO_URING 0
+#endif
+
+#if ASYNC_IO_URING
+#include <linux/io_uring.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	using namespace AsyncIO;
+
+	struct Pending {
+		Request request;
+		Callback callback;
+
+		// bytes read so far, a short read is resubmitted for the rest.
+		uint64_t done = 0;
+#if ASYNC_IO_URING
+		int fd = -1;
+		iovec vector{};
+#endif
+	};
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable idle;
+
+	std::deque<std::unique_ptr<Pending>> queues[(size_t)Priority::Count];
+	std::atomic<uint32_t> pending{ 0 };
+
+	std::vector<std::thread> threads;
+	// read without the lock by Enqueue(), only changed under it.
+	std::atomic<bool> running{ false };
+	bool uring = false;
+
+	// highest priority first, under the lock.
+	std::unique_ptr<Pending> Pop()
+	{
+		for (auto& queue : queues)
+		{
+			if (queue.empty())
+				continue;
+
+			std::unique_ptr<Pending> next = std::move(queue.front());
+			queue.pop_front();
+			return next;
+		}
+
+		return nullptr;
+	}
+
+	bool HasQueued()
+	{
+		for (auto& queue : queues)
+			if (!queue.empty())
+				return true;
+
+		return false;
+	}
+
+	void Finish(std::unique_ptr<Pending> read, int64_t result)
+	{
+		read->callback(result);
+		read.reset();
+
+		// the lock orders the decrement against WaitIdle() checking it.
+		if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			idle.notify_all();
+		}
+	}
+
+	int64_t ReadBlocking(const Request& request)
+	{
+		std::ifstream file(request.path, std::ios::binary);
+		if (!file.is_open())
+			return -ENOENT;
+
+		file.seekg((std::streamoff)request.offset);
+		file.read(reinterpret_cast<char*>(request.buffer.data()), (std::streamsize)request.buffer.size());
+
+		return file.bad() ? -EIO : (int64_t)file.gcount();
+	}
+
+	// FALLBACK
+	void PoolWorker()
+	{
+		while (true)
+		{
+			std::unique_ptr<Pending> read;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [] { return !running || HasQueued(); });
+
+				read = Pop();
+				if (!read)
+					return;
+			}
+
+			int64_t result = ReadBlocking(read->request);
+			Finish(std::move(read), result);
+		}
+	}
+
+#if ASYNC_IO_URING
+	// the rings shared with the kernel, set up without liburing.
+	struct Ring {
+		int fd = -1;
+		uint32_t entries = 0;
+
+		void* sq = MAP_FAILED;
+		size_t sqSize = 0;
+		void* cq = MAP_FAILED;
+		size_t cqSize = 0;
+		io_uring_sqe* sqes = (io_uring_sqe*)MAP_FAILED;
+		size_t sqesSize = 0;
+
+		unsigned* sqTail = nullptr;
+		unsigned* sqMask = nullptr;
+		unsigned* sqArray = nullptr;
+
+		unsigned* cqHead = nullptr;
+		unsigned* cqTail = nullptr;
+		unsigned* cqMask = nullptr;
+		io_uring_cqe* cqes = nullptr;
+	};
+
+	Ring ring;
+
+	void DestroyRing()
+	{
+		if (ring.sqes != MAP_FAILED)
+			munmap(ring.sqes, ring.sqesSize);
+		if (ring.cq != MAP_FAILED && ring.cq != ring.sq)
+			munmap(ring.cq, ring.cqSize);
+		if (ring.sq != MAP_FAILED)
+			munmap(ring.sq, ring.sqSize);
+		if (ring.fd >= 0)
+			close(ring.fd);
+
+		ring = {};
+	}
+
+	bool CreateRing(uint32_t depth)
+	{
+		io_uring_params params{};
+
+		ring.fd = (int)syscall(__NR_io_uring_setup, depth, &params);
+		if (ring.fd < 0)
+			return false;
+
+		ring.entries = params.sq_entries;
+		ring.sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		ring.cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+		bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+		if (single)
+			ring.sqSize = ring.cqSize = std::max(ring.sqSize, ring.cqSize);
+
+		ring.sq = mmap(nullptr, ring.sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQ_RING);
+		ring.cq = single ? ring.sq : mmap(nullptr, ring.cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_CQ_RING);
+
+		ring.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		ring.sqes = (io_uring_sqe*)mmap(nullptr, ring.sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+
+		if (ring.sq == MAP_FAILED || ring.cq == MAP_FAILED || ring.sqes == MAP_FAILED)
+		{
+			DestroyRing();
+			return false;
+		}
+
+		auto sq = (uint8_t*)ring.sq;
+		ring.sqTail = (unsigned*)(sq + params.sq_off.tail);
+		ring.sqMask = (unsigned*)(sq + params.sq_off.ring_mask);
+		ring.sqArray = (unsigned*)(sq + params.sq_off.array);
+
+		auto cq = (uint8_t*)ring.cq;
+		ring.cqHead = (unsigned*)(cq + params.cq_off.head);
+		ring.cqTail = (unsigned*)(cq + params.cq_off.tail);
+		ring.cqMask = (unsigned*)(cq + params.cq_off.ring_mask);
+		ring.cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+
+		return true;
+	}
+
+	// queues the rest of `read`, only the io thread touches the submission ring.
+	void PrepareRead(Pending* read)
+	{
+		read->vector = {
+			.iov_base = read->request.buffer.data() + read->done,
+			.iov_len = read->request.buffer.size() - read->done,
+		};
+
+		unsigned tail = *ring.sqTail;
+		unsigned index = tail & *ring.sqMask;
+
+		io_uring_sqe& sqe = ring.sqes[index];
+		sqe = {};
+		sqe.opcode = IORING_OP_READV;
+		sqe.fd = read->fd;
+		sqe.off = read->request.offset + read->done;
+		sqe.addr = (uint64_t)(uintptr_t)&read->vector;
+		sqe.len = 1;
+		sqe.user_data = (uint64_t)(uintptr_t)read;
+
+		ring.sqArray[index] = index;
+		std::atomic_ref<unsigned>(*ring.sqTail).store(tail + 1, std::memory_order_release);
+	}
+
+	void Complete(Pending* raw, int64_t result)
+	{
+		std::unique_ptr<Pending> read(raw);
+
+		if (read->fd >= 0)
+			close(read->fd);
+
+		Finish(std::move(read), result);
+	}
+
+	void RingWorker()
+	{
+		uint32_t inFlight = 0;
+		uint32_t unsubmitted = 0;
+
+		while (true)
+		{
+			std::vector<std::unique_ptr<Pending>> started;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+
+				// with reads in flight the kernel wakes this thread, new requests are picked up after the next completion.
+				if (inFlight == 0)
+				{
+					wake.wait(lock, [] { return !running || HasQueued(); });
+
+					if (!running && !HasQueued())
+						return;
+				}
+
+				while (inFlight + started.size() < ring.entries)
+				{
+					std::unique_ptr<Pending> read = Pop();
+					if (!read)
+						break;
+
+					started.push_back(std::move(read));
+				}
+			}
+
+			for (std::unique_ptr<Pending>& read : started)
+			{
+				read->fd = open(read->request.path.c_str(), O_RDONLY | O_CLOEXEC);
+
+				if (read->fd < 0 || read->request.buffer.empty())
+				{
+					int64_t result = read->fd < 0 ? -(int64_t)errno : 0;
+					Complete(read.release(), result);
+					continue;
+				}
+
+				PrepareRead(read.release());
+				inFlight++;
+				unsubmitted++;
+			}
+
+			if (inFlight == 0)
+				continue;
+
+			int entered = (int)syscall(__NR_io_uring_enter, ring.fd, unsubmitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+			if (entered < 0)
+			{
+				if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+					Console::Error("io_uring_enter Failed: ", errno);
+				continue;
+			}
+
+			unsubmitted -= std::min((uint32_t)entered, unsubmitted);
+
+			unsigned head = *ring.cqHead;
+			while (head != std::atomic_ref<unsigned>(*ring.cqTail).load(std::memory_order_acquire))
+			{
+				const io_uring_cqe& cqe = ring.cqes[head & *ring.cqMask];
+				Pending* read = (Pending*)(uintptr_t)cqe.user_data;
+				int result = cqe.res;
+
+				head++;
+				std::atomic_ref<unsigned>(*ring.cqHead).store(head, std::memory_order_release);
+
+				if (result == -EINTR || result == -EAGAIN)
+				{
+					PrepareRead(read);
+					unsubmitted++;
+					continue;
+				}
+
+				if (result > 0)
+				{
+					read->done += (uint64_t)result;
+
+					if (read->done < read->request.buffer.size())
+					{
+						PrepareRead(read);
+						unsubmitted++;
+						continue;
+					}
+				}
+
+				inFlight--;
+				Complete(read, result < 0 ? (int64_t)result : (int64_t)read->done);
+			}
+		}
+	}
+#endif
+
+	void Enqueue(std::unique_ptr<Pending> read, Priority priority)
+	{
+		pending.fetch_add(1, std::memory_order_acq_rel);
+
+		if (!running)
+		{
+			int64_t result = ReadBlocking(read->request);
+			Finish(std::move(read), result);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			queues[(size_t)priority].push_back(std::move(read));
+		}
+
+		wake.notify_one();
+	}
+}
+
+namespace AsyncIO {
+
+	void Initialize(uint32_t queueDepth, uint32_t fallbackThreads)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (running)
+				return;
+
+			running = true;
+		}
+
+#if ASYNC_IO_URING
+		uring = CreateRing(std::max(queueDepth, 1u));
+		if (uring)
+		{
+			threads.emplace_back(RingWorker);
+			Console::Log("Async IO Started: io_uring, Depth ", ring.entries);
+			return;
+		}
+#endif
+
+		for (uint32_t i = 0; i < std::max(fallbackThreads, 1u); i++)
+			threads.emplace_back(PoolWorker);
+
+		Console::Log("Async IO Started: Thread Pool, Threads ", (uint32_t)threads.size());
+	}
+
+	void Shutdown()
+	{
+		if (!running)
+			return;
+
+		WaitIdle();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			running = false;
+		}
+
+		wake.notify_all();
+
+		for (std::thread& thread : threads)
+			thread.join();
+		threads.clear();
+
+#if ASYNC_IO_URING
+		if (uring)
+			DestroyRing();
+#endif
+
+		uring = false;
+	}
+
+	bool UsesIoUring()
+	{
+		return uring;
+	}
+
+	void Read(const Request& request, Callback callback, Priority priority)
+	{
+		auto read = std::make_unique<Pending>();
+		read->request = request;
+		read->callback = std::move(callback);
+
+		Enqueue(std::move(read), priority);
+	}
+
+	std::future<int64_t> Read(const Request& request, Priority priority)
+	{
+		auto promise = std::make_shared<std::promise<int64_t>>();
+		std::future<int64_t> result = promise->get_future();
+
+		Read(request, [promise](int64_t bytes) { promise->set_value(bytes); }, priority);
+
+		return result;
+	}
+
+	void ReadBatch(std::span<const Request> requests, BatchCallback callback, Priority priority)
+	{
+		auto shared = std::make_shared<BatchCallback>(std::move(callback));
+
+		std::vector<std::unique_ptr<Pending>> reads;
+		reads.reserve(requests.size());
+
+		for (uint32_t i = 0; i < (uint32_t)requests.size(); i++)
+		{
+			auto read = std::make_unique<Pending>();
+			read->request = requests[i];
+			read->callback = [shared, i](int64_t result) { (*shared)(i, result); };
+
+			reads.push_back(std::move(read));
+		}
+
+		pending.fetch_add((uint32_t)reads.size(), std::memory_order_acq_rel);
+
+		if (!running)
+		{
+			for (std::unique_ptr<Pending>& read : reads)
+			{
+				int64_t result = ReadBlocking(read->request);
+				Finish(std::move(read), result);
+			}
+
+			return;
+		}
+
+		// one lock, the io thread sees the whole batch and submits it together.
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (std::unique_ptr<Pending>& read : reads)
+				queues[(size_t)priority].push_back(std::move(read));
+		}
+
+		wake.notify_all();
+	}
+
+	std::future<std::vector<uint8_t>> ReadFile(const std::string& path, Priority priority)
+	{
+		auto promise = std::make_shared<std::promise<std::vector<uint8_t>>>();
+		std::future<std::vector<uint8_t>> result = promise->get_future();
+
+		std::error_code error;
+		uintmax_t size = std::filesystem::file_size(path, error);
+
+		if (error)
+		{
+			promise->set_value({});
+			return result;
+		}
+
+		auto data = std::make_shared<std::vector<uint8_t>>((size_t)size);
+
+		Request request{
+			.path = path,
+			.offset = 0,
+			.buffer = *data,
+		};
+
+		Read(request, [promise, data](int64_t bytes) {
+			if (bytes < 0)
+				data->clear();
+			else
+				data->resize((size_t)bytes);
+
+			promise->set_value(std::move(*data));
+		}, priority);
+
+		return result;
+	}
+
+	void WaitIdle()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		idle.wait(lock, [] { return pending.load(std::memory_order_acquire) == 0; });
+	}
+
+	uint32_t GetPendingCount()
+	{
+		return pending.load(std::memory_order_acquire);
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <span>
+#include <string>
+#include <vector>
+
+// Asynchronous file reads.
+//
+// on linux reads go through io_uring: one thread keeps up to `queueDepth`
+// reads in flight, so many files load side by side and the device stays busy.
+// where io_uring is missing or blocked a few threads read with blocking calls.
+// queued reads start highest priority first.
+//
+// callbacks run on the io thread, keep them short and hand heavy work to the
+// job system. without Initialize() every read runs inline on the caller.
+namespace AsyncIO {
+
+	enum class Priority : uint8_t {
+		High,
+		Normal,
+		Low,
+		Count,
+	};
+
+	struct Request {
+		std::string path;
+		uint64_t offset = 0;
+		// read into, its size is how many bytes are read. must stay alive until the read completed.
+		std::span<uint8_t> buffer;
+	};
+
+	// bytes read, fewer than asked only at the end of the file, or a negative errno.
+	using Callback = std::function<void(int64_t result)>;
+	using BatchCallback = std::function<void(uint32_t index, int64_t result)>;
+
+	// queueDepth bounds the io_uring reads in flight, fallbackThreads is used without it.
+	void Initialize(uint32_t queueDepth = 64, uint32_t fallbackThreads = 4);
+	// finishes every queued read first.
+	void Shutdown();
+
+	bool UsesIoUring();
+
+	void Read(const Request& request, Callback callback, Priority priority = Priority::Normal);
+	std::future<int64_t> Read(const Request& request, Priority priority = Priority::Normal);
+	// queued together, `callback` gets the index of each request as it completes.
+	void ReadBatch(std::span<const Request> requests, BatchCallback callback, Priority priority = Priority::Normal);
+
+	// the whole file, empty when it can not be read.
+	std::future<std::vector<uint8_t>> ReadFile(const std::string& path, Priority priority = Priority::Normal);
+
+	// blocks until every read finished and its callback returned.
+	void WaitIdle();
+	uint32_t GetPendingCount();
+}
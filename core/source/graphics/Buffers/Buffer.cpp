@@ -0,0 +1,86 @@
+#include "Buffer.h"
+
+#include "graphics/UploadEngine.h"
+
+#include <debug/Console.h>
+
+#include <cstring>
+
+Buffer::Buffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, BufferMemory memory, uint32_t frames)
+	: device{ device }, type{ memory }, size{ size }, stride{ size }, frames{ memory == BufferMemory::Dynamic ? std::max(1u, frames) : 1u }
+{
+	if (type == BufferMemory::Static)
+	{
+		buffer = VulkanAPI::CreateBuffer(device, size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+		this->memory = VulkanAPI::AllocateBufferMemory(device, physicalDevice, buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		return;
+	}
+
+	// every region has to be a valid dynamic offset for whatever the buffer gets bound as.
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+	VkDeviceSize alignment = std::max({
+		properties.limits.minUniformBufferOffsetAlignment,
+		properties.limits.minStorageBufferOffsetAlignment,
+		properties.limits.nonCoherentAtomSize,
+		(VkDeviceSize)16
+	});
+
+	stride = (size + alignment - 1) & ~(alignment - 1);
+
+	buffer = VulkanAPI::CreateBuffer(device, stride * this->frames, usage);
+	this->memory = VulkanAPI::AllocateBufferMemory(device, physicalDevice, buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	// mapped for the lifetime of the buffer.
+	VK_CHECK(vkMapMemory(device, this->memory, 0, VK_WHOLE_SIZE, 0, reinterpret_cast<void**>(&mapped)));
+}
+
+Buffer::~Buffer()
+{
+	if (mapped)
+		vkUnmapMemory(device, memory);
+
+	vkDestroyBuffer(device, buffer, nullptr);
+	vkFreeMemory(device, memory, nullptr);
+}
+
+uint64_t Buffer::Upload(UploadEngine* uploadEngine, const void* data, VkDeviceSize size, VkDeviceSize offset, VulkanAPI::CommandType consumer)
+{
+	assert(type == BufferMemory::Static && "Dynamic Buffers Are Written Through Map/Write.");
+	assert(offset + size <= this->size && "Upload Out Of Range.");
+
+	return uploadEngine->UploadBuffer(buffer, offset, data, size, consumer);
+}
+
+void* Buffer::Map(uint32_t frame)
+{
+	assert(type == BufferMemory::Dynamic && "Static Buffers Are Written Through Upload.");
+	return mapped + GetOffset(frame);
+}
+
+void Buffer::Write(uint32_t frame, const void* data, VkDeviceSize size, VkDeviceSize offset)
+{
+	assert(offset + size <= this->size && "Write Out Of Range.");
+	memcpy(static_cast<uint8_t*>(Map(frame)) + offset, data, size);
+}
+
+VkDeviceSize Buffer::GetOffset(uint32_t frame)
+{
+	return stride * (frame % frames);
+}
+
+VkBuffer Buffer::Get()
+{
+	return buffer;
+}
+
+VkDeviceSize Buffer::GetSize()
+{
+	return size;
+}
+
+BufferMemory Buffer::GetMemory()
+{
+	return type;
+}
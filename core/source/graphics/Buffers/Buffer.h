@@ -0,0 +1,59 @@
+#pragma once
+
+#include <graphics/gfx_pch.h>
+#include <graphics/CommandManager.h>
+#include <datastructures/SlotMap.h>
+
+class UploadEngine;
+class Buffer;
+
+using BufferHandle = Handle32<Buffer>;
+
+enum class BufferMemory {
+	// device local, filled through the UploadEngine's staging ring.
+	Static,
+	// host visible and persistently mapped, one region per frame in flight.
+	Dynamic,
+};
+
+// GPU buffer (vertex, index, uniform, storage, indirect...).
+//
+// dynamic buffers hold `frames` copies of `size` bytes, the cpu writes the
+// region of the frame it is recording while the gpu still reads the older ones.
+class Buffer {
+public:
+	Buffer(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize size, VkBufferUsageFlags usage, BufferMemory memory, uint32_t frames = CommandManager::FramesInFlight);
+	~Buffer();
+
+	Buffer(const Buffer&) = delete;
+	Buffer& operator=(const Buffer&) = delete;
+
+	// static buffers only. returns the upload engine timeline value the data lands at.
+	uint64_t Upload(UploadEngine* uploadEngine, const void* data, VkDeviceSize size, VkDeviceSize offset = 0, VulkanAPI::CommandType consumer = VulkanAPI::CommandType::Graphics);
+
+	// dynamic buffers only. pointer to the region `frame` writes into.
+	void* Map(uint32_t frame);
+	void Write(uint32_t frame, const void* data, VkDeviceSize size, VkDeviceSize offset = 0);
+
+	// byte offset of `frame`'s region, what gets bound for that frame. always 0 for static buffers.
+	VkDeviceSize GetOffset(uint32_t frame);
+
+	VkBuffer Get();
+	VkDeviceSize GetSize();
+	BufferMemory GetMemory();
+
+private:
+	VkDevice device;
+
+	VkBuffer buffer = VK_NULL_HANDLE;
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+
+	BufferMemory type;
+	VkDeviceSize size;
+
+	// distance between two frame regions, `size` rounded up to the device's offset alignment.
+	VkDeviceSize stride;
+	uint32_t frames;
+
+	uint8_t* mapped = nullptr;
+};
@@ -0,0 +1,103 @@
+#include "IndirectDrawBuffer.h"
+
+#include <algorithm>
+#include <cassert>
+
+IndirectDrawBuffer::IndirectDrawBuffer(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t maxDraws, BufferMemory memory, const VulkanAPI::DeviceFeatures& features)
+	: features{ features }, memory{ memory }, maxDraws{ maxDraws }
+{
+	// storage so a compute pass can write both.
+	VkBufferUsageFlags usage = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+	commands = std::make_unique<Buffer>(device, physicalDevice, (VkDeviceSize)maxDraws * sizeof(VkDrawIndexedIndirectCommand), usage, memory);
+	count = std::make_unique<Buffer>(device, physicalDevice, sizeof(uint32_t), usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, memory);
+}
+
+void IndirectDrawBuffer::Write(uint32_t frame, const VkDrawIndexedIndirectCommand* data, uint32_t drawCount)
+{
+	assert(memory == BufferMemory::Dynamic && "Static Indirect Buffers Are Written By The GPU.");
+
+	drawCount = std::min(drawCount, maxDraws);
+
+	if (drawCount > 0)
+		commands->Write(frame, data, drawCount * sizeof(VkDrawIndexedIndirectCommand));
+	count->Write(frame, &drawCount, sizeof(uint32_t));
+
+	written[frame % written.size()] = drawCount;
+
+	if (!features.drawIndirectFirstInstance)
+		host[frame % host.size()].assign(data, data + drawCount);
+}
+
+void IndirectDrawBuffer::Reset(VkCommandBuffer cmd)
+{
+	vkCmdFillBuffer(cmd, count->Get(), 0, sizeof(uint32_t), 0);
+}
+
+void IndirectDrawBuffer::Record(VkCommandBuffer cmd, uint32_t frame)
+{
+	if (UsesCountBuffer())
+	{
+		vkCmdDrawIndexedIndirectCount(cmd, commands->Get(), commands->GetOffset(frame), count->Get(), count->GetOffset(frame), maxDraws, sizeof(VkDrawIndexedIndirectCommand));
+		return;
+	}
+
+	Record(cmd, frame, 0, maxDraws);
+}
+
+void IndirectDrawBuffer::Record(VkCommandBuffer cmd, uint32_t frame, uint32_t first, uint32_t drawCount)
+{
+	constexpr uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+
+	// the cpu knows how many it wrote, gpu written buffers are drawn in full.
+	uint32_t draws = memory == BufferMemory::Dynamic ? written[frame % written.size()] : maxDraws;
+
+	first = std::min(first, draws);
+	drawCount = std::min(drawCount, draws - first);
+
+	if (drawCount == 0)
+		return;
+
+	if (memory == BufferMemory::Dynamic && !features.drawIndirectFirstInstance)
+	{
+		// firstInstance must be 0 in indirect commands here, draw the range directly.
+		for (uint32_t i = first; i < first + drawCount; i++)
+		{
+			const VkDrawIndexedIndirectCommand& draw = host[frame % host.size()][i];
+			vkCmdDrawIndexed(cmd, draw.indexCount, draw.instanceCount, draw.firstIndex, draw.vertexOffset, draw.firstInstance);
+		}
+		return;
+	}
+
+	VkBuffer commandBuffer = commands->Get();
+	VkDeviceSize offset = commands->GetOffset(frame) + (VkDeviceSize)first * stride;
+
+	if (features.multiDrawIndirect)
+	{
+		vkCmdDrawIndexedIndirect(cmd, commandBuffer, offset, drawCount, stride);
+		return;
+	}
+
+	for (uint32_t i = 0; i < drawCount; i++)
+		vkCmdDrawIndexedIndirect(cmd, commandBuffer, offset + (VkDeviceSize)i * stride, 1, stride);
+}
+
+bool IndirectDrawBuffer::UsesCountBuffer()
+{
+	return memory == BufferMemory::Static && features.drawIndirectCount;
+}
+
+Buffer* IndirectDrawBuffer::GetCommands()
+{
+	return commands.get();
+}
+
+Buffer* IndirectDrawBuffer::GetCount()
+{
+	return count.get();
+}
+
+uint32_t IndirectDrawBuffer::GetMaxDraws()
+{
+	return maxDraws;
+}
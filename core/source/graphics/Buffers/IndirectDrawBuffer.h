@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Buffer.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+// indexed draw commands the gpu reads itself.
+//
+// Dynamic: the cpu writes the commands of a frame with Write().
+// Static: a compute pass fills `commands` and bumps `count` on the gpu,
+// Reset() zeroes the count before that pass runs.
+//
+// Record() issues everything in one vkCmdDrawIndexedIndirectCount when the
+// device has it, one multi draw vkCmdDrawIndexedIndirect otherwise, and a
+// draw per command on devices without multiDrawIndirect. without
+// drawIndirectFirstInstance cpu written commands are drawn directly from a
+// host copy, indirect commands could not start past instance 0.
+class IndirectDrawBuffer {
+public:
+	IndirectDrawBuffer(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t maxDraws, BufferMemory memory, const VulkanAPI::DeviceFeatures& features);
+
+	void Write(uint32_t frame, const VkDrawIndexedIndirectCommand* commands, uint32_t count);
+
+	// transfer stage, must be recorded outside a render pass.
+	void Reset(VkCommandBuffer cmd);
+
+	// the index and vertex buffers have to be bound already.
+	void Record(VkCommandBuffer cmd, uint32_t frame);
+	// commands [first, first + count) only, clamped to the commands there are. never reads the count buffer.
+	void Record(VkCommandBuffer cmd, uint32_t frame, uint32_t first, uint32_t count);
+
+	// gpu written buffers without a count buffer are drawn in full, unused
+	// commands must carry an instanceCount of 0.
+	bool UsesCountBuffer();
+
+	Buffer* GetCommands();
+	Buffer* GetCount();
+	uint32_t GetMaxDraws();
+
+private:
+	VulkanAPI::DeviceFeatures features;
+	BufferMemory memory;
+	uint32_t maxDraws;
+
+	std::unique_ptr<Buffer> commands;
+	std::unique_ptr<Buffer> count;
+
+	// draws written by the cpu per frame slot.
+	std::array<uint32_t, CommandManager::FramesInFlight> written{};
+	// only kept without drawIndirectFirstInstance.
+	std::array<std::vector<VkDrawIndexedIndirectCommand>, CommandManager::FramesInFlight> host;
+};
@@ -0,0 +1,51 @@
+#include "UniformRing.h"
+
+#include <algorithm>
+
+UniformRing::UniformRing(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize capacity)
+	: capacity{ capacity }
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+	// every allocation starts on a valid dynamic offset, the regions already do.
+	alignment = std::max(properties.limits.minUniformBufferOffsetAlignment, (VkDeviceSize)16);
+
+	buffer = std::make_unique<Buffer>(device, physicalDevice, capacity, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, BufferMemory::Dynamic);
+
+	BeginFrame(0);
+}
+
+void UniformRing::BeginFrame(uint32_t frame)
+{
+	mapped = static_cast<uint8_t*>(buffer->Map(frame));
+	base = buffer->GetOffset(frame);
+
+	head.store(0, std::memory_order_relaxed);
+}
+
+UniformRing::Allocation UniformRing::Allocate(VkDeviceSize size)
+{
+	VkDeviceSize aligned = (size + alignment - 1) & ~(alignment - 1);
+
+	VkDeviceSize offset = head.fetch_add(aligned, std::memory_order_relaxed);
+	if (offset + size > capacity)
+		return {};
+
+	return { mapped + offset, (uint32_t)(base + offset) };
+}
+
+VkBuffer UniformRing::Get()
+{
+	return buffer->Get();
+}
+
+VkDeviceSize UniformRing::GetCapacity()
+{
+	return capacity;
+}
+
+VkDeviceSize UniformRing::GetUsed()
+{
+	return std::min(head.load(std::memory_order_relaxed), capacity);
+}
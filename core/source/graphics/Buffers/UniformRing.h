@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Buffer.h"
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+// linear allocator for per frame uniform data.
+//
+// every frame slot owns `capacity` bytes of one persistently mapped buffer,
+// Allocate() bumps the slot's head and returns a pointer to write through and
+// the dynamic offset to bind it at. BeginFrame() rewinds the head, nothing is
+// freed one by one.
+//
+// offsets are from the start of the whole buffer, so a set written once with
+// UNIFORM_BUFFER_DYNAMIC at offset 0 and the block's size as range stays valid
+// for every frame, only the dynamic offset changes between draws.
+class UniformRing {
+public:
+	static constexpr uint32_t InvalidOffset = 0xFFFFFFFF;
+
+	struct Allocation {
+		void* data = nullptr;
+		uint32_t offset = InvalidOffset;
+	};
+
+	UniformRing(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize capacity = 1 << 20);
+
+	// the slot's previous frame must have completed on the gpu.
+	void BeginFrame(uint32_t frame);
+
+	// thread safe. `data` is null once the frame's region is full.
+	Allocation Allocate(VkDeviceSize size);
+
+	// copies `value` in and returns its dynamic offset, InvalidOffset when full.
+	template<typename T>
+	uint32_t Push(const T& value) {
+		Allocation allocation = Allocate(sizeof(T));
+		if (allocation.data)
+			memcpy(allocation.data, &value, sizeof(T));
+		return allocation.offset;
+	}
+
+	VkBuffer Get();
+	VkDeviceSize GetCapacity();
+	// bytes handed out this frame, alignment padding included.
+	VkDeviceSize GetUsed();
+
+private:
+	std::unique_ptr<Buffer> buffer;
+
+	VkDeviceSize capacity;
+	VkDeviceSize alignment;
+
+	uint8_t* mapped = nullptr;
+	VkDeviceSize base = 0;
+
+	std::atomic<VkDeviceSize> head{ 0 };
+};
@@ -1,19 +1,400 @@
 #include "CommandManager.h"
 
+#include <jobs/JobSystem.h>
+
+#include <algorithm>
+#include <cassert>
+
 
 
 CommandManager::CommandManager(VkDevice device, VulkanAPI::QueueFamily queueFamily)
-	: device{device}
+	: device{device}, queueFamily{queueFamily}
 {
 	CommandPools = VulkanAPI::CreateCommandPools(device, queueFamily);
 	CommandQueues = VulkanAPI::AquireQueueHandles(device, queueFamily);
 
+	// one pool per job worker, plus one for whichever non worker thread records.
+	threadCount = Jobs::GetWorkerCount() + 1;
+	CreateThreadPools();
+	CreateFramePools();
+
+	for (auto& timeline : timelines)
+		timeline.semaphore = VulkanAPI::CreateTimelineSemaphore(device);
 }
 
 CommandManager::~CommandManager()
 {
-	VulkanAPI::FreeCommandPoolBlock(device, CommandPools);
+	for (auto& timeline : timelines)
+		vkDestroySemaphore(device, timeline.semaphore, nullptr);
+
 	VulkanAPI::FreeQueueHandles(device, CommandQueues);
+	FreeThreadPools();
+	FreeFramePools();
+	VulkanAPI::FreeCommandPoolBlock(device, CommandPools);
+}
+
+uint32_t CommandManager::GetFrameQueueIndex(VulkanAPI::CommandType type)
+{
+	assert((type == VulkanAPI::CommandType::Graphics || type == VulkanAPI::CommandType::Compute) && "Frames Only Submit To The Graphics And Compute Queues.");
+
+	return type == VulkanAPI::CommandType::Compute ? 1 : 0;
+}
+
+void CommandManager::CreateThreadPools()
+{
+	VkCommandPoolCreateInfo info{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		.queueFamilyIndex = GetQueueFamilyIndex(VulkanAPI::CommandType::Graphics)
+	};
+
+	for (auto& frame : threadPools)
+	{
+		frame.resize(threadCount);
+
+		for (auto& thread : frame)
+			VK_CHECK(vkCreateCommandPool(device, &info, nullptr, &thread.pool));
+	}
+}
+
+void CommandManager::FreeThreadPools()
+{
+	for (auto& frame : threadPools)
+	{
+		// destroying the pool frees its buffers.
+		for (auto& thread : frame)
+			vkDestroyCommandPool(device, thread.pool, nullptr);
+
+		frame.clear();
+	}
+}
+
+void CommandManager::CreateFramePools()
+{
+	const VulkanAPI::CommandType types[FrameQueueCount] = { VulkanAPI::CommandType::Graphics, VulkanAPI::CommandType::Compute };
+
+	for (auto& frame : framePools)
+	{
+		for (uint32_t i = 0; i < FrameQueueCount; i++)
+		{
+			VkCommandPoolCreateInfo info{
+				.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+				.pNext = nullptr,
+				.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+				.queueFamilyIndex = GetQueueFamilyIndex(types[i])
+			};
+
+			VK_CHECK(vkCreateCommandPool(device, &info, nullptr, &frame[i].pool));
+		}
+	}
+}
+
+void CommandManager::FreeFramePools()
+{
+	for (auto& frame : framePools)
+	{
+		for (auto& queue : frame)
+		{
+			vkDestroyCommandPool(device, queue.pool, nullptr);
+			queue = {};
+		}
+	}
+}
+
+void CommandManager::BeginFrame(uint32_t frame)
+{
+	currentFrame = frame % FramesInFlight;
+
+	// the slot's buffers, descriptor sets and dynamic buffer regions are free once its submissions completed.
+	for (uint32_t i = 0; i < FrameQueueCount; i++)
+	{
+		if (frameValues[currentFrame][i] > 0)
+			VulkanAPI::WaitTimeline(device, timelines[i].semaphore, frameValues[currentFrame][i]);
+	}
+
+	// pools are reset wholesale, the buffers they handed out last time are reused as is.
+	for (auto& thread : threadPools[currentFrame])
+	{
+		VK_CHECK(vkResetCommandPool(device, thread.pool, 0));
+		thread.used = 0;
+	}
+
+	for (auto& queue : framePools[currentFrame])
+	{
+		VK_CHECK(vkResetCommandPool(device, queue.pool, 0));
+		queue.used = 0;
+	}
+}
+
+VkCommandBuffer CommandManager::BeginFrameCommand(VulkanAPI::CommandType type)
+{
+	ThreadPool& pool = framePools[currentFrame][GetFrameQueueIndex(type)];
+
+	if (pool.used == pool.buffers.size())
+	{
+		VkCommandBufferAllocateInfo info
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.pNext = nullptr,
+			.commandPool = pool.pool,
+			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount = 1,
+		};
+
+		VkCommandBuffer cmd = VK_NULL_HANDLE;
+		VK_CHECK(vkAllocateCommandBuffers(device, &info, &cmd));
+		pool.buffers.push_back(cmd);
+	}
+
+	VkCommandBuffer cmd = pool.buffers[pool.used++];
+
+	VkCommandBufferBeginInfo begin{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.pNext = nullptr,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+	};
+
+	VK_CHECK(vkBeginCommandBuffer(cmd, &begin));
+
+	return cmd;
+}
+
+uint64_t CommandManager::Submit(VkCommandBuffer cmd, VulkanAPI::CommandType type, const VulkanAPI::TimelineWaitList& waits, VkSemaphore signal)
+{
+	VK_CHECK(vkEndCommandBuffer(cmd));
+
+	uint32_t queue = GetFrameQueueIndex(type);
+	Timeline& timeline = timelines[queue];
+	uint64_t value = timeline.next++;
+
+	SmallVector<VkSemaphore, 4> waitSemaphores;
+	SmallVector<uint64_t, 4> waitValues;
+	SmallVector<VkPipelineStageFlags, 4> waitStages;
+
+	for (const auto& wait : waits)
+	{
+		waitSemaphores.push_back(wait.semaphore);
+		waitValues.push_back(wait.value);
+		waitStages.push_back(wait.stage);
+	}
+
+	// the timeline is always signaled, the binary semaphore only when asked for. binary values are ignored.
+	VkSemaphore signalSemaphores[2] = { timeline.semaphore, signal };
+	uint64_t signalValues[2] = { value, 0 };
+	uint32_t signalCount = signal != VK_NULL_HANDLE ? 2u : 1u;
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo
+	{
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+		.pNext = nullptr,
+		.waitSemaphoreValueCount = (uint32_t)waitValues.size(),
+		.pWaitSemaphoreValues = waitValues.data(),
+		.signalSemaphoreValueCount = signalCount,
+		.pSignalSemaphoreValues = signalValues,
+	};
+
+	VkSubmitInfo info
+	{
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.pNext = &timelineInfo,
+		.waitSemaphoreCount = (uint32_t)waitSemaphores.size(),
+		.pWaitSemaphores = waitSemaphores.data(),
+		.pWaitDstStageMask = waitStages.data(),
+		.commandBufferCount = 1,
+		.pCommandBuffers = &cmd,
+		.signalSemaphoreCount = signalCount,
+		.pSignalSemaphores = signalSemaphores,
+	};
+
+	VK_CHECK(vkQueueSubmit(GetQueue(type), 1, &info, VK_NULL_HANDLE));
+
+	frameValues[currentFrame][queue] = value;
+
+	// releases recorded in `cmd` can be acquired from now on.
+	for (auto it = releases.begin(); it != releases.end();)
+	{
+		if (it->cmd != cmd)
+		{
+			it++;
+			continue;
+		}
+
+		Handoff handoff{ .src = type, .value = value };
+		if (it->barrier.srcQueueFamilyIndex != it->barrier.dstQueueFamilyIndex)
+			handoff.barrier = it->barrier;
+
+		handoffs[GetFrameQueueIndex(it->dst)].push_back(handoff);
+		it = releases.erase(it);
+	}
+
+	return value;
+}
+
+VulkanAPI::TimelineWait CommandManager::GetWait(VulkanAPI::CommandType type, uint64_t value, VkPipelineStageFlags stage)
+{
+	return { timelines[GetFrameQueueIndex(type)].semaphore, value, stage };
+}
+
+bool CommandManager::IsComplete(VulkanAPI::CommandType type, uint64_t value)
+{
+	return VulkanAPI::GetTimelineValue(device, timelines[GetFrameQueueIndex(type)].semaphore) >= value;
+}
+
+void CommandManager::Wait(VulkanAPI::CommandType type, uint64_t value)
+{
+	if (value == 0)
+		return;
+
+	VulkanAPI::WaitTimeline(device, timelines[GetFrameQueueIndex(type)].semaphore, value);
+}
+
+void CommandManager::ReleaseBuffer(VkCommandBuffer cmd, VulkanAPI::CommandType src, VulkanAPI::CommandType dst, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size,
+	VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkAccessFlags dstAccess)
+{
+	uint32_t srcFamily = GetQueueFamilyIndex(src);
+	uint32_t dstFamily = GetQueueFamilyIndex(dst);
+
+	VkBufferMemoryBarrier barrier
+	{
+		.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+		.pNext = nullptr,
+		.srcAccessMask = srcAccess,
+		.dstAccessMask = dstAccess,
+		.srcQueueFamilyIndex = srcFamily,
+		.dstQueueFamilyIndex = dstFamily,
+		.buffer = buffer,
+		.offset = offset,
+		.size = size,
+	};
+
+	// within one family the semaphore wait alone makes the writes visible.
+	if (srcFamily != dstFamily)
+	{
+		VkBufferMemoryBarrier release = barrier;
+		release.dstAccessMask = 0;
+
+		vkCmdPipelineBarrier(cmd,
+			srcStage,
+			VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			0,
+			0, nullptr,
+			1, &release,
+			0, nullptr
+		);
+	}
+
+	releases.push_back({ cmd, src, dst, barrier });
+}
+
+void CommandManager::AcquireOwnership(VkCommandBuffer cmd, VulkanAPI::CommandType dst, VkPipelineStageFlags dstStage, VulkanAPI::TimelineWaitList& waits)
+{
+	auto& pending = handoffs[GetFrameQueueIndex(dst)];
+	if (pending.empty())
+		return;
+
+	SmallVector<VkBufferMemoryBarrier, 8> acquires;
+	std::array<uint64_t, FrameQueueCount> values{};
+
+	for (const Handoff& handoff : pending)
+	{
+		uint32_t src = GetFrameQueueIndex(handoff.src);
+		values[src] = std::max(values[src], handoff.value);
+
+		if (handoff.barrier.has_value())
+		{
+			VkBufferMemoryBarrier acquire = handoff.barrier.value();
+			acquire.srcAccessMask = 0;
+			acquires.push_back(acquire);
+		}
+	}
+
+	if (!acquires.empty())
+	{
+		vkCmdPipelineBarrier(cmd,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			dstStage,
+			0,
+			0, nullptr,
+			(uint32_t)acquires.size(), acquires.data(),
+			0, nullptr
+		);
+	}
+
+	for (uint32_t i = 0; i < FrameQueueCount; i++)
+	{
+		if (values[i] > 0)
+			waits.push_back({ timelines[i].semaphore, values[i], dstStage });
+	}
+
+	pending.clear();
+}
+
+uint32_t CommandManager::GetCurrentFrame()
+{
+	return currentFrame;
+}
+
+VkCommandBuffer CommandManager::AllocateThreadCommandBuffer(uint32_t thread)
+{
+	ThreadPool& pool = threadPools[currentFrame][thread % threadCount];
+
+	if (pool.used == pool.buffers.size())
+	{
+		VkCommandBufferAllocateInfo info
+		{
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.pNext = nullptr,
+			.commandPool = pool.pool,
+			.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+			.commandBufferCount = 1,
+		};
+
+		VkCommandBuffer cmd = VK_NULL_HANDLE;
+		VK_CHECK(vkAllocateCommandBuffers(device, &info, &cmd));
+		pool.buffers.push_back(cmd);
+	}
+
+	return pool.buffers[pool.used++];
+}
+
+uint32_t CommandManager::GetThreadCount()
+{
+	return threadCount;
+}
+
+void CommandManager::RecordSecondary(VkCommandBuffer primary, const VkCommandBufferInheritanceInfo& inheritance, uint32_t count, const SecondaryRecordFn& record)
+{
+	if (count == 0)
+		return;
+
+	SmallVector<VkCommandBuffer, 16> secondaries(count, VK_NULL_HANDLE);
+
+	VkCommandBufferBeginInfo begin{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.pNext = nullptr,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+		.pInheritanceInfo = &inheritance,
+	};
+
+	// each job records into the pool of the worker running it, the output slot
+	// only depends on the index so the execution order is deterministic.
+	Jobs::ParallelFor(count, 1, [&](uint32_t first, uint32_t last) {
+		uint32_t thread = Jobs::GetWorkerIndex();
+
+		for (uint32_t i = first; i < last; i++)
+		{
+			VkCommandBuffer cmd = AllocateThreadCommandBuffer(thread);
+
+			VK_CHECK(vkBeginCommandBuffer(cmd, &begin));
+			record(cmd, i);
+			VK_CHECK(vkEndCommandBuffer(cmd));
+
+			secondaries[i] = cmd;
+		}
+	});
+
+	vkCmdExecuteCommands(primary, count, secondaries.data());
 }
 
 
@@ -43,17 +424,42 @@ VkCommandBuffer CommandManager::BeginSingleTimeCommand(VulkanAPI::CommandType ty
 	return singleTimeBuffer;
 }
 
-void CommandManager::EndSingleTimeCommand(VkCommandBuffer cmd, VulkanAPI::CommandType type, VkFence& fence)
+void CommandManager::EndSingleTimeCommand(VkCommandBuffer cmd, VulkanAPI::CommandType type, VkFence& fence, const VulkanAPI::TimelineWaitList& waits, VkSemaphore signal)
 {
 	VK_CHECK(vkEndCommandBuffer(cmd));
 
 	VK_CHECK(vkResetFences(device, 1, &fence));
 
+	SmallVector<VkSemaphore, 4> waitSemaphores;
+	SmallVector<uint64_t, 4> waitValues;
+	SmallVector<VkPipelineStageFlags, 4> waitStages;
+
+	for (const auto& wait : waits)
+	{
+		waitSemaphores.push_back(wait.semaphore);
+		waitValues.push_back(wait.value);
+		waitStages.push_back(wait.stage);
+	}
+
+	VkTimelineSemaphoreSubmitInfo timeline
+	{
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+		.pNext = nullptr,
+		.waitSemaphoreValueCount = (uint32_t)waitValues.size(),
+		.pWaitSemaphoreValues = waitValues.data(),
+	};
+
 	VkSubmitInfo info
 	{
 		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.pNext = waits.empty() ? nullptr : &timeline,
+		.waitSemaphoreCount = (uint32_t)waitSemaphores.size(),
+		.pWaitSemaphores = waitSemaphores.data(),
+		.pWaitDstStageMask = waitStages.data(),
 		.commandBufferCount = 1,
 		.pCommandBuffers = &cmd,
+		.signalSemaphoreCount = signal != VK_NULL_HANDLE ? 1u : 0u,
+		.pSignalSemaphores = &signal,
 	};
 
 	VK_CHECK(vkQueueSubmit(GetQueue(type), 1, &info, fence));
@@ -64,6 +470,56 @@ void CommandManager::EndSingleTimeCommand(VkCommandBuffer cmd, VulkanAPI::Comman
 
 }
 
+VkCommandBuffer CommandManager::AllocateCommandBuffer(VulkanAPI::CommandType type, VkCommandBufferLevel level)
+{
+	VkCommandBufferAllocateInfo info
+	{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		.pNext = nullptr,
+		.commandPool = GetPool(type),
+		.level = level,
+		.commandBufferCount = 1,
+	};
+
+	VkCommandBuffer cmd = VK_NULL_HANDLE;
+
+	VK_CHECK(vkAllocateCommandBuffers(device, &info, &cmd));
+
+	return cmd;
+}
+
+void CommandManager::FreeCommandBuffer(VulkanAPI::CommandType type, VkCommandBuffer cmd)
+{
+	if (cmd != VK_NULL_HANDLE)
+		vkFreeCommandBuffers(device, GetPool(type), 1, &cmd);
+}
+
+uint32_t CommandManager::GetQueueFamilyIndex(VulkanAPI::CommandType type)
+{
+	std::optional<uint32_t> index;
+
+	switch (type)
+	{
+	case VulkanAPI::CommandType::Graphics:
+		index = queueFamily.graphics;
+		break;
+	case VulkanAPI::CommandType::Present:
+		index = queueFamily.present;
+		break;
+	case VulkanAPI::CommandType::Compute:
+		index = queueFamily.compute;
+		break;
+	case VulkanAPI::CommandType::Transfer:
+		index = queueFamily.transfer;
+		break;
+	case VulkanAPI::CommandType::SparseBinding:
+		index = queueFamily.sparse_binding;
+		break;
+	}
+
+	return index.value_or(VK_QUEUE_FAMILY_IGNORED);
+}
+
 VkQueue CommandManager::GetPresentQueue()
 {
 	return CommandQueues.Present;
@@ -2,30 +2,131 @@
 
 #include <graphics/vulkan_api.h>
 
+#include <array>
+#include <functional>
+#include <optional>
+
 namespace VulkanAPI {
 
 }
 
 class CommandManager {
 public:
+	// frames that can be recorded while the gpu still works on older ones.
+	static constexpr uint32_t FramesInFlight = 2;
+
+	using SecondaryRecordFn = std::function<void(VkCommandBuffer cmd, uint32_t index)>;
+
+	// every queue gets a timeline semaphore, the device must have them enabled.
 	CommandManager(VkDevice device, VulkanAPI::QueueFamily queuFamily);
 	~CommandManager();
 
+	// waits for everything the previous use of `frame`'s slot submitted, then resets the slot's pools.
+	void BeginFrame(uint32_t frame);
+	// frame slot in [0, FramesInFlight) of the frame being recorded.
+	uint32_t GetCurrentFrame();
+
+	// records `count` secondary command buffers inside the render pass described by `inheritance`,
+	// spread over the job workers, then executes them from `primary` in index order.
+	void RecordSecondary(VkCommandBuffer primary, const VkCommandBufferInheritanceInfo& inheritance, uint32_t count, const SecondaryRecordFn& record);
+
+	// secondary buffer from the pool `thread` owns for the current frame, only that thread may use it.
+	// `thread` is a Jobs::GetWorkerIndex().
+	VkCommandBuffer AllocateThreadCommandBuffer(uint32_t thread);
+	uint32_t GetThreadCount();
+
 
+	// SUBMISSION
+	// primary buffer from the current frame's pool of `type` (Graphics or Compute), recycled by BeginFrame.
+	VkCommandBuffer BeginFrameCommand(VulkanAPI::CommandType type);
+	// submits without blocking. every queue type has a timeline semaphore, the submission signals
+	// its next value and returns it. `signal` is an optional binary semaphore, e.g. for presenting.
+	uint64_t Submit(VkCommandBuffer cmd, VulkanAPI::CommandType type, const VulkanAPI::TimelineWaitList& waits = {}, VkSemaphore signal = VK_NULL_HANDLE);
+
+	VulkanAPI::TimelineWait GetWait(VulkanAPI::CommandType type, uint64_t value, VkPipelineStageFlags stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+	bool IsComplete(VulkanAPI::CommandType type, uint64_t value);
+	void Wait(VulkanAPI::CommandType type, uint64_t value);
+
+	// OWNERSHIP
+	// hands `buffer` over from the `src` queue to the `dst` queue. records the release half in `cmd`
+	// when the two live in different families, the next AcquireOwnership() towards `dst` completes it.
+	void ReleaseBuffer(VkCommandBuffer cmd, VulkanAPI::CommandType src, VulkanAPI::CommandType dst, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size,
+		VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkAccessFlags dstAccess);
+	// records the acquire half of every hand-off submitted towards `dst` and appends the timeline
+	// waits its submission needs, so `dstStage` runs after the releasing submissions.
+	void AcquireOwnership(VkCommandBuffer cmd, VulkanAPI::CommandType dst, VkPipelineStageFlags dstStage, VulkanAPI::TimelineWaitList& waits);
+
+	// blocks until `cmd` completed, for one off work outside the frame.
 	VkCommandBuffer BeginSingleTimeCommand(VulkanAPI::CommandType type);
-	void EndSingleTimeCommand(VkCommandBuffer cmd, VulkanAPI::CommandType type, VkFence& fence);
+	// binary semaphores can be waited on through `waits` as well, their value is ignored.
+	// `signal` is an optional binary semaphore signaled once `cmd` completes.
+	void EndSingleTimeCommand(VkCommandBuffer cmd, VulkanAPI::CommandType type, VkFence& fence, const VulkanAPI::TimelineWaitList& waits = {}, VkSemaphore signal = VK_NULL_HANDLE);
+
+	VkCommandBuffer AllocateCommandBuffer(VulkanAPI::CommandType type, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+	void FreeCommandBuffer(VulkanAPI::CommandType type, VkCommandBuffer cmd);
 
 	VkQueue GetPresentQueue();
+	VkQueue GetQueue(VulkanAPI::CommandType type);
+	uint32_t GetQueueFamilyIndex(VulkanAPI::CommandType type);
 
 private:
+	struct ThreadPool {
+		VkCommandPool pool = VK_NULL_HANDLE;
+		std::vector<VkCommandBuffer> buffers;
+		uint32_t used = 0;
+	};
+
+	struct Timeline {
+		VkSemaphore semaphore = VK_NULL_HANDLE;
+		uint64_t next = 1;
+	};
+
+	struct Release {
+		VkCommandBuffer cmd;
+		VulkanAPI::CommandType src;
+		VulkanAPI::CommandType dst;
+		VkBufferMemoryBarrier barrier;
+	};
+
+	struct Handoff {
+		VulkanAPI::CommandType src;
+		uint64_t value;
+		// only when the families differ.
+		std::optional<VkBufferMemoryBarrier> barrier;
+	};
+
+	// the queue types frames submit to.
+	static constexpr uint32_t FrameQueueCount = 2;
+	static uint32_t GetFrameQueueIndex(VulkanAPI::CommandType type);
+
+	void CreateThreadPools();
+	void FreeThreadPools();
+	void CreateFramePools();
+	void FreeFramePools();
+
 	VkCommandPool GetPool(VulkanAPI::CommandType type);
-	VkQueue GetQueue(VulkanAPI::CommandType type);
 	VkCommandBuffer GetSingleTimeBuffer(VulkanAPI::CommandType type);
 	void SetSingleTimeBuffer(VulkanAPI::CommandType type, const VkCommandBuffer& cmd);
 
 	VkDevice device;
+	VulkanAPI::QueueFamily queueFamily;
 	VulkanAPI::CommandPoolBlock CommandPools;
 	VulkanAPI::QueueHandleBlock CommandQueues;
 
+	// graphics pools indexed [frame][thread]
+	std::array<std::vector<ThreadPool>, FramesInFlight> threadPools;
+	// primary pools indexed [frame][frame queue]
+	std::array<std::array<ThreadPool, FrameQueueCount>, FramesInFlight> framePools;
+
+	std::array<Timeline, FrameQueueCount> timelines;
+	// last value each frame slot submitted per frame queue.
+	std::array<std::array<uint64_t, FrameQueueCount>, FramesInFlight> frameValues{};
+
+	std::vector<Release> releases;
+	std::array<std::vector<Handoff>, FrameQueueCount> handoffs;
+
+	uint32_t threadCount;
+	uint32_t currentFrame = 0;
+
 
 };
\ No newline at end of file
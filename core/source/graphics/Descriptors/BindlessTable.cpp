@@ -0,0 +1,224 @@
+#include "BindlessTable.h"
+
+#include "DescriptorLayoutCache.h"
+
+#include <debug/Console.h>
+
+#include <algorithm>
+
+BindlessTable::BindlessTable(VkDevice device, VkPhysicalDevice physicalDevice, DescriptorLayoutCache* layouts, const VulkanAPI::DeviceFeatures& features, uint32_t maxTextures, uint32_t maxBuffers)
+	: device{ device }
+{
+	// covers descriptorBindingSampledImageUpdateAfterBind and the rest the table relies on.
+	if (!features.descriptorIndexing)
+	{
+		Console::Warn("Bindless Table Needs Descriptor Indexing With Update After Bind.");
+		return;
+	}
+
+	VkPhysicalDeviceVulkan12Properties limits{};
+	limits.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+	VkPhysicalDeviceProperties2 properties{};
+	properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext = &limits;
+
+	vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+	// every stage sees both arrays, the per stage limits apply as well as the per set ones.
+	// a combined image sampler counts as a sampler and as a sampled image.
+	maxTextures = std::min({ maxTextures,
+		limits.maxDescriptorSetUpdateAfterBindSampledImages, limits.maxDescriptorSetUpdateAfterBindSamplers,
+		limits.maxPerStageDescriptorUpdateAfterBindSampledImages, limits.maxPerStageDescriptorUpdateAfterBindSamplers });
+
+	maxBuffers = std::min({ maxBuffers,
+		limits.maxDescriptorSetUpdateAfterBindStorageBuffers, limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers });
+
+	// both arrays share one per stage budget.
+	uint32_t resources = limits.maxPerStageUpdateAfterBindResources;
+	if ((uint64_t)maxTextures + maxBuffers > resources)
+	{
+		maxTextures = std::min(maxTextures, resources / 2);
+		maxBuffers = std::min(maxBuffers, resources - maxTextures);
+	}
+
+	if (maxTextures == 0 || maxBuffers == 0)
+	{
+		Console::Warn("Device Allows No Update After Bind Descriptors, Bindless Table Disabled.");
+		return;
+	}
+
+	textures.capacity = maxTextures;
+	buffers.capacity = maxBuffers;
+
+	DescriptorBindingList bindings;
+	bindings.push_back({
+		.binding = TextureBinding,
+		.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		.descriptorCount = maxTextures,
+		.stageFlags = VK_SHADER_STAGE_ALL,
+	});
+	bindings.push_back({
+		.binding = BufferBinding,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.descriptorCount = maxBuffers,
+		.stageFlags = VK_SHADER_STAGE_ALL,
+	});
+
+	// unused slots are never written, live ones change while frames using the set are in flight.
+	VkDescriptorBindingFlags flags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+	DescriptorBindingFlagList bindingFlags;
+	bindingFlags.push_back(flags);
+	bindingFlags.push_back(flags);
+
+	layout = layouts->Get(bindings, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT, bindingFlags);
+
+	VkDescriptorPoolSize sizes[] =
+	{
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxTextures },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, maxBuffers },
+	};
+
+	VkDescriptorPoolCreateInfo poolInfo
+	{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+		.maxSets = 1,
+		.poolSizeCount = _countof(sizes),
+		.pPoolSizes = sizes,
+	};
+
+	VK_CHECK(vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool));
+
+	VkDescriptorSetAllocateInfo allocInfo
+	{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.pNext = nullptr,
+		.descriptorPool = pool,
+		.descriptorSetCount = 1,
+		.pSetLayouts = &layout,
+	};
+
+	VK_CHECK(vkAllocateDescriptorSets(device, &allocInfo, &set));
+}
+
+BindlessTable::~BindlessTable()
+{
+	// the layout belongs to the cache.
+	if (pool)
+		vkDestroyDescriptorPool(device, pool, nullptr);
+}
+
+bool BindlessTable::IsSupported()
+{
+	return set != VK_NULL_HANDLE;
+}
+
+void BindlessTable::BeginFrame(uint32_t frame)
+{
+	this->frame = frame % CommandManager::FramesInFlight;
+
+	for (Slots* slots : { &textures, &buffers })
+	{
+		auto& retired = slots->retired[this->frame];
+		slots->free.insert(slots->free.end(), retired.begin(), retired.end());
+		retired.clear();
+	}
+}
+
+uint32_t BindlessTable::AddTexture(VkImageView view, VkSampler sampler, VkImageLayout imageLayout)
+{
+	uint32_t index = textures.Acquire();
+	if (index == InvalidIndex)
+	{
+		Console::Warn("Bindless Texture Table Is Full.");
+		return InvalidIndex;
+	}
+
+	VkDescriptorImageInfo info{ sampler, view, imageLayout };
+
+	VkWriteDescriptorSet write
+	{
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.pNext = nullptr,
+		.dstSet = set,
+		.dstBinding = TextureBinding,
+		.dstArrayElement = index,
+		.descriptorCount = 1,
+		.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+		.pImageInfo = &info,
+	};
+
+	vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+
+	return index;
+}
+
+uint32_t BindlessTable::AddBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+	uint32_t index = buffers.Acquire();
+	if (index == InvalidIndex)
+	{
+		Console::Warn("Bindless Buffer Table Is Full.");
+		return InvalidIndex;
+	}
+
+	VkDescriptorBufferInfo info{ buffer, offset, range };
+
+	VkWriteDescriptorSet write
+	{
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.pNext = nullptr,
+		.dstSet = set,
+		.dstBinding = BufferBinding,
+		.dstArrayElement = index,
+		.descriptorCount = 1,
+		.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+		.pBufferInfo = &info,
+	};
+
+	vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+
+	return index;
+}
+
+void BindlessTable::RemoveTexture(uint32_t index)
+{
+	if (index != InvalidIndex)
+		textures.retired[frame].push_back(index);
+}
+
+void BindlessTable::RemoveBuffer(uint32_t index)
+{
+	if (index != InvalidIndex)
+		buffers.retired[frame].push_back(index);
+}
+
+void BindlessTable::Bind(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout, uint32_t setIndex)
+{
+	vkCmdBindDescriptorSets(cmd, bindPoint, pipelineLayout, setIndex, 1, &set, 0, nullptr);
+}
+
+VkDescriptorSetLayout BindlessTable::GetLayout()
+{
+	return layout;
+}
+
+VkDescriptorSet BindlessTable::GetSet()
+{
+	return set;
+}
+
+uint32_t BindlessTable::Slots::Acquire()
+{
+	if (!free.empty())
+	{
+		uint32_t index = free.back();
+		free.pop_back();
+		return index;
+	}
+
+	return next < capacity ? next++ : InvalidIndex;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <graphics/gfx_pch.h>
+#include <graphics/CommandManager.h>
+
+#include <array>
+#include <vector>
+
+class DescriptorLayoutCache;
+
+// one long lived descriptor set holding every registered texture and storage buffer.
+//
+// shaders index the arrays with the handle Add*() returned, so draws only pass
+// indices (push constants, instance data) and never allocate or update a set.
+// needs descriptor indexing, slots are written with update after bind while the
+// set is bound. a removed slot is reused once every frame that could still read
+// it has completed.
+//
+// set layout: binding 0 sampler2D textures[], binding 1 storage buffers[].
+class BindlessTable {
+public:
+	static constexpr uint32_t TextureBinding = 0;
+	static constexpr uint32_t BufferBinding = 1;
+
+	static constexpr uint32_t InvalidIndex = 0xFFFFFFFF;
+
+	// the capacities are clamped to the device's update after bind limits.
+	BindlessTable(VkDevice device, VkPhysicalDevice physicalDevice, DescriptorLayoutCache* layouts, const VulkanAPI::DeviceFeatures& features, uint32_t maxTextures = 4096, uint32_t maxBuffers = 4096);
+	~BindlessTable();
+
+	BindlessTable(const BindlessTable&) = delete;
+	BindlessTable& operator=(const BindlessTable&) = delete;
+
+	// false without descriptor indexing, the table then holds no set and every Add*() fails.
+	bool IsSupported();
+
+	// recycles the slots removed the last time `frame`'s slot was recorded.
+	void BeginFrame(uint32_t frame);
+
+	uint32_t AddTexture(VkImageView view, VkSampler sampler, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	uint32_t AddBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+	void RemoveTexture(uint32_t index);
+	void RemoveBuffer(uint32_t index);
+
+	void Bind(VkCommandBuffer cmd, VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t setIndex);
+
+	VkDescriptorSetLayout GetLayout();
+	VkDescriptorSet GetSet();
+
+private:
+	struct Slots {
+		uint32_t capacity = 0;
+		uint32_t next = 0;
+		std::vector<uint32_t> free;
+		// removed during a frame slot, free again once it comes around.
+		std::array<std::vector<uint32_t>, CommandManager::FramesInFlight> retired;
+
+		uint32_t Acquire();
+	};
+
+	VkDevice device;
+
+	VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+	VkDescriptorPool pool = VK_NULL_HANDLE;
+	VkDescriptorSet set = VK_NULL_HANDLE;
+
+	uint32_t frame = 0;
+
+	Slots textures;
+	Slots buffers;
+};
@@ -0,0 +1,176 @@
+#include "DescriptorAllocator.h"
+
+#include <algorithm>
+
+namespace {
+	// descriptors per set of each type a pool is sized for, roughly what the pipelines declare.
+	struct PoolRatio {
+		VkDescriptorType type;
+		float perSet;
+	};
+
+	constexpr PoolRatio PoolRatios[] = {
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f },
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4.0f },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.0f },
+		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f },
+	};
+
+	// a pool never grows past this many sets, later pools are added instead.
+	constexpr uint32_t MaxSetsPerPool = 4096;
+}
+
+DescriptorAllocator::DescriptorAllocator(VkDevice device, uint32_t setsPerPool)
+	: device{ device }, setsPerPool{ setsPerPool }
+{
+}
+
+DescriptorAllocator::~DescriptorAllocator()
+{
+	// destroying a pool frees its sets.
+	for (auto& slot : frames)
+		for (VkDescriptorPool pool : slot.pools)
+			vkDestroyDescriptorPool(device, pool, nullptr);
+}
+
+void DescriptorAllocator::BeginFrame(uint32_t frame)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	this->frame = frame % frames.size();
+
+	FramePools& slot = frames[this->frame];
+	for (VkDescriptorPool pool : slot.pools)
+		VK_CHECK(vkResetDescriptorPool(device, pool, 0));
+
+	slot.current = 0;
+}
+
+VkDescriptorSet DescriptorAllocator::Allocate(VkDescriptorSetLayout layout)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	FramePools& slot = frames[frame];
+
+	VkDescriptorSetAllocateInfo info
+	{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.pNext = nullptr,
+		.descriptorSetCount = 1,
+		.pSetLayouts = &layout,
+	};
+
+	VkDescriptorSet set = VK_NULL_HANDLE;
+
+	// walk forward through the slot's pools, a full pool stays full for the rest of the frame.
+	while (slot.current < slot.pools.size())
+	{
+		info.descriptorPool = slot.pools[slot.current];
+
+		VkResult result = vkAllocateDescriptorSets(device, &info, &set);
+		if (result == VK_SUCCESS)
+			return set;
+
+		if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+			VK_CHECK(result);
+
+		slot.current++;
+	}
+
+	// GROW
+	// every new pool is twice the size of the last one.
+	uint32_t sets = std::min(MaxSetsPerPool, setsPerPool << std::min<size_t>(slot.pools.size(), 4));
+	slot.pools.push_back(CreatePool(sets));
+
+	info.descriptorPool = slot.pools.back();
+	VK_CHECK(vkAllocateDescriptorSets(device, &info, &set));
+
+	return set;
+}
+
+uint32_t DescriptorAllocator::GetPoolCount()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	size_t count = 0;
+	for (const auto& slot : frames)
+		count += slot.pools.size();
+
+	return (uint32_t)count;
+}
+
+VkDescriptorPool DescriptorAllocator::CreatePool(uint32_t sets)
+{
+	SmallVector<VkDescriptorPoolSize, 8> sizes;
+	for (const PoolRatio& ratio : PoolRatios)
+		sizes.push_back({ ratio.type, std::max(1u, (uint32_t)(ratio.perSet * sets)) });
+
+	VkDescriptorPoolCreateInfo info
+	{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.maxSets = sets,
+		.poolSizeCount = (uint32_t)sizes.size(),
+		.pPoolSizes = sizes.data(),
+	};
+
+	VkDescriptorPool pool = VK_NULL_HANDLE;
+	VK_CHECK(vkCreateDescriptorPool(device, &info, nullptr, &pool));
+
+	return pool;
+}
+
+DescriptorWriter& DescriptorWriter::WriteBuffer(uint32_t binding, VkDescriptorType type, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range, uint32_t arrayElement)
+{
+	writes.push_back({ binding, arrayElement, type, (uint32_t)buffers.size(), false });
+	buffers.push_back({ buffer, offset, range });
+	return *this;
+}
+
+DescriptorWriter& DescriptorWriter::WriteImage(uint32_t binding, VkDescriptorType type, VkImageView view, VkSampler sampler, VkImageLayout layout, uint32_t arrayElement)
+{
+	writes.push_back({ binding, arrayElement, type, (uint32_t)images.size(), true });
+	images.push_back({ sampler, view, layout });
+	return *this;
+}
+
+void DescriptorWriter::Update(VkDevice device, VkDescriptorSet set)
+{
+	if (writes.empty())
+		return;
+
+	// the infos are only pointed at once every write is in, the vectors no longer move.
+	SmallVector<VkWriteDescriptorSet, 8> updates;
+
+	for (const Write& write : writes)
+	{
+		updates.push_back({
+			.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+			.pNext = nullptr,
+			.dstSet = set,
+			.dstBinding = write.binding,
+			.dstArrayElement = write.arrayElement,
+			.descriptorCount = 1,
+			.descriptorType = write.type,
+			.pImageInfo = write.image ? &images[write.info] : nullptr,
+			.pBufferInfo = write.image ? nullptr : &buffers[write.info],
+		});
+	}
+
+	vkUpdateDescriptorSets(device, (uint32_t)updates.size(), updates.data(), 0, nullptr);
+}
+
+void DescriptorWriter::Clear()
+{
+	writes.clear();
+	buffers.clear();
+	images.clear();
+}
+
+bool DescriptorWriter::Empty() const
+{
+	return writes.empty();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <graphics/gfx_pch.h>
+#include <graphics/CommandManager.h>
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+// descriptor sets that live for a single frame.
+//
+// every frame slot owns a list of pools that grows on demand. BeginFrame()
+// resets the slot's pools wholesale instead of freeing sets one by one, a
+// set handed out during a frame is valid until that slot comes around again.
+class DescriptorAllocator {
+public:
+	explicit DescriptorAllocator(VkDevice device, uint32_t setsPerPool = 256);
+	~DescriptorAllocator();
+
+	DescriptorAllocator(const DescriptorAllocator&) = delete;
+	DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+	// the slot's previous frame must have completed on the gpu.
+	void BeginFrame(uint32_t frame);
+
+	VkDescriptorSet Allocate(VkDescriptorSetLayout layout);
+
+	uint32_t GetPoolCount();
+
+private:
+	struct FramePools {
+		std::vector<VkDescriptorPool> pools;
+		uint32_t current = 0;
+	};
+
+	VkDescriptorPool CreatePool(uint32_t sets);
+
+	std::mutex mutex;
+	VkDevice device;
+
+	uint32_t setsPerPool;
+	uint32_t frame = 0;
+
+	std::array<FramePools, CommandManager::FramesInFlight> frames;
+};
+
+// batches the writes of one set into a single vkUpdateDescriptorSets.
+class DescriptorWriter {
+public:
+	DescriptorWriter& WriteBuffer(uint32_t binding, VkDescriptorType type, VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE, uint32_t arrayElement = 0);
+	DescriptorWriter& WriteImage(uint32_t binding, VkDescriptorType type, VkImageView view, VkSampler sampler, VkImageLayout layout, uint32_t arrayElement = 0);
+
+	void Update(VkDevice device, VkDescriptorSet set);
+	void Clear();
+
+	bool Empty() const;
+
+private:
+	struct Write {
+		uint32_t binding;
+		uint32_t arrayElement;
+		VkDescriptorType type;
+		// index into `buffers` or `images`.
+		uint32_t info;
+		bool image;
+	};
+
+	SmallVector<Write, 8> writes;
+	SmallVector<VkDescriptorBufferInfo, 8> buffers;
+	SmallVector<VkDescriptorImageInfo, 8> images;
+};
@@ -0,0 +1,117 @@
+#include "DescriptorLayoutCache.h"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+DescriptorLayoutCache::DescriptorLayoutCache(VkDevice device)
+	: device{ device }
+{
+}
+
+DescriptorLayoutCache::~DescriptorLayoutCache()
+{
+	for (auto it = layouts.begin(); it != layouts.end(); ++it)
+		vkDestroyDescriptorSetLayout(device, it->second, nullptr);
+}
+
+VkDescriptorSetLayout DescriptorLayoutCache::Get(const DescriptorBindingList& bindings, VkDescriptorSetLayoutCreateFlags flags, const DescriptorBindingFlagList& bindingFlags)
+{
+	assert((bindingFlags.empty() || bindingFlags.size() == bindings.size()) && "Binding Flags Must Match The Bindings.");
+
+	// sorted by binding so declaration order does not matter.
+	SmallVector<uint32_t, 8> order;
+	order.resize(bindings.size());
+	std::iota(order.begin(), order.end(), 0u);
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return bindings[a].binding < bindings[b].binding; });
+
+	Key key;
+	key.flags = flags;
+
+	for (uint32_t i : order)
+	{
+		assert(bindings[i].pImmutableSamplers == nullptr && "Immutable Samplers Are Not Cached.");
+
+		key.bindings.push_back(bindings[i]);
+		if (!bindingFlags.empty())
+			key.bindingFlags.push_back(bindingFlags[i]);
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto found = layouts.find(key);
+	if (found != layouts.end())
+		return found->second;
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo flagsInfo
+	{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+		.pNext = nullptr,
+		.bindingCount = (uint32_t)key.bindingFlags.size(),
+		.pBindingFlags = key.bindingFlags.data(),
+	};
+
+	VkDescriptorSetLayoutCreateInfo info
+	{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.pNext = key.bindingFlags.empty() ? nullptr : &flagsInfo,
+		.flags = flags,
+		.bindingCount = (uint32_t)key.bindings.size(),
+		.pBindings = key.bindings.data(),
+	};
+
+	VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+	VK_CHECK(vkCreateDescriptorSetLayout(device, &info, nullptr, &layout));
+
+	layouts.try_emplace(key, layout);
+
+	return layout;
+}
+
+uint32_t DescriptorLayoutCache::GetLayoutCount()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return (uint32_t)layouts.size();
+}
+
+bool DescriptorLayoutCache::Key::operator==(const Key& other) const
+{
+	if (flags != other.flags || bindings.size() != other.bindings.size() || bindingFlags.size() != other.bindingFlags.size())
+		return false;
+
+	for (size_t i = 0; i < bindings.size(); i++)
+	{
+		const auto& a = bindings[i];
+		const auto& b = other.bindings[i];
+
+		if (a.binding != b.binding || a.descriptorType != b.descriptorType || a.descriptorCount != b.descriptorCount || a.stageFlags != b.stageFlags)
+			return false;
+	}
+
+	return std::equal(bindingFlags.begin(), bindingFlags.end(), other.bindingFlags.begin());
+}
+
+size_t DescriptorLayoutCache::KeyHash::operator()(const Key& key) const
+{
+	// FNV-1a over the fields that make two layouts different, the map mixes the result.
+	uint64_t hash = 14695981039346656037ull;
+	auto add = [&](uint64_t value) {
+		hash ^= value;
+		hash *= 1099511628211ull;
+	};
+
+	add(key.flags);
+
+	for (const auto& binding : key.bindings)
+	{
+		add(binding.binding);
+		add(binding.descriptorType);
+		add(binding.descriptorCount);
+		add(binding.stageFlags);
+	}
+
+	for (VkDescriptorBindingFlags flags : key.bindingFlags)
+		add(flags);
+
+	return (size_t)hash;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <graphics/gfx_pch.h>
+
+#include <mutex>
+
+using DescriptorBindingList = SmallVector<VkDescriptorSetLayoutBinding, 8>;
+using DescriptorBindingFlagList = SmallVector<VkDescriptorBindingFlags, 8>;
+
+// one VkDescriptorSetLayout per distinct set of bindings.
+//
+// pipelines ask for their layouts by content, equal layouts come back as the
+// same handle so sets allocated for one pipeline are compatible with every
+// other pipeline that declares the same bindings. owns every layout it hands out.
+class DescriptorLayoutCache {
+public:
+	explicit DescriptorLayoutCache(VkDevice device);
+	~DescriptorLayoutCache();
+
+	DescriptorLayoutCache(const DescriptorLayoutCache&) = delete;
+	DescriptorLayoutCache& operator=(const DescriptorLayoutCache&) = delete;
+
+	// `bindingFlags` is either empty or holds one entry per binding, in the same order.
+	// immutable samplers are not supported.
+	VkDescriptorSetLayout Get(const DescriptorBindingList& bindings, VkDescriptorSetLayoutCreateFlags flags = 0, const DescriptorBindingFlagList& bindingFlags = {});
+
+	uint32_t GetLayoutCount();
+
+private:
+	struct Key {
+		DescriptorBindingList bindings;
+		DescriptorBindingFlagList bindingFlags;
+		VkDescriptorSetLayoutCreateFlags flags = 0;
+
+		bool operator==(const Key& other) const;
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& key) const;
+	};
+
+	std::mutex mutex;
+	VkDevice device;
+
+	FlatHashMap<Key, VkDescriptorSetLayout, KeyHash> layouts;
+};
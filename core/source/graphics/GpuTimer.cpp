@@ -0,0 +1,85 @@
+#include "GpuTimer.h"
+
+#include <vector>
+
+GpuTimer::GpuTimer(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamily)
+	: device{ device }
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+	uint32_t familyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> families(familyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &familyCount, families.data());
+
+	uint32_t validBits = queueFamily < familyCount ? families[queueFamily].timestampValidBits : 0;
+	if (validBits == 0 || properties.limits.timestampPeriod <= 0.0f)
+		return;
+
+	period = properties.limits.timestampPeriod;
+	mask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+	VkQueryPoolCreateInfo info
+	{
+		.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.queryType = VK_QUERY_TYPE_TIMESTAMP,
+		.queryCount = 2 * CommandManager::FramesInFlight,
+	};
+
+	VK_CHECK(vkCreateQueryPool(device, &info, nullptr, &pool));
+}
+
+GpuTimer::~GpuTimer()
+{
+	if (pool)
+		vkDestroyQueryPool(device, pool, nullptr);
+}
+
+bool GpuTimer::IsSupported()
+{
+	return pool != VK_NULL_HANDLE;
+}
+
+void GpuTimer::Begin(VkCommandBuffer cmd, uint32_t frame)
+{
+	if (!pool)
+		return;
+
+	uint32_t slot = frame % CommandManager::FramesInFlight;
+
+	vkCmdResetQueryPool(cmd, pool, slot * 2, 2);
+	vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, pool, slot * 2);
+}
+
+void GpuTimer::End(VkCommandBuffer cmd, uint32_t frame)
+{
+	if (!pool)
+		return;
+
+	uint32_t slot = frame % CommandManager::FramesInFlight;
+
+	vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, pool, slot * 2 + 1);
+	pending[slot] = true;
+}
+
+double GpuTimer::Read(uint32_t frame)
+{
+	uint32_t slot = frame % CommandManager::FramesInFlight;
+	if (!pool || !pending[slot])
+		return -1.0;
+
+	uint64_t ticks[2];
+	VkResult result = vkGetQueryPoolResults(device, pool, slot * 2, 2, sizeof(ticks), ticks, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+
+	// not submitted, or skipped after an out of date swapchain.
+	if (result != VK_SUCCESS)
+		return -1.0;
+
+	pending[slot] = false;
+
+	uint64_t elapsed = ((ticks[1] & mask) - (ticks[0] & mask)) & mask;
+	return (double)elapsed * period / 1000000.0;
+}
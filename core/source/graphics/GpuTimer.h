@@ -0,0 +1,40 @@
+#pragma once
+
+#include <graphics/gfx_pch.h>
+#include <graphics/CommandManager.h>
+
+#include <array>
+
+// gpu time of a span of one frame's commands, from timestamp queries.
+//
+// every frame slot owns a pair of queries. Begin()/End() write them while the
+// frame is recorded, Read() picks the result up once CommandManager::BeginFrame
+// waited on the slot again, so reading never stalls.
+class GpuTimer {
+public:
+	GpuTimer(VkDevice device, VkPhysicalDevice physicalDevice, uint32_t queueFamily);
+	~GpuTimer();
+
+	GpuTimer(const GpuTimer&) = delete;
+	GpuTimer& operator=(const GpuTimer&) = delete;
+
+	// false when the queue family does not write timestamps, Begin/End then record nothing.
+	bool IsSupported();
+
+	// outside a render pass, resets the slot's queries before the first timestamp.
+	void Begin(VkCommandBuffer cmd, uint32_t frame);
+	void End(VkCommandBuffer cmd, uint32_t frame);
+
+	// milliseconds between Begin and End of the slot's previous frame, negative when there is none.
+	double Read(uint32_t frame);
+
+private:
+	VkDevice device;
+	VkQueryPool pool = VK_NULL_HANDLE;
+
+	// nanoseconds per tick.
+	double period = 0.0;
+	uint64_t mask = 0;
+
+	std::array<bool, CommandManager::FramesInFlight> pending{};
+};
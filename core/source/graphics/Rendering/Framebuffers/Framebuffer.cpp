@@ -3,8 +3,8 @@
 #include <graphics/Rendering/Utils/RenderPipelineFactory.h>
 
 
-Framebuffer::Framebuffer(VkDevice device, Resolution resolution, VulkanAPI::QueueFamily queueFamily)
-	:device{ device }, resolution{resolution}, queueFamily{ queueFamily }
+Framebuffer::Framebuffer(VkDevice device, VkPhysicalDevice physicalDevice, Resolution resolution, VulkanAPI::QueueFamily queueFamily)
+	:device{ device }, physicalDevice{ physicalDevice }, resolution{resolution}, queueFamily{ queueFamily }
 {
 	Create();
 }
@@ -54,7 +54,8 @@ void Framebuffer::CreateRenderPass()
 			.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 			.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
 			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-			.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+			// copied to the swapchain image once the frame is drawn.
+			.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
 		}
 	};
 
@@ -75,6 +76,27 @@ void Framebuffer::CreateRenderPass()
 		}
 	};
 
+	// frames overlap on the gpu, the clear has to wait for the previous frame's copy out
+	// and the copy for this frame's draws.
+	std::vector<VkSubpassDependency> dependencies
+	{
+		{
+			.srcSubpass = VK_SUBPASS_EXTERNAL,
+			.dstSubpass = 0,
+			.srcStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			.srcAccessMask = 0,
+			.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+		},
+		{
+			.srcSubpass = 0,
+			.dstSubpass = VK_SUBPASS_EXTERNAL,
+			.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT,
+			.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+			.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+		},
+	};
 
 	VkRenderPassCreateInfo renderPassCreateInfo
 	{
@@ -88,6 +110,8 @@ void Framebuffer::CreateRenderPass()
 		.subpassCount = (uint32_t)subpasses.size(),
 		.pSubpasses = subpasses.data(),
 
+		.dependencyCount = (uint32_t)dependencies.size(),
+		.pDependencies = dependencies.data(),
 	};
 
 	VK_CHECK(vkCreateRenderPass(device, &renderPassCreateInfo, nullptr, &renderPass));
@@ -134,6 +158,11 @@ VkRenderPass Framebuffer::GetRenderPass() {
 	return renderPass;
 }
 
+VkImage Framebuffer::GetImage(uint32_t attachment)
+{
+	return attachments[attachment].image;
+}
+
 uint32_t Framebuffer::GetWidth()
 {
 	return resolution.width;
@@ -172,7 +201,7 @@ void Framebuffer::CreateAttachments()
 			.arrayLayers = 1,
 			.samples = VK_SAMPLE_COUNT_1_BIT,
 			.tiling = VK_IMAGE_TILING_OPTIMAL,
-			.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+			.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
 			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
 
 			.queueFamilyIndexCount = 1,
@@ -192,7 +221,7 @@ void Framebuffer::CreateAttachments()
 			.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, 
 			.pNext = nullptr, 
 			.allocationSize = memReqs.size,
-			.memoryTypeIndex = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			.memoryTypeIndex = VulkanAPI::FindMemoryType(physicalDevice, memReqs.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
 		};
 
 		VK_CHECK(vkAllocateMemory(device, &allocInfo, nullptr, &color.memory));
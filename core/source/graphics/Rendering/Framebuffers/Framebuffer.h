@@ -2,10 +2,13 @@
 
 #include <graphics/gfx_pch.h>
 #include <datastructures/datastructures_pch.h>
+#include <datastructures/SlotMap.h>
 
 
 class RenderPipeline;
+class Framebuffer;
 
+using FramebufferHandle = Handle32<Framebuffer>;
 
 
 struct FramebufferAttachment {
@@ -17,13 +20,14 @@ struct FramebufferAttachment {
 
 class Framebuffer {
 public:
-	Framebuffer(VkDevice device, Resolution resolution, VulkanAPI::QueueFamily queueFamily);
+	Framebuffer(VkDevice device, VkPhysicalDevice physicalDevice, Resolution resolution, VulkanAPI::QueueFamily queueFamily);
 	~Framebuffer();
 
 	void Create();
 
 	VkFramebuffer Get();
 	VkRenderPass GetRenderPass();
+	VkImage GetImage(uint32_t attachment = 0);
 	
 	uint32_t GetWidth();
 	uint32_t GetHeight();
@@ -37,6 +41,7 @@ private:
 	VkFramebuffer buffer;
 	VkRenderPass renderPass;
 	VkDevice device;
+	VkPhysicalDevice physicalDevice;
 
 	std::vector<FramebufferAttachment> attachments;
 	VulkanAPI::QueueFamily queueFamily;
@@ -0,0 +1,132 @@
+#include "ComputePipeline.h"
+
+#include "graphics/Rendering/Shaders/ShaderGraph.h"
+#include "graphics/Descriptors/DescriptorLayoutCache.h"
+
+void ComputePipeline::Initillize()
+{
+	CreateShader();
+	CreateLayout();
+	CreatePipeline();
+}
+
+void ComputePipeline::Cleanup()
+{
+	OnDestroyPipeline();
+
+	vkDestroyPipeline(device, pipeline, nullptr);
+	vkDestroyPipelineLayout(device, layout, nullptr);
+
+	delete shader;
+	shader = nullptr;
+}
+
+void ComputePipeline::LinkDevice(VkDevice dev)
+{
+	this->device = dev;
+}
+
+void ComputePipeline::LinkLayoutCache(DescriptorLayoutCache* cache)
+{
+	this->layouts = cache;
+}
+
+void ComputePipeline::LinkShaderCache(ShaderCache* shaders)
+{
+	this->shaders = shaders;
+}
+
+void ComputePipeline::BindBuffer(uint32_t binding, VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+{
+	writer.WriteBuffer(binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, buffer, offset, range);
+}
+
+void ComputePipeline::Dispatch(VkCommandBuffer cmd, DescriptorAllocator& descriptors, uint32_t invocations, const void* pushConstants, uint32_t size)
+{
+	if (invocations == 0)
+	{
+		writer.Clear();
+		return;
+	}
+
+	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+
+	if (!writer.Empty())
+	{
+		VkDescriptorSet set = descriptors.Allocate(setLayout);
+		writer.Update(device, set);
+		writer.Clear();
+
+		vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &set, 0, nullptr);
+	}
+
+	if (pushConstants && size > 0)
+		vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, size, pushConstants);
+
+	uint32_t groupSize = GetWorkgroupSize();
+	vkCmdDispatch(cmd, (invocations + groupSize - 1) / groupSize, 1, 1);
+}
+
+uint32_t ComputePipeline::GetWorkgroupSize()
+{
+	return shader->GetWorkgroupSize();
+}
+
+VkPipeline ComputePipeline::Get()
+{
+	return pipeline;
+}
+
+VkPipelineLayout ComputePipeline::GetLayout()
+{
+	return layout;
+}
+
+void ComputePipeline::CreateLayout()
+{
+	setLayout = layouts->Get(shader->GetDescriptorBindings());
+
+	// LAYOUT
+	uint32_t pushConstantSize = shader->GetPushConstantSize();
+
+	VkPushConstantRange pushRange
+	{
+		.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+		.offset = 0,
+		.size = pushConstantSize,
+	};
+
+	VkPipelineLayoutCreateInfo layoutCreateInfo
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.setLayoutCount = 1,
+		.pSetLayouts = &setLayout,
+		.pushConstantRangeCount = pushConstantSize > 0 ? 1u : 0u,
+		.pPushConstantRanges = &pushRange,
+	};
+
+	VK_CHECK(vkCreatePipelineLayout(device, &layoutCreateInfo, nullptr, &layout));
+}
+
+void ComputePipeline::CreatePipeline()
+{
+	VkComputePipelineCreateInfo info
+	{
+		.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.stage = {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.stage = VK_SHADER_STAGE_COMPUTE_BIT,
+			.module = shader->Get(),
+			.pName = "main",
+		},
+		.layout = layout,
+	};
+
+	VK_CHECK(vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &info, nullptr, &pipeline));
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "pch.h"
+
+#include <graphics/gfx_pch.h>
+#include <graphics/Descriptors/DescriptorAllocator.h>
+#include <datastructures/SlotMap.h>
+
+#include <memory>
+
+class ComputePipeline;
+class ShaderGraph;
+class DescriptorLayoutCache;
+class ShaderCache;
+
+using ComputePipelineHandle = Handle32<ComputePipeline>;
+using ComputePipelineTable = SlotMap<std::unique_ptr<ComputePipeline>, ComputePipelineHandle>;
+
+// counterpart of RenderPipeline for a single compute shader.
+//
+// the storage buffers the shader declares make up descriptor set 0. its layout
+// comes from the shared cache, every Dispatch() allocates a fresh set from the
+// frame's DescriptorAllocator with the buffers bound since the last dispatch,
+// so older frames keep reading the regions they were recorded with.
+class ComputePipeline {
+
+public:
+	ComputePipeline() = default;
+	virtual ~ComputePipeline() = default;
+
+	void Initillize();
+	void Cleanup();
+	void LinkDevice(VkDevice device);
+	void LinkLayoutCache(DescriptorLayoutCache* layouts);
+	void LinkShaderCache(ShaderCache* shaders);
+
+	// staged until the next Dispatch(), every binding the shader declares must be bound before it.
+	void BindBuffer(uint32_t binding, VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+	// writes the staged buffers into a set from `descriptors`, binds it and dispatches enough groups to cover `invocations`.
+	void Dispatch(VkCommandBuffer cmd, DescriptorAllocator& descriptors, uint32_t invocations, const void* pushConstants = nullptr, uint32_t pushConstantSize = 0);
+
+	uint32_t GetWorkgroupSize();
+
+	VkPipeline Get();
+	VkPipelineLayout GetLayout();
+
+protected: /* INTERFACE */
+	// fills `shader`, CreatePipeline builds everything else from it.
+	virtual void CreateShader() = 0;
+
+	virtual void OnDestroyPipeline() = 0;
+
+private:
+	void CreateLayout();
+	void CreatePipeline();
+
+protected:
+	VkDevice device;
+	DescriptorLayoutCache* layouts = nullptr;
+	// handed to the ShaderGraph the pipeline creates.
+	ShaderCache* shaders = nullptr;
+
+	ShaderGraph* shader = nullptr;
+
+	VkPipeline pipeline;
+	VkPipelineLayout layout;
+
+	// owned by the layout cache.
+	VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+	DescriptorWriter writer;
+
+};
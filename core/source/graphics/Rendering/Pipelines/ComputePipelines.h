@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Graphics/Rendering/Utils/RenderPipelineFactory.h"
+#include "Graphics/Rendering/Shaders/ShaderGraph.h"
+#include "Graphics/Rendering/Pipelines/RenderPipelines.h"
+
+#include <filesystem>
+#include <debug/Console.h>
+
+namespace ComputePipelines {
+
+	// planes as (normal, distance), a point is inside when dot(normal, p) + distance >= 0 for all six.
+	struct Frustum {
+		float planes[6][4];
+
+		// the clip space volume with the sprites' z range, what 2D draws are tested against until there is a camera.
+		static Frustum ClipSpace() {
+			return { {
+				{ 1, 0, 0, 1 },
+				{ -1, 0, 0, 1 },
+				{ 0, 1, 0, 1 },
+				{ 0, -1, 0, 1 },
+				{ 0, 0, 1, 0 },
+				{ 0, 0, -1, 1 },
+			} };
+		}
+	};
+
+	// tests every RenderPipelines::Instance against a frustum and appends the
+	// visible ones to the draw they belong to.
+	//
+	// binding 0: instances, binding 1: draw index per instance,
+	// binding 2: visible instances, binding 3: VkDrawIndexedIndirectCommands.
+	// every command's instanceCount has to be 0 before the dispatch, its
+	// firstInstance is where the draw's visible instances start.
+	// visible instances of one draw land in no particular order.
+	class FrustumCull : public ComputePipeline {
+
+	public:
+		static constexpr uint32_t GroupSize = 64;
+
+		struct Constants {
+			Frustum frustum;
+			uint32_t count;
+		};
+
+		static void DefineShader(ShaderGraph& shader) {
+			// instances are read as floats, the std430 layout of a struct would pad them.
+			static_assert(sizeof(RenderPipelines::Instance) == 9 * sizeof(float), "Instance Layout Changed, Update The Cull Shader.");
+
+			shader.SetWorkgroupSize(GroupSize);
+
+			shader.AddStorageBuffer(0, "instances", "\tfloat values[];\n", true);
+			shader.AddStorageBuffer(1, "draws", "\tuint values[];\n", true);
+			shader.AddStorageBuffer(2, "visible", "\tfloat values[];\n");
+			shader.AddStorageBuffer(3, "commands", "\tuint values[];\n");
+
+			shader.AddPushConstants("cull", "\tvec4 planes[6];\n\tuint count;\n", sizeof(Constants));
+
+			shader.AddMain(
+				"\tuint i = gl_GlobalInvocationID.x;\n"
+				"\tif (i >= cull.count)\n"
+				"\t\treturn;\n"
+				"\n"
+				"\tuint src = i * 9;\n"
+				"\tvec3 center = vec3(instances.values[src + 0], instances.values[src + 1], 0.0);\n"
+				"\tfloat radius = 0.5 * length(vec2(instances.values[src + 2], instances.values[src + 3]));\n"
+				"\n"
+				"\tfor (int p = 0; p < 6; p++)\n"
+				"\t\tif (dot(cull.planes[p].xyz, center) + cull.planes[p].w < -radius)\n"
+				"\t\t\treturn;\n"
+				"\n"
+				"\t// VkDrawIndexedIndirectCommand: indexCount, instanceCount, firstIndex, vertexOffset, firstInstance\n"
+				"\tuint command = draws.values[i] * 5;\n"
+				"\tuint slot = atomicAdd(commands.values[command + 1], 1);\n"
+				"\tuint dst = (commands.values[command + 4] + slot) * 9;\n"
+				"\n"
+				"\tfor (uint v = 0; v < 9; v++)\n"
+				"\t\tvisible.values[dst + v] = instances.values[src + v];\n");
+		}
+
+		static constexpr ShaderDefinition Shader{ "frustum_cull", VK_SHADER_STAGE_COMPUTE_BIT, &DefineShader };
+
+	protected:
+		virtual void CreateShader() override {
+			shader = Shader.Create(device, shaders);
+		}
+
+		virtual void OnDestroyPipeline() override {}
+	};
+}
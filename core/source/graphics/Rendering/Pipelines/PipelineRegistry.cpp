@@ -0,0 +1,497 @@
+#include "PipelineRegistry.h"
+
+#include <algorithm>
+#include <cassert>
+#include <thread>
+
+PipelineRegistry::PipelineRegistry(VkDevice device, const VulkanAPI::DeviceFeatures& features)
+	: device{ device }
+	, libraries{ features.graphicsPipelineLibrary }
+{
+	VkPipelineCacheCreateInfo info
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.initialDataSize = 0,
+		.pInitialData = nullptr,
+	};
+
+	VK_CHECK(vkCreatePipelineCache(device, &info, nullptr, &cache));
+}
+
+PipelineRegistry::~PipelineRegistry()
+{
+	WaitIdle();
+
+	for (auto it = pipelines.begin(); it != pipelines.end(); ++it)
+		vkDestroyPipeline(device, it->second.pipeline, nullptr);
+
+	for (auto& part : parts)
+		for (auto it = part.begin(); it != part.end(); ++it)
+			vkDestroyPipeline(device, it->second, nullptr);
+
+	vkDestroyPipelineCache(device, cache, nullptr);
+}
+
+VkPipeline PipelineRegistry::Get(const PipelineStateDesc& desc)
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		auto found = pipelines.find(desc);
+		if (found != pipelines.end())
+		{
+			if (found->second.pipeline)
+				return found->second.pipeline;
+
+			// compiling in the background.
+			std::shared_ptr<Jobs::Counter> compile = found->second.compile;
+			lock.unlock();
+			return WaitFor(desc, *compile);
+		}
+	}
+
+	VkPipeline pipeline = Build(desc);
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	// another thread built the same description meanwhile, keep the first one.
+	auto result = pipelines.try_emplace(desc, Entry{ pipeline });
+	if (result.second)
+		return pipeline;
+
+	vkDestroyPipeline(device, pipeline, nullptr);
+
+	if (result.first->second.pipeline)
+		return result.first->second.pipeline;
+
+	// the first one is still compiling in the background.
+	std::shared_ptr<Jobs::Counter> compile = result.first->second.compile;
+	lock.unlock();
+	return WaitFor(desc, *compile);
+}
+
+VkPipeline PipelineRegistry::GetAsync(const PipelineStateDesc& desc)
+{
+	auto compile = std::make_shared<Jobs::Counter>();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto result = pipelines.try_emplace(desc, Entry{ .compile = compile });
+		if (!result.second)
+			return result.first->second.pipeline;
+	}
+
+	// the job keeps its own copy, the caller's description may be gone by the time it runs.
+	Jobs::Run([this, desc] {
+		VkPipeline pipeline = Build(desc);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		Entry& entry = pipelines.find(desc)->second;
+		entry.pipeline = pipeline;
+		entry.compile.reset();
+	}, compile.get());
+
+	// counts toward WaitIdle() until the compile finished, and keeps its counter alive until then.
+	Jobs::Run([compile] {}, &compiles, compile.get());
+
+	return VK_NULL_HANDLE;
+}
+
+VkPipeline PipelineRegistry::TryGet(const PipelineStateDesc& desc)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto found = pipelines.find(desc);
+	return found != pipelines.end() ? found->second.pipeline : VK_NULL_HANDLE;
+}
+
+void PipelineRegistry::WaitIdle()
+{
+	Jobs::Wait(compiles);
+}
+
+VkPipeline PipelineRegistry::WaitFor(const PipelineStateDesc& desc, Jobs::Counter& compile)
+{
+	// a worker waiting here keeps running jobs. the compile is queued right after
+	// its entry is added, until then the wait returns at once and is retried.
+	VkPipeline pipeline;
+	while (!(pipeline = TryGet(desc)))
+	{
+		Jobs::Wait(compile);
+		std::this_thread::yield();
+	}
+
+	return pipeline;
+}
+
+uint32_t PipelineRegistry::GetPipelineCount()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return (uint32_t)pipelines.size();
+}
+
+uint32_t PipelineRegistry::GetLibraryCount()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	uint32_t count = 0;
+	for (auto& part : parts)
+		count += (uint32_t)part.size();
+	return count;
+}
+
+bool PipelineRegistry::UsesLibraries()
+{
+	return libraries;
+}
+
+uint32_t PipelineRegistry::GetPendingCount()
+{
+	return compiles.pending.load(std::memory_order_acquire);
+}
+
+VkPipelineCache PipelineRegistry::GetCache()
+{
+	return cache;
+}
+
+namespace {
+	// the create info of a description. every state is filled in, library parts
+	// only read the ones their part covers. points into itself, never copied.
+	struct PipelineStates {
+		VkSpecializationInfo specialization[2];
+		VkPipelineShaderStageCreateInfo stages[2];
+		VkPipelineVertexInputStateCreateInfo VI;
+		VkPipelineInputAssemblyStateCreateInfo IA;
+		VkPipelineViewportStateCreateInfo VS;
+		VkPipelineRasterizationStateCreateInfo RS;
+		VkPipelineMultisampleStateCreateInfo MSS;
+		SmallVector<VkPipelineColorBlendAttachmentState, 4> blendAttachments;
+		VkPipelineColorBlendStateCreateInfo BLEND;
+		VkPipelineDynamicStateCreateInfo DS;
+		VkGraphicsPipelineCreateInfo info;
+
+		explicit PipelineStates(const PipelineStateDesc& desc);
+
+		PipelineStates(const PipelineStates&) = delete;
+		PipelineStates& operator=(const PipelineStates&) = delete;
+	};
+
+	PipelineStates::PipelineStates(const PipelineStateDesc& desc)
+	{
+		const ShaderSpecialization* constants[] = { &desc.vertexSpecialization, &desc.fragmentSpecialization };
+		for (uint32_t i = 0; i < 2; i++)
+		{
+			specialization[i] =
+			{
+				.mapEntryCount = (uint32_t)constants[i]->entries.size(),
+				.pMapEntries = constants[i]->entries.data(),
+				.dataSize = constants[i]->values.size() * sizeof(VkBool32),
+				.pData = constants[i]->values.data(),
+			};
+		}
+
+		stages[0] =
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.stage = VK_SHADER_STAGE_VERTEX_BIT,
+			.module = desc.vertex,
+			.pName = "main",
+			.pSpecializationInfo = desc.vertexSpecialization.entries.empty() ? nullptr : &specialization[0],
+		};
+
+		stages[1] =
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+			.module = desc.fragment,
+			.pName = "main",
+			.pSpecializationInfo = desc.fragmentSpecialization.entries.empty() ? nullptr : &specialization[1],
+		};
+
+		VI =
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.vertexBindingDescriptionCount = (uint32_t)desc.bindings.size(),
+			.pVertexBindingDescriptions = desc.bindings.data(),
+			.vertexAttributeDescriptionCount = (uint32_t)desc.attributes.size(),
+			.pVertexAttributeDescriptions = desc.attributes.data(),
+		};
+
+		IA =
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.topology = desc.raster.topology,
+			.primitiveRestartEnable = VK_FALSE,
+		};
+
+		// recorded with the internal resolution of the frame.
+		VS =
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.viewportCount = 1,
+			.pViewports = nullptr,
+			.scissorCount = 1,
+			.pScissors = nullptr,
+		};
+
+		RS =
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.depthClampEnable = VK_FALSE,
+			.rasterizerDiscardEnable = VK_FALSE,
+			.polygonMode = desc.polygonMode,
+			.cullMode = desc.raster.cullMode,
+			.frontFace = desc.raster.frontFace,
+			.depthBiasEnable = VK_FALSE,
+			.lineWidth = 1.0f,
+		};
+
+		MSS =
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.rasterizationSamples = desc.samples,
+			.sampleShadingEnable = VK_FALSE,
+			.minSampleShading = 0,
+			.pSampleMask = nullptr,
+			.alphaToCoverageEnable = VK_FALSE,
+			.alphaToOneEnable = VK_FALSE,
+		};
+
+		for (const BlendState& state : desc.blend)
+		{
+			blendAttachments.push_back({
+				.blendEnable = state.enable ? VK_TRUE : VK_FALSE,
+				.srcColorBlendFactor = state.srcColor,
+				.dstColorBlendFactor = state.dstColor,
+				.colorBlendOp = state.colorOp,
+				.srcAlphaBlendFactor = state.srcAlpha,
+				.dstAlphaBlendFactor = state.dstAlpha,
+				.alphaBlendOp = state.alphaOp,
+				.colorWriteMask = state.writeMask,
+			});
+		}
+
+		BLEND =
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.logicOpEnable = VK_FALSE,
+			.logicOp = VK_LOGIC_OP_COPY,
+			.attachmentCount = (uint32_t)blendAttachments.size(),
+			.pAttachments = blendAttachments.data(),
+		};
+
+		DS =
+		{
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.dynamicStateCount = (uint32_t)desc.dynamicStates.size(),
+			.pDynamicStates = desc.dynamicStates.data(),
+		};
+
+		info =
+		{
+			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.stageCount = _countof(stages),
+			.pStages = stages,
+			.pVertexInputState = &VI,
+			.pInputAssemblyState = &IA,
+			.pViewportState = &VS,
+			.pRasterizationState = &RS,
+			.pMultisampleState = &MSS,
+			.pColorBlendState = &BLEND,
+			.pDynamicState = &DS,
+			.layout = desc.layout,
+			.renderPass = desc.renderPass,
+			.subpass = desc.subpass,
+		};
+	}
+
+	// what one library part is built from, everything else back at its default so
+	// descriptions that only differ outside the part share it.
+	PipelineStateDesc Part(const PipelineStateDesc& desc, PipelineRegistry::LibraryPart part)
+	{
+		PipelineStateDesc result;
+		result.dynamicStates = desc.dynamicStates;
+
+		switch (part)
+		{
+		case PipelineRegistry::VertexInput:
+			result.bindings = desc.bindings;
+			result.attributes = desc.attributes;
+			result.raster.topology = desc.raster.topology;
+			return result;
+
+		case PipelineRegistry::PreRasterization:
+			result.vertex = desc.vertex;
+			result.vertexHash = desc.vertexHash;
+			result.vertexSpecialization = desc.vertexSpecialization;
+			result.raster.cullMode = desc.raster.cullMode;
+			result.raster.frontFace = desc.raster.frontFace;
+			result.polygonMode = desc.polygonMode;
+			break;
+
+		case PipelineRegistry::FragmentShader:
+			result.fragment = desc.fragment;
+			result.fragmentHash = desc.fragmentHash;
+			result.fragmentSpecialization = desc.fragmentSpecialization;
+			result.samples = desc.samples;
+			break;
+
+		case PipelineRegistry::FragmentOutput:
+			result.blend = desc.blend;
+			result.samples = desc.samples;
+			result.colorFormats = desc.colorFormats;
+			result.subpass = desc.subpass;
+			result.renderPass = desc.renderPass;
+			return result;
+		}
+
+		// the shader parts see the layout and the render pass.
+		result.colorFormats = desc.colorFormats;
+		result.subpass = desc.subpass;
+		result.renderPass = desc.renderPass;
+		result.descriptors = desc.descriptors;
+		result.pushConstants = desc.pushConstants;
+		result.layout = desc.layout;
+		return result;
+	}
+}
+
+VkPipeline PipelineRegistry::Build(const PipelineStateDesc& desc)
+{
+	assert(desc.blend.size() == desc.colorFormats.size() && "One Blend State Per Color Attachment.");
+
+	auto dynamic = [&](VkDynamicState state) {
+		return std::find(desc.dynamicStates.begin(), desc.dynamicStates.end(), state) != desc.dynamicStates.end();
+	};
+
+	assert(dynamic(VK_DYNAMIC_STATE_VIEWPORT) && dynamic(VK_DYNAMIC_STATE_SCISSOR) && "Viewport And Scissor Are Always Dynamic.");
+
+	if (libraries)
+		return Link(desc);
+
+	PipelineStates states(desc);
+
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VK_CHECK(vkCreateGraphicsPipelines(device, cache, 1, &states.info, nullptr, &pipeline));
+
+	return pipeline;
+}
+
+VkPipeline PipelineRegistry::Link(const PipelineStateDesc& desc)
+{
+	VkPipeline linked[LibraryPartCount];
+	for (uint32_t part = 0; part < LibraryPartCount; part++)
+		linked[part] = GetLibrary(desc, (LibraryPart)part);
+
+	VkPipelineLibraryCreateInfoKHR libraryInfo
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+		.pNext = nullptr,
+		.libraryCount = LibraryPartCount,
+		.pLibraries = linked,
+	};
+
+	// no link time optimization, the point is linking in microseconds.
+	// both shader parts were built against the same layout, it links as is.
+	VkGraphicsPipelineCreateInfo info
+	{
+		.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		.pNext = &libraryInfo,
+		.flags = 0,
+		.layout = desc.layout,
+	};
+
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VK_CHECK(vkCreateGraphicsPipelines(device, cache, 1, &info, nullptr, &pipeline));
+
+	return pipeline;
+}
+
+VkPipeline PipelineRegistry::GetLibrary(const PipelineStateDesc& desc, LibraryPart part)
+{
+	PipelineStateDesc key = Part(desc, part);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto found = parts[part].find(key);
+		if (found != parts[part].end())
+			return found->second;
+	}
+
+	VkPipeline library = BuildLibrary(key, part);
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// another compile built the same part meanwhile, keep the first one.
+	auto result = parts[part].try_emplace(key, library);
+	if (!result.second)
+		vkDestroyPipeline(device, library, nullptr);
+
+	return result.first->second;
+}
+
+VkPipeline PipelineRegistry::BuildLibrary(const PipelineStateDesc& part, LibraryPart kind)
+{
+	static constexpr VkGraphicsPipelineLibraryFlagsEXT Flags[LibraryPartCount] =
+	{
+		VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+		VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+		VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+		VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+	};
+
+	PipelineStates states(part);
+
+	VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo
+	{
+		.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+		.pNext = nullptr,
+		.flags = Flags[kind],
+	};
+
+	// states outside the part are ignored, only the stages have to be picked.
+	states.info.pNext = &libraryInfo;
+	states.info.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR;
+	states.info.stageCount = 0;
+
+	if (kind == PreRasterization)
+	{
+		states.info.stageCount = 1;
+		states.info.pStages = &states.stages[0];
+	}
+	else if (kind == FragmentShader)
+	{
+		states.info.stageCount = 1;
+		states.info.pStages = &states.stages[1];
+	}
+
+	VkPipeline library = VK_NULL_HANDLE;
+	VK_CHECK(vkCreateGraphicsPipelines(device, cache, 1, &states.info, nullptr, &library));
+
+	return library;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "PipelineState.h"
+
+#include <jobs/JobSystem.h>
+
+#include <memory>
+#include <mutex>
+
+// the one place graphics pipelines are built.
+//
+// Get() hands back the pipeline an equal description built before and only
+// compiles descriptions it has not seen, every build goes through one shared
+// VkPipelineCache. GetAsync() compiles on the job workers instead and returns
+// VK_NULL_HANDLE until the pipeline is ready, the frame never waits on it.
+// owns every pipeline it returns, they live until the registry is destroyed.
+//
+// with graphics pipeline libraries the four parts of a pipeline are built and
+// cached on their own and a new description only links them, variants that
+// share most of their state cost one fast link instead of a full compile.
+// without them every description is compiled as a whole.
+//
+// the shader modules and layout a description points at must stay alive
+// until its compile finished, WaitIdle() before destroying them.
+class PipelineRegistry {
+public:
+	enum LibraryPart : uint32_t {
+		VertexInput,
+		PreRasterization,
+		FragmentShader,
+		FragmentOutput,
+		LibraryPartCount,
+	};
+
+	PipelineRegistry(VkDevice device, const VulkanAPI::DeviceFeatures& features);
+	~PipelineRegistry();
+
+	PipelineRegistry(const PipelineRegistry&) = delete;
+	PipelineRegistry& operator=(const PipelineRegistry&) = delete;
+
+	// thread safe, the compile itself runs outside the lock. waits for a background compile of `desc`.
+	VkPipeline Get(const PipelineStateDesc& desc);
+	// queues a background compile the first time `desc` is seen, VK_NULL_HANDLE until it is done.
+	VkPipeline GetAsync(const PipelineStateDesc& desc);
+	// the pipeline when it is ready, never compiles.
+	VkPipeline TryGet(const PipelineStateDesc& desc);
+
+	// blocks until every background compile finished.
+	void WaitIdle();
+
+	uint32_t GetPipelineCount();
+	// parts built for linking, 0 without pipeline libraries.
+	uint32_t GetLibraryCount();
+	bool UsesLibraries();
+	uint32_t GetPendingCount();
+	VkPipelineCache GetCache();
+
+private:
+	struct Entry {
+		// VK_NULL_HANDLE while compiling.
+		VkPipeline pipeline = VK_NULL_HANDLE;
+		// set while compiling in the background, what Get() waits on.
+		std::shared_ptr<Jobs::Counter> compile;
+	};
+
+	// waits for the background compile of `desc` only.
+	VkPipeline WaitFor(const PipelineStateDesc& desc, Jobs::Counter& compile);
+	VkPipeline Build(const PipelineStateDesc& desc);
+	VkPipeline Link(const PipelineStateDesc& desc);
+	// the cached library of one part of `desc`, built on first use.
+	VkPipeline GetLibrary(const PipelineStateDesc& desc, LibraryPart part);
+	VkPipeline BuildLibrary(const PipelineStateDesc& part, LibraryPart kind);
+
+	std::mutex mutex;
+	VkDevice device;
+
+	VkPipelineCache cache = VK_NULL_HANDLE;
+	FlatHashMap<PipelineStateDesc, Entry, PipelineStateHash> pipelines;
+
+	// LIBRARIES
+	bool libraries = false;
+	// keyed by the part of the description each one is built from.
+	FlatHashMap<PipelineStateDesc, VkPipeline, PipelineStateHash> parts[LibraryPartCount];
+
+	// every background compile, each one is released once its entry's counter is.
+	Jobs::Counter compiles;
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "RenderPipelines.h"
+#include "ComputePipelines.h"
+
+namespace PipelineShaders {
+
+	// every shader the built in pipelines create, what the ShaderCooker builds.
+	// a new pipeline adds its definitions here.
+	inline const std::vector<ShaderDefinition>& GetDefinitions() {
+		static const std::vector<ShaderDefinition> definitions = {
+			RenderPipelines::Basic2D::VertexShader,
+			RenderPipelines::Basic2D::FragmentShader,
+			RenderPipelines::Instanced2D::VertexShader,
+			RenderPipelines::Instanced2D::FragmentShader,
+			ComputePipelines::FrustumCull::Shader,
+		};
+
+		return definitions;
+	}
+}
@@ -0,0 +1,135 @@
+#include "PipelineState.h"
+
+#include <algorithm>
+
+namespace {
+	// FNV-1a, folded one field at a time.
+	struct Hasher {
+		uint64_t value = 14695981039346656037ull;
+
+		void Add(uint64_t field) {
+			value ^= field;
+			value *= 1099511628211ull;
+		}
+	};
+}
+
+BlendState BlendState::Alpha()
+{
+	BlendState state;
+	state.enable = true;
+	state.srcColor = VK_BLEND_FACTOR_SRC_ALPHA;
+	state.dstColor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	return state;
+}
+
+void PipelineStateDesc::SetShaders(const ShaderGraph* vertexShader, const ShaderGraph* fragmentShader, ShaderVariant vertexVariant, ShaderVariant fragmentVariant)
+{
+	vertex = vertexShader->Get(vertexVariant);
+	vertexHash = vertexShader->GetHash(vertexVariant);
+	vertexSpecialization = vertexShader->GetSpecialization(vertexVariant);
+	fragment = fragmentShader->Get(fragmentVariant);
+	fragmentHash = fragmentShader->GetHash(fragmentVariant);
+	fragmentSpecialization = fragmentShader->GetSpecialization(fragmentVariant);
+
+	bindings = vertexShader->GetBindings();
+	attributes = vertexShader->GetAttributes();
+}
+
+bool PipelineStateDesc::operator==(const PipelineStateDesc& other) const
+{
+	auto sameBinding = [](const VkVertexInputBindingDescription& a, const VkVertexInputBindingDescription& b) {
+		return a.binding == b.binding && a.stride == b.stride && a.inputRate == b.inputRate;
+	};
+
+	auto sameAttribute = [](const VkVertexInputAttributeDescription& a, const VkVertexInputAttributeDescription& b) {
+		return a.location == b.location && a.binding == b.binding && a.format == b.format && a.offset == b.offset;
+	};
+
+	auto sameBlend = [](const BlendState& a, const BlendState& b) {
+		return a.enable == b.enable && a.srcColor == b.srcColor && a.dstColor == b.dstColor && a.colorOp == b.colorOp
+			&& a.srcAlpha == b.srcAlpha && a.dstAlpha == b.dstAlpha && a.alphaOp == b.alphaOp && a.writeMask == b.writeMask;
+	};
+
+	auto sameDescriptor = [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) {
+		return a.binding == b.binding && a.descriptorType == b.descriptorType && a.descriptorCount == b.descriptorCount && a.stageFlags == b.stageFlags;
+	};
+
+	return vertexHash == other.vertexHash && fragmentHash == other.fragmentHash
+		&& std::equal(bindings.begin(), bindings.end(), other.bindings.begin(), other.bindings.end(), sameBinding)
+		&& std::equal(attributes.begin(), attributes.end(), other.attributes.begin(), other.attributes.end(), sameAttribute)
+		&& raster.cullMode == other.raster.cullMode && raster.frontFace == other.raster.frontFace && raster.topology == other.raster.topology
+		&& polygonMode == other.polygonMode && samples == other.samples
+		&& std::equal(blend.begin(), blend.end(), other.blend.begin(), other.blend.end(), sameBlend)
+		&& std::equal(colorFormats.begin(), colorFormats.end(), other.colorFormats.begin(), other.colorFormats.end()) && subpass == other.subpass
+		&& std::equal(descriptors.begin(), descriptors.end(), other.descriptors.begin(), other.descriptors.end(), sameDescriptor)
+		&& pushConstants.stageFlags == other.pushConstants.stageFlags && pushConstants.offset == other.pushConstants.offset && pushConstants.size == other.pushConstants.size
+		&& std::equal(dynamicStates.begin(), dynamicStates.end(), other.dynamicStates.begin(), other.dynamicStates.end());
+}
+
+uint64_t PipelineStateDesc::Hash() const
+{
+	Hasher hash;
+
+	hash.Add(vertexHash);
+	hash.Add(fragmentHash);
+
+	for (const auto& binding : bindings)
+	{
+		hash.Add(binding.binding);
+		hash.Add(binding.stride);
+		hash.Add(binding.inputRate);
+	}
+
+	for (const auto& attribute : attributes)
+	{
+		hash.Add(attribute.location);
+		hash.Add(attribute.binding);
+		hash.Add(attribute.format);
+		hash.Add(attribute.offset);
+	}
+
+	hash.Add(raster.cullMode);
+	hash.Add(raster.frontFace);
+	hash.Add(raster.topology);
+	hash.Add(polygonMode);
+	hash.Add(samples);
+
+	for (const auto& state : blend)
+	{
+		hash.Add(state.enable);
+		hash.Add(state.srcColor);
+		hash.Add(state.dstColor);
+		hash.Add(state.colorOp);
+		hash.Add(state.srcAlpha);
+		hash.Add(state.dstAlpha);
+		hash.Add(state.alphaOp);
+		hash.Add(state.writeMask);
+	}
+
+	for (VkFormat format : colorFormats)
+		hash.Add(format);
+	hash.Add(subpass);
+
+	for (const auto& descriptor : descriptors)
+	{
+		hash.Add(descriptor.binding);
+		hash.Add(descriptor.descriptorType);
+		hash.Add(descriptor.descriptorCount);
+		hash.Add(descriptor.stageFlags);
+	}
+
+	hash.Add(pushConstants.stageFlags);
+	hash.Add(pushConstants.offset);
+	hash.Add(pushConstants.size);
+
+	for (VkDynamicState state : dynamicStates)
+		hash.Add(state);
+
+	return hash.value;
+}
+
+size_t PipelineStateHash::operator()(const PipelineStateDesc& desc) const
+{
+	return (size_t)desc.Hash();
+}
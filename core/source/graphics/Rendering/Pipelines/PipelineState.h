@@ -0,0 +1,76 @@
+#pragma once
+
+#include "RenderPipeline.h"
+
+#include <graphics/Rendering/Shaders/ShaderGraph.h>
+
+// color blending of one attachment.
+struct BlendState {
+	bool enable = false;
+
+	VkBlendFactor srcColor = VK_BLEND_FACTOR_ONE;
+	VkBlendFactor dstColor = VK_BLEND_FACTOR_ZERO;
+	VkBlendOp colorOp = VK_BLEND_OP_ADD;
+
+	VkBlendFactor srcAlpha = VK_BLEND_FACTOR_ONE;
+	VkBlendFactor dstAlpha = VK_BLEND_FACTOR_ZERO;
+	VkBlendOp alphaOp = VK_BLEND_OP_ADD;
+
+	VkColorComponentFlags writeMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+	// straight alpha over whatever is already in the attachment.
+	static BlendState Alpha();
+};
+
+// everything a graphics pipeline is built from.
+//
+// two equal descriptions build interchangeable pipelines. the hash only
+// covers content, shaders by their SPIR-V and the layout by its bindings, so
+// it is the same from run to run. handles that only have to be compatible
+// (render pass, pipeline layout) are carried along to build with but are not
+// compared.
+struct PipelineStateDesc {
+	// SHADERS
+	VkShaderModule vertex = VK_NULL_HANDLE;
+	VkShaderModule fragment = VK_NULL_HANDLE;
+	// cover the specialization too.
+	uint64_t vertexHash = 0;
+	uint64_t fragmentHash = 0;
+	ShaderSpecialization vertexSpecialization;
+	ShaderSpecialization fragmentSpecialization;
+
+	// VERTEX LAYOUT
+	VertexBindingList bindings;
+	VertexAttributeList attributes;
+
+	// RASTER
+	RasterState raster;
+	VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+	VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+
+	// BLEND, one per color attachment.
+	SmallVector<BlendState, 4> blend;
+
+	// RENDER PASS
+	// passes with the same attachment formats and samples are compatible.
+	SmallVector<VkFormat, 4> colorFormats;
+	uint32_t subpass = 0;
+	VkRenderPass renderPass = VK_NULL_HANDLE;
+
+	// LAYOUT
+	DescriptorBindingList descriptors;
+	VkPushConstantRange pushConstants{ 0, 0, 0 };
+	VkPipelineLayout layout = VK_NULL_HANDLE;
+
+	SmallVector<VkDynamicState, 8> dynamicStates;
+
+	// modules, SPIR-V hashes, specialization and the vertex layout of the two stages, in the given variants.
+	void SetShaders(const ShaderGraph* vertexShader, const ShaderGraph* fragmentShader, ShaderVariant vertexVariant = 0, ShaderVariant fragmentVariant = 0);
+
+	bool operator==(const PipelineStateDesc& other) const;
+	uint64_t Hash() const;
+};
+
+struct PipelineStateHash {
+	size_t operator()(const PipelineStateDesc& desc) const;
+};
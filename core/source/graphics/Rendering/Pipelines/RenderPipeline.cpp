@@ -1,5 +1,15 @@
 #include "RenderPipeline.h"
 
+#include "graphics/Rendering/Shaders/ShaderGraph.h"
+#include "graphics/Descriptors/DescriptorLayoutCache.h"
+#include "PipelineState.h"
+#include "PipelineRegistry.h"
+
+#include <algorithm>
+#include <cassert>
+
+
+RenderPipeline::~RenderPipeline() = default;
 
 void RenderPipeline::Initillize(uint32_t width, uint32_t height)
 {
@@ -11,19 +21,73 @@ void RenderPipeline::Initillize(uint32_t width, uint32_t height)
 
 void RenderPipeline::Cleanup()
 {
+	// a compile still running reads the shader modules and the layout.
+	if (requested)
+		registry->WaitIdle();
+
 	OnDestroyPipeline();
 
 	vkDestroyRenderPass(device, renderPass, nullptr);
 
+	// the pipeline stays with the registry.
 	vkDestroyPipelineLayout(device, layout, nullptr);
-	vkDestroyPipeline(device, pipeline, nullptr);
 
 
 }
 
 VkPipeline RenderPipeline::Get()
 {
-	return this->pipeline;
+	VkPipeline ready = pipeline.load(std::memory_order_acquire);
+	if (ready)
+		return ready;
+
+	if (requested)
+	{
+		ready = registry->TryGet(*requested);
+		if (ready)
+		{
+			pipeline.store(ready, std::memory_order_release);
+			return ready;
+		}
+	}
+
+	return fallback ? fallback->Get() : VK_NULL_HANDLE;
+}
+
+bool RenderPipeline::IsReady()
+{
+	// polls the registry.
+	Get();
+	return pipeline.load(std::memory_order_acquire) != VK_NULL_HANDLE;
+}
+
+void RenderPipeline::CompileAsync(RenderPipeline* fallback)
+{
+	assert(fallback != this && "A Pipeline Can Not Fall Back To Itself.");
+
+	this->async = true;
+	this->fallback = fallback;
+}
+
+VkPipelineLayout RenderPipeline::GetLayout()
+{
+	return layout;
+}
+
+VkDescriptorSetLayout RenderPipeline::GetSetLayout()
+{
+	return setLayout;
+}
+
+void RenderPipeline::BindDescriptorSet(VkCommandBuffer cmd, VkDescriptorSet set, uint32_t dynamicOffsetCount, const uint32_t* dynamicOffsets)
+{
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &set, dynamicOffsetCount, dynamicOffsets);
+}
+
+void RenderPipeline::PushConstants(VkCommandBuffer cmd, const void* data, uint32_t size, uint32_t offset)
+{
+	assert(offset + size <= pushConstants.size && "Push Constants Out Of Range.");
+	vkCmdPushConstants(cmd, layout, pushConstants.stageFlags, offset, size, data);
 }
 
 void RenderPipeline::LinkDevice(VkDevice dev)
@@ -31,12 +95,162 @@ void RenderPipeline::LinkDevice(VkDevice dev)
 	this->device = dev;
 }
 
+void RenderPipeline::LinkLayoutCache(DescriptorLayoutCache* cache)
+{
+	this->layouts = cache;
+}
+
+void RenderPipeline::CreateLayout(std::initializer_list<const ShaderGraph*> shaders)
+{
+	// a binding declared by several stages is one binding visible to all of them.
+	DescriptorBindingList bindings;
+
+	for (const ShaderGraph* shader : shaders)
+	{
+		for (const auto& binding : shader->GetDescriptorBindings())
+		{
+			auto found = std::find_if(bindings.begin(), bindings.end(), [&](const VkDescriptorSetLayoutBinding& b) { return b.binding == binding.binding; });
+			if (found == bindings.end())
+				bindings.push_back(binding);
+			else
+				found->stageFlags |= binding.stageFlags;
+		}
+	}
+
+	if (!bindings.empty())
+		setLayout = layouts->Get(bindings);
+
+	descriptorBindings = bindings;
+
+	// the stages share one block, each range must name a stage only once.
+	for (const ShaderGraph* shader : shaders)
+	{
+		uint32_t size = shader->GetPushConstantSize();
+		if (size == 0)
+			continue;
+
+		pushConstants.stageFlags |= shader->GetStage();
+		pushConstants.size = std::max(pushConstants.size, size);
+	}
+
+	VkPipelineLayoutCreateInfo layoutCreateInfo
+	{
+		.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		.pNext = nullptr,
+		.flags = 0,
+		.setLayoutCount = setLayout != VK_NULL_HANDLE ? 1u : 0u,
+		.pSetLayouts = &setLayout,
+		.pushConstantRangeCount = pushConstants.size > 0 ? 1u : 0u,
+		.pPushConstantRanges = &pushConstants,
+	};
+
+	VK_CHECK(vkCreatePipelineLayout(device, &layoutCreateInfo, nullptr, &layout));
+}
+
 const Resolution RenderPipeline::GetInternalRenderResolution()
 {
 	return InternalResolution;
 }
 
+void RenderPipeline::LinkRegistry(PipelineRegistry* pipelineRegistry)
+{
+	this->registry = pipelineRegistry;
+}
+
+void RenderPipeline::LinkShaderCache(ShaderCache* shaders)
+{
+	this->shaders = shaders;
+}
+
+void RenderPipeline::LinkFeatures(const VulkanAPI::DeviceFeatures& features)
+{
+	this->extendedDynamicState = features.extendedDynamicState;
+}
+
+void RenderPipeline::SetInternalRenderResolution(Resolution resolution)
+{
+	InternalResolution = resolution;
+}
+
+void RenderPipeline::SetViewport(VkCommandBuffer cmd)
+{
+	VkViewport viewport
+	{
+		.x = 0, .y = 0, .width = static_cast<float>(InternalResolution.width), .height = static_cast<float>(InternalResolution.height), .minDepth = 0, .maxDepth = 1
+	};
+
+	VkRect2D scissor
+	{
+		.offset = { 0, 0 },
+		.extent = { InternalResolution.width, InternalResolution.height }
+	};
+
+	vkCmdSetViewport(cmd, 0, 1, &viewport);
+	vkCmdSetScissor(cmd, 0, 1, &scissor);
+}
+
+void RenderPipeline::BindRasterState(VkCommandBuffer cmd)
+{
+	if (!extendedDynamicState)
+		return;
+
+	vkCmdSetCullMode(cmd, raster.cullMode);
+	vkCmdSetFrontFace(cmd, raster.frontFace);
+	vkCmdSetPrimitiveTopology(cmd, raster.topology);
+}
+
+std::vector<VkDynamicState> RenderPipeline::GetDynamicStates()
+{
+	std::vector<VkDynamicState> states
+	{
+		VK_DYNAMIC_STATE_VIEWPORT,
+		VK_DYNAMIC_STATE_SCISSOR,
+	};
+
+	if (extendedDynamicState)
+	{
+		states.push_back(VK_DYNAMIC_STATE_CULL_MODE);
+		states.push_back(VK_DYNAMIC_STATE_FRONT_FACE);
+		states.push_back(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY);
+	}
+
+	return states;
+}
+
 const VkRenderPass RenderPipeline::GetRenderPass()
 {
 	return renderPass;
 }
+
+PipelineStateDesc& RenderPipeline::Describe(PipelineStateDesc& desc)
+{
+	desc.raster = raster;
+
+	desc.renderPass = renderPass;
+	desc.subpass = 0;
+
+	desc.descriptors = descriptorBindings;
+	desc.pushConstants = pushConstants;
+	desc.layout = layout;
+
+	desc.dynamicStates.clear();
+	for (VkDynamicState state : GetDynamicStates())
+		desc.dynamicStates.push_back(state);
+
+	return desc;
+}
+
+void RenderPipeline::Compile(PipelineStateDesc& desc)
+{
+	Describe(desc);
+
+	if (!async)
+	{
+		pipeline = registry->Get(desc);
+		return;
+	}
+
+	// an equal pipeline that is already built comes back right away.
+	requested = std::make_unique<PipelineStateDesc>(desc);
+	pipeline = registry->GetAsync(desc);
+}
@@ -3,21 +3,67 @@
 #include "pch.h"
 
 #include <graphics/gfx_pch.h>
+#include <datastructures/SlotMap.h>
+
+#include <atomic>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+class RenderPipeline;
+class ShaderGraph;
+class DescriptorLayoutCache;
+class PipelineRegistry;
+class ShaderCache;
+struct PipelineStateDesc;
+
+using PipelineHandle = Handle32<RenderPipeline>;
+using PipelineTable = SlotMap<std::unique_ptr<RenderPipeline>, PipelineHandle>;
+
+// rasterizer state baked into the pipeline, or recorded by BindRasterState() on devices with extended dynamic state.
+struct RasterState {
+	VkCullModeFlags cullMode = VK_CULL_MODE_NONE;
+	VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+	VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+};
 
 class RenderPipeline {
 
 public:
 	RenderPipeline() = default;
-	virtual ~RenderPipeline() = default;
+	virtual ~RenderPipeline();
 
 	void Initillize(uint32_t width, uint32_t height);
 	void Cleanup();
 	void LinkDevice(VkDevice device);
+	void LinkLayoutCache(DescriptorLayoutCache* layouts);
+	void LinkRegistry(PipelineRegistry* registry);
+	void LinkShaderCache(ShaderCache* shaders);
+	void LinkFeatures(const VulkanAPI::DeviceFeatures& features);
+	// before Initillize(), the pipeline compiles in the background and Get() hands out `fallback` until it is done.
+	// the fallback has to take the same vertex inputs, descriptors and push constants. without one, nothing is drawn meanwhile.
+	void CompileAsync(RenderPipeline* fallback = nullptr);
 
 	const Resolution GetInternalRenderResolution();
+	// viewport and scissor are dynamic, a new resolution only changes what SetViewport() records.
+	void SetInternalRenderResolution(Resolution resolution);
+	// secondary buffers do not inherit dynamic state, each one records it before drawing.
+	void SetViewport(VkCommandBuffer cmd);
+	// after binding the pipeline, does nothing when the raster state is baked in.
+	void BindRasterState(VkCommandBuffer cmd);
 	const VkRenderPass GetRenderPass();
 
+	// VK_NULL_HANDLE while compiling without a ready fallback, the draw is skipped then.
 	VkPipeline Get();
+	bool IsReady();
+	VkPipelineLayout GetLayout();
+	// set 0, what per draw sets are allocated with.
+	VkDescriptorSetLayout GetSetLayout();
+
+	// binds `set` as set 0, one dynamic offset per dynamic binding in binding order.
+	void BindDescriptorSet(VkCommandBuffer cmd, VkDescriptorSet set, uint32_t dynamicOffsetCount = 0, const uint32_t* dynamicOffsets = nullptr);
+	// writes into the push constant block every stage that declares one sees.
+	void PushConstants(VkCommandBuffer cmd, const void* data, uint32_t size, uint32_t offset = 0);
 
 protected: /* INTERFACE */
 	virtual void CreateRenderPass() = 0;
@@ -25,15 +71,42 @@ protected: /* INTERFACE */
 
 	virtual void OnDestroyPipeline() = 0;
 
+	// viewport and scissor, plus the raster state with extended dynamic state.
+	std::vector<VkDynamicState> GetDynamicStates();
+
+	// builds `layout` from the descriptors and push constants every stage declares, set 0 holds them all.
+	void CreateLayout(std::initializer_list<const ShaderGraph*> shaders);
+	// fills in what the base class owns: layout, raster and dynamic state, render pass.
+	PipelineStateDesc& Describe(PipelineStateDesc& desc);
+	// describes and builds `pipeline` through the registry, in the background after CompileAsync().
+	void Compile(PipelineStateDesc& desc);
+
 protected:
 	VkDevice device;
+	DescriptorLayoutCache* layouts = nullptr;
+	PipelineRegistry* registry = nullptr;
+	// handed to every ShaderGraph the pipeline creates.
+	ShaderCache* shaders = nullptr;
 	Resolution InternalResolution;
 
+	RasterState raster;
+	bool extendedDynamicState = false;
+
 	VkRenderPass renderPass;
 
-	VkPipeline pipeline;
+	// owned by the registry, possibly shared with other pipelines. VK_NULL_HANDLE while compiling.
+	std::atomic<VkPipeline> pipeline{ VK_NULL_HANDLE };
+	// ASYNC
+	bool async = false;
+	RenderPipeline* fallback = nullptr;
+	// what Get() polls the registry with until the pipeline is ready.
+	std::unique_ptr<PipelineStateDesc> requested;
+
 	VkPipelineLayout layout;
-	VkPipelineCache cache;
+	// owned by the layout cache, VK_NULL_HANDLE when no stage declares descriptors.
+	VkDescriptorSetLayout setLayout = VK_NULL_HANDLE;
+	DescriptorBindingList descriptorBindings;
+	VkPushConstantRange pushConstants{ 0, 0, 0 };
 
 
 };
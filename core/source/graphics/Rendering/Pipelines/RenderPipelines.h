@@ -3,6 +3,7 @@
 
 #include "Graphics/Rendering/Utils/RenderPipelineFactory.h"
 #include "Graphics/Rendering/Shaders/ShaderGraph.h"
+#include "graphics/Rendering/Pipelines/PipelineRegistry.h"
 
 #include <filesystem>
 #include <debug/Console.h>
@@ -18,44 +19,71 @@ namespace RenderPipelines {
 		}Color;
 	};
 
+	// per instance data of Instanced2D, a unit quad is scaled, rotated and moved by it.
+	struct Instance {
+		struct {
+			float x, y = 0;
+		}Offset;
+		struct {
+			float x, y = 0;
+		}Scale;
+		float Rotation = 0;
+		struct {
+			float r, g, b, a = 0;
+		}Color;
+	};
+
 	class Basic2D : public RenderPipeline {
 
-		ShaderGraph* vertex;
-		ShaderGraph* fragment;
+	public:
+		static constexpr VkFormat ColorFormat = VK_FORMAT_B8G8R8A8_UNORM;
 
-		void CreateShaders() {
+		// binding 0, one per draw out of the UniformRing, bound at its dynamic offset. std140.
+		struct DrawData {
+			float offset[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			float tint[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		};
 
-			// Crate Shader Module and Compile to SPIR-V From File
-			auto baseDir = std::filesystem::current_path() / "Shaders";
-			auto vertexFilepath = baseDir / "vertex.hlsl";
+		// what the shaders compute. pipelines create them from these at runtime, the shader cooker ahead of time.
+		static void DefineVertex(ShaderGraph& vertex) {
+			vertex.AddInput(0, ShaderVarType::_VEC3_, "Position", 0);
+			vertex.AddInput(1, ShaderVarType::_VEC4_, "Color", 0);
 
-			// describe what will happen in the vertex stage..
-			vertex = new ShaderGraph(device, vertexFilepath.generic_string(), VK_SHADER_STAGE_VERTEX_BIT);
-			vertex->AddInput(0, ShaderVarType::_VEC3_, "Position", 0);
-			vertex->AddInput(1, ShaderVarType::_VEC3_, "Color", 0);
+			vertex.AddUniform(0, "draw", "\tvec4 offset;\n\tvec4 tint;\n");
 
-			vertex->AddOutput(0, ShaderVarType::_VEC4_, "FragColor");
+			vertex.AddOutput(0, ShaderVarType::_VEC4_, "FragColor");
 
-			vertex->AddMain("\tgl_Position = vec4(Position, 1.0);\n\tFragColor = vec4(Color, 1.0);\n");
+			vertex.AddMain("\tgl_Position = vec4(Position + draw.offset.xyz, 1.0);\n\tFragColor = Color * draw.tint;\n");
+		}
 
-			if (!vertex->Compile())
-			{
-				Console::Warn("Shader Compilation Failed: ", vertexFilepath);
-			}
+		static void DefineFragment(ShaderGraph& fragment) {
+			fragment.AddInput(0, ShaderVarType::_VEC4_, "FragColor", 0);
+			fragment.AddOutput(0, ShaderVarType::_VEC4_, "OutputColor");
 
-			auto fragmentFilepath = baseDir / "fragment.hlsl";
+			fragment.AddSwitch("OPAQUE", ShaderSwitchMode::Define);
 
-			fragment = new ShaderGraph(device, fragmentFilepath.generic_string(), VK_SHADER_STAGE_FRAGMENT_BIT);
-			fragment->AddInput(0, ShaderVarType::_VEC4_, "FragColor", 0);
-			fragment->AddOutput(0, ShaderVarType::_VEC4_, "OutputColor");
+			fragment.AddMain(
+				"#if OPAQUE\n"
+				"\tOutputColor = vec4(FragColor.rgb, 1.0);\n"
+				"#else\n"
+				"\tOutputColor = FragColor;\n"
+				"#endif\n");
+		}
 
-			fragment->AddMain("\tOutputColor = FragColor;\n");
+		// fragment variant that writes alpha 1, the switch DefineFragment adds.
+		static constexpr ShaderVariant Opaque = 1 << 0;
 
-			if (!fragment->Compile())
-			{
-				Console::Warn("Shader Compilation Failed: ", &fragment);
-			}
+		static constexpr ShaderDefinition VertexShader{ "vertex", VK_SHADER_STAGE_VERTEX_BIT, &DefineVertex };
+		static constexpr ShaderDefinition FragmentShader{ "fragment", VK_SHADER_STAGE_FRAGMENT_BIT, &DefineFragment };
+
+	protected:
+		ShaderGraph* vertex;
+		ShaderGraph* fragment;
+		// of the fragment shader, 0 blends by the vertex alpha.
+		ShaderVariant fragmentVariant = 0;
 
+		virtual void CreateShaders() {
+			ShaderDefinition::CreateAll(device, shaders, { { VertexShader, vertex }, { FragmentShader, fragment } });
 		}
 
 		virtual void CreateRenderPass() override {
@@ -63,14 +91,14 @@ namespace RenderPipelines {
 			{
 				// Pass 0
 				{
-					.format = VK_FORMAT_B8G8R8A8_UNORM,
+					.format = ColorFormat,
 					.samples = VK_SAMPLE_COUNT_1_BIT,
 					.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
 					.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
 					.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 					.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
 					.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-					.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+					.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
 				}
 			};
 
@@ -111,182 +139,56 @@ namespace RenderPipelines {
 
 		virtual void CreatePipeline() override
 		{
-			VkPipelineRasterizationStateCreateInfo RS{
-			.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-			.pNext = 0,
-			.flags = 0,
-			.depthClampEnable = VK_FALSE,
-			.rasterizerDiscardEnable = VK_TRUE,
-			.polygonMode = VK_POLYGON_MODE_FILL,
-			.cullMode = VK_CULL_MODE_BACK_BIT,
-			.frontFace = VK_FRONT_FACE_CLOCKWISE,
-			.depthBiasEnable = VK_FALSE,
-			.lineWidth = 1.0f
-			};
-
-			// Describe Shader Stages
-
-			std::vector<VkVertexInputBindingDescription> bindings{
-				{.binding = 0, .stride = sizeof(Vertex), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX }
-			};
-
 			CreateShaders();
+			CreateLayout({ vertex, fragment });
 
-			std::vector<VkPipelineShaderStageCreateInfo> stages =
-			{
-				{
-					.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-					.pNext = nullptr,
-					.flags = 0,
-					.stage = VK_SHADER_STAGE_VERTEX_BIT,
-					.module = vertex->Get(),
-					.pName = "main",
-
-				},
-				{
-					.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-					.pNext = nullptr,
-					.flags = 0,
-					.stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-					.module = fragment->Get(),
-					.pName = "main"
-				}
-			};
-
-
-			auto attribs = vertex->GetAttributes();
-
-
-
-			VkPipelineVertexInputStateCreateInfo VI{
-				.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-				.pNext = nullptr,
-				.flags = 0,
-
-				.vertexBindingDescriptionCount = (uint32_t)bindings.size(),
-				.pVertexBindingDescriptions = bindings.data(),
-				.vertexAttributeDescriptionCount = (uint32_t)attribs.size(),
-				.pVertexAttributeDescriptions = attribs.data()
-			};
-
-
-			VkPipelineLayoutCreateInfo layoutCreateInfo{
-				.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-				.pNext = nullptr,
-				.flags = 0,
-			};
-
-			VK_CHECK(vkCreatePipelineLayout(device, &layoutCreateInfo, nullptr, &layout));
-
-
-			VkPipelineInputAssemblyStateCreateInfo IA
-			{
-				.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-				.pNext = nullptr,
-				.flags = 0,
-				.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-				.primitiveRestartEnable = VK_FALSE,
-			};
-
-			std::vector<VkViewport> viewports
-			{
-				{
-					.x = 0, .y = 0, .width = static_cast<float>(InternalResolution.width), .height = static_cast<float>(InternalResolution.height), .minDepth = 0, .maxDepth = 1
-				}
-			};
-
-			std::vector<VkRect2D> scissors
-			{
-				{
-					.offset = { 0, 0 },
-					.extent = { InternalResolution.width, InternalResolution.height }
-				}
-			};
-
-			VkPipelineViewportStateCreateInfo VS
-			{
-				.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
-				.pNext = nullptr,
-				.flags = 0,
-				.viewportCount = (uint32_t)viewports.size(),
-				.pViewports = viewports.data(),
-				.scissorCount = (uint32_t)scissors.size(),
-				.pScissors = scissors.data()
-			};
-
-
-			VkPipelineMultisampleStateCreateInfo MSS
-			{
-				.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-				.pNext = nullptr,
-				.flags = 0,
-				.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
-				.sampleShadingEnable = VK_FALSE,
-				.minSampleShading = 0,
-				.pSampleMask = nullptr,
-				.alphaToCoverageEnable = VK_FALSE,
-				.alphaToOneEnable = VK_FALSE,
-			};
-
-
-			std::vector<VkPipelineColorBlendAttachmentState> blendAttachments
-			{
-				{
-					.blendEnable = VK_TRUE,
-
-					.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA,
-					.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
-					.colorBlendOp = VK_BLEND_OP_ADD,
+			// per vertex and per instance bindings follow the vertex shader's inputs.
+			PipelineStateDesc desc;
+			desc.SetShaders(vertex, fragment, 0, fragmentVariant);
+			desc.blend.push_back(BlendState::Alpha());
+			desc.colorFormats.push_back(ColorFormat);
 
-					.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
-					.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
-					.alphaBlendOp = VK_BLEND_OP_ADD,
-
-					.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
-				}
-			};
-
-			VkPipelineColorBlendStateCreateInfo BLEND
-			{
-				.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-				.pNext = nullptr,
-				.flags = 0,
+			// an equal pipeline built before is handed back instead of compiled again.
+			Compile(desc);
+		}
 
-				.logicOpEnable = VK_FALSE,
-				.logicOp = VK_LOGIC_OP_COPY,
+		virtual void OnDestroyPipeline() override {
+			
+			delete vertex;
+			delete fragment;
 
-				.attachmentCount = (uint32_t)blendAttachments.size(),
-				.pAttachments = blendAttachments.data(),
+		};
+	};
 
-			};
+	// Basic2D drawn instanced: binding 0 is a unit quad (Position only),
+	// binding 1 holds one Instance per quad.
+	class Instanced2D : public Basic2D {
 
+	public:
+		static void DefineVertex(ShaderGraph& vertex) {
+			vertex.AddInput(0, ShaderVarType::_VEC3_, "Position", 0);
 
+			vertex.AddInstanceInput(1, ShaderVarType::_VEC2_, "InstanceOffset", 1);
+			vertex.AddInstanceInput(2, ShaderVarType::_VEC2_, "InstanceScale", 1);
+			vertex.AddInstanceInput(3, ShaderVarType::_FLOAT_, "InstanceRotation", 1);
+			vertex.AddInstanceInput(4, ShaderVarType::_VEC4_, "InstanceColor", 1);
 
-			VkGraphicsPipelineCreateInfo info{
-				.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-				.pNext = nullptr,
-				.flags = 0,
-				.stageCount = (uint32_t)stages.size(),
-				.pStages = stages.data(),
-				.pVertexInputState = &VI,
-				.pInputAssemblyState = &IA,
-				.pViewportState = &VS,
-				.pRasterizationState = &RS,
-				.pMultisampleState = &MSS,
-				.pColorBlendState = &BLEND,
-				.layout = layout,
-				.renderPass = renderPass,
-				.subpass = 0
-			};
+			vertex.AddOutput(0, ShaderVarType::_VEC4_, "FragColor");
 
-			VK_CHECK(vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &info, nullptr, &pipeline));
+			vertex.AddMain(
+				"\tvec2 p = Position.xy * InstanceScale;\n"
+				"\tfloat c = cos(InstanceRotation);\n"
+				"\tfloat s = sin(InstanceRotation);\n"
+				"\tgl_Position = vec4(InstanceOffset + vec2(p.x * c - p.y * s, p.x * s + p.y * c), Position.z, 1.0);\n"
+				"\tFragColor = InstanceColor;\n");
 		}
 
-		virtual void OnDestroyPipeline() override {
-			
-			delete vertex;
-			delete fragment;
+		static constexpr ShaderDefinition VertexShader{ "instanced_vertex", VK_SHADER_STAGE_VERTEX_BIT, &DefineVertex };
+		static constexpr ShaderDefinition FragmentShader{ "instanced_fragment", VK_SHADER_STAGE_FRAGMENT_BIT, &Basic2D::DefineFragment };
 
-		};
+	protected:
+		virtual void CreateShaders() override {
+			ShaderDefinition::CreateAll(device, shaders, { { VertexShader, vertex }, { FragmentShader, fragment } });
+		}
 	};
 }
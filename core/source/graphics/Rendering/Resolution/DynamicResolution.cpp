@@ -0,0 +1,83 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+DynamicResolution::DynamicResolution()
+	: DynamicResolution(Settings{})
+{
+}
+
+DynamicResolution::DynamicResolution(const Settings& settings)
+	: settings{ settings }, scale{ settings.maxScale }
+{
+}
+
+void DynamicResolution::SetSettings(const Settings& newSettings)
+{
+	settings = newSettings;
+	scale = std::clamp(scale, settings.minScale, settings.maxScale);
+	average = -1.0;
+}
+
+const DynamicResolution::Settings& DynamicResolution::GetSettings()
+{
+	return settings;
+}
+
+bool DynamicResolution::Update(double ms)
+{
+	if (ms <= 0.0)
+		return false;
+
+	if (settle > 0)
+	{
+		settle--;
+		return false;
+	}
+
+	average = average < 0.0 ? ms : average + (ms - average) * settings.smoothing;
+
+	double low = settings.budget * (1.0 - settings.headroom);
+	double high = settings.budget * (1.0 + settings.headroom);
+
+	if (average >= low && average <= high)
+		return false;
+
+	float target = std::clamp((float)(scale * std::sqrt(settings.budget / average)), settings.minScale, settings.maxScale);
+
+	// pinned at a bound, or a step too small to show up after rounding.
+	if (std::abs(target - scale) < 0.01f)
+		return false;
+
+	scale = target;
+
+	// the next samples were still rendered at the old scale.
+	settle = settings.settleFrames;
+	average = -1.0;
+
+	return true;
+}
+
+Resolution DynamicResolution::Apply(Resolution output)
+{
+	uint32_t align = std::max(1u, settings.alignment);
+
+	auto axis = [&](uint32_t size) {
+		uint32_t scaled = (uint32_t)((float)size * scale);
+		scaled -= scaled % align;
+		return std::clamp(scaled, std::min(align, size), size);
+	};
+
+	return { axis(output.width), axis(output.height) };
+}
+
+float DynamicResolution::GetScale()
+{
+	return scale;
+}
+
+double DynamicResolution::GetAverage()
+{
+	return average;
+}
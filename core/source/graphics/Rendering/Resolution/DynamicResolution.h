@@ -0,0 +1,51 @@
+#pragma once
+
+#include <graphics/gfx_pch.h>
+
+// picks the internal render resolution from the measured gpu frame time.
+//
+// the frame time is smoothed, once it leaves the band around the budget the
+// scale moves towards the one that would have hit it. gpu time is taken to
+// grow with the pixel count, so the scale changes with the square root of the
+// ratio. samples still rendered at the old scale are skipped after a change.
+class DynamicResolution {
+public:
+	struct Settings {
+		// gpu time the frame has to fit in, in milliseconds.
+		double budget = 1000.0 / 60.0;
+		// per axis, relative to the output resolution.
+		float minScale = 0.5f;
+		float maxScale = 1.0f;
+		// fraction of the budget the average may drift before the scale moves.
+		float headroom = 0.1f;
+		// weight of a new sample in the running average.
+		float smoothing = 0.2f;
+		// frames ignored after a change, they were recorded before it.
+		uint32_t settleFrames = 4;
+		// internal width and height are rounded down to a multiple of this.
+		uint32_t alignment = 8;
+	};
+
+	DynamicResolution();
+	explicit DynamicResolution(const Settings& settings);
+
+	void SetSettings(const Settings& settings);
+	const Settings& GetSettings();
+
+	// feeds the gpu time of one frame, returns true when the scale changed.
+	bool Update(double gpuMilliseconds);
+
+	// `output` scaled by the current scale, never larger than `output` and never empty.
+	Resolution Apply(Resolution output);
+
+	float GetScale();
+	// smoothed frame time, negative before the first sample.
+	double GetAverage();
+
+private:
+	Settings settings;
+
+	float scale;
+	double average = -1.0;
+	uint32_t settle = 0;
+};
@@ -0,0 +1,626 @@
+#include "CodeGraph.h"
+
+#include <debug/Console.h>
+
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+namespace {
+	// components of a scalar or vector, 0 for matrices.
+	uint32_t Components(ShaderVarType type)
+	{
+		switch (type)
+		{
+		case ShaderVarType::_BOOL_:
+		case ShaderVarType::_INT_:
+		case ShaderVarType::_UINT_:
+		case ShaderVarType::_FLOAT_:
+		case ShaderVarType::_DOUBLE_:
+			return 1;
+		case ShaderVarType::_BVEC2_:
+		case ShaderVarType::_IVEC2_:
+		case ShaderVarType::_DVEC2_:
+		case ShaderVarType::_VEC2_:
+			return 2;
+		case ShaderVarType::_BVEC3_:
+		case ShaderVarType::_IVEC3_:
+		case ShaderVarType::_DVEC3_:
+		case ShaderVarType::_VEC3_:
+			return 3;
+		case ShaderVarType::_BVEC4_:
+		case ShaderVarType::_IVEC4_:
+		case ShaderVarType::_DVEC4_:
+		case ShaderVarType::_VEC4_:
+			return 4;
+		default:
+			return 0;
+		}
+	}
+
+	// only float math is folded, integer division and double precision would change.
+	uint32_t FloatComponents(ShaderVarType type)
+	{
+		switch (type)
+		{
+		case ShaderVarType::_FLOAT_:
+		case ShaderVarType::_VEC2_:
+		case ShaderVarType::_VEC3_:
+		case ShaderVarType::_VEC4_:
+			return Components(type);
+		default:
+			return 0;
+		}
+	}
+
+	bool IsFloatConstant(const CG_Node& node)
+	{
+		return node.op == CG_Op::Constant && FloatComponents(node.type) != 0;
+	}
+
+	// a scalar is broadcast to every component.
+	double Component(const CG_Node& node, uint32_t i)
+	{
+		return Components(node.type) == 1 ? node.values[0] : node.values[i];
+	}
+
+	bool IsValue(const CG_Node& node, double value)
+	{
+		if (!IsFloatConstant(node))
+			return false;
+
+		for (uint32_t i = 0; i < FloatComponents(node.type); i++)
+			if (node.values[i] != value)
+				return false;
+
+		return true;
+	}
+
+	bool IsArithmetic(CG_Op op)
+	{
+		return op == CG_Op::Add || op == CG_Op::Subtract || op == CG_Op::Multiply || op == CG_Op::Divide || op == CG_Op::Negate;
+	}
+
+	bool IsMatrix(ShaderVarType type)
+	{
+		return type == ShaderVarType::_MAT3x3_ || type == ShaderVarType::_MAT4x4_;
+	}
+
+	std::string FloatLiteral(double value)
+	{
+		std::ostringstream ss;
+		ss << std::setprecision(9) << (float)value;
+
+		std::string text = ss.str();
+		if (text.find_first_of(".en") == std::string::npos)
+			text += ".0";
+		return text;
+	}
+
+	std::string ComponentLiteral(ShaderVarType type, double value)
+	{
+		switch (type)
+		{
+		case ShaderVarType::_BOOL_:
+		case ShaderVarType::_BVEC2_:
+		case ShaderVarType::_BVEC3_:
+		case ShaderVarType::_BVEC4_:
+			return value != 0.0 ? "true" : "false";
+		case ShaderVarType::_INT_:
+		case ShaderVarType::_IVEC2_:
+		case ShaderVarType::_IVEC3_:
+		case ShaderVarType::_IVEC4_:
+			return std::to_string((int64_t)value);
+		case ShaderVarType::_UINT_:
+			return std::to_string((uint64_t)value) + "u";
+		default:
+			return FloatLiteral(value);
+		}
+	}
+
+	std::string Literal(const CG_Node& node)
+	{
+		uint32_t count = Components(node.type);
+		if (count == 1)
+			return ComponentLiteral(node.type, node.values[0]);
+
+		bool splat = true;
+		for (uint32_t i = 1; i < count; i++)
+			splat &= node.values[i] == node.values[0];
+
+		std::string text = ShaderVarTypeToGLSLTypeString(node.type) + "(";
+		for (uint32_t i = 0; i < (splat ? 1 : count); i++)
+			text += (i ? ", " : "") + ComponentLiteral(node.type, node.values[i]);
+		return text + ")";
+	}
+
+	bool CheckInputs(const std::vector<CG_Node>& nodes, NodeId id)
+	{
+		const CG_Node& node = nodes[id];
+		size_t count = node.inputs.size();
+
+		bool arity = true;
+		switch (node.op)
+		{
+		case CG_Op::Constant:
+		case CG_Op::Variable:
+			arity = count == 0;
+			break;
+		case CG_Op::Add:
+		case CG_Op::Subtract:
+		case CG_Op::Multiply:
+		case CG_Op::Divide:
+			arity = count == 2;
+			break;
+		case CG_Op::Negate:
+		case CG_Op::Swizzle:
+		case CG_Op::Output:
+			arity = count == 1;
+			break;
+		case CG_Op::Construct:
+			arity = count >= 1;
+			break;
+		case CG_Op::Call:
+			break;
+		}
+
+		if (!arity)
+		{
+			Console::Error("Code Graph Node ", id, " Has ", count, " Inputs.");
+			return false;
+		}
+
+		for (NodeId input : node.inputs)
+		{
+			if (input >= nodes.size())
+			{
+				Console::Error("Code Graph Node ", id, " Has An Unconnected Input.");
+				return false;
+			}
+		}
+
+		if (node.op == CG_Op::Constant && Components(node.type) == 0)
+		{
+			Console::Error("Code Graph Node ", id, " Is A Matrix Constant, Build It With Construct.");
+			return false;
+		}
+
+		return true;
+	}
+
+	// post order from the outputs, inputs before the nodes reading them. unreachable nodes are left out.
+	bool Sort(const std::vector<CG_Node>& nodes, std::vector<NodeId>& order)
+	{
+		enum : uint8_t { Unvisited, Visiting, Done };
+		std::vector<uint8_t> state(nodes.size(), Unvisited);
+
+		auto visit = [&](auto& self, NodeId id) -> bool {
+			if (state[id] == Done)
+				return true;
+			if (state[id] == Visiting)
+				return false;
+
+			state[id] = Visiting;
+			for (NodeId input : nodes[id].inputs)
+				if (!self(self, input))
+					return false;
+			state[id] = Done;
+
+			order.push_back(id);
+			return true;
+		};
+
+		for (NodeId id = 0; id < (NodeId)nodes.size(); id++)
+			if (nodes[id].op == CG_Op::Output && !visit(visit, id))
+				return false;
+
+		return true;
+	}
+
+	bool FoldBinary(CG_Node& node, const CG_Node& a, const CG_Node& b)
+	{
+		uint32_t count = FloatComponents(node.type);
+		if (count == 0 || !IsFloatConstant(a) || !IsFloatConstant(b))
+			return false;
+
+		auto fits = [&](const CG_Node& input) {
+			uint32_t components = FloatComponents(input.type);
+			return components == 1 || components == count;
+		};
+
+		if (!fits(a) || !fits(b))
+			return false;
+
+		double values[4];
+		for (uint32_t i = 0; i < count; i++)
+		{
+			// in float, the way the gpu would have computed it.
+			float x = (float)Component(a, i);
+			float y = (float)Component(b, i);
+
+			float result;
+			switch (node.op)
+			{
+			case CG_Op::Add: result = x + y; break;
+			case CG_Op::Subtract: result = x - y; break;
+			case CG_Op::Multiply: result = x * y; break;
+			case CG_Op::Divide:
+				if (y == 0.0f)
+					return false;
+				result = x / y;
+				break;
+			default:
+				return false;
+			}
+
+			// glsl has no literal for inf or nan, an overflow is left to the gpu.
+			if (!std::isfinite(result))
+				return false;
+
+			values[i] = result;
+		}
+
+		node.op = CG_Op::Constant;
+		node.inputs.clear();
+		std::copy(values, values + count, node.values);
+		return true;
+	}
+
+	bool FoldSwizzle(CG_Node& node, const CG_Node& a)
+	{
+		uint32_t count = FloatComponents(node.type);
+		if (count == 0 || count != node.text.size() || !IsFloatConstant(a))
+			return false;
+
+		double values[4];
+		for (uint32_t i = 0; i < count; i++)
+		{
+			size_t index = std::string("xyzw").find(node.text[i]);
+			if (index == std::string::npos)
+				index = std::string("rgba").find(node.text[i]);
+			if (index == std::string::npos)
+				index = std::string("stpq").find(node.text[i]);
+			if (index == std::string::npos || index >= FloatComponents(a.type))
+				return false;
+
+			values[i] = a.values[index];
+		}
+
+		node.op = CG_Op::Constant;
+		node.inputs.clear();
+		node.text.clear();
+		std::copy(values, values + count, node.values);
+		return true;
+	}
+
+	bool FoldConstruct(CG_Node& node, const std::vector<CG_Node>& nodes)
+	{
+		uint32_t count = FloatComponents(node.type);
+		if (count == 0)
+			return false;
+
+		double values[4];
+		uint32_t filled = 0;
+		for (NodeId input : node.inputs)
+		{
+			const CG_Node& part = nodes[input];
+			if (!IsFloatConstant(part))
+				return false;
+
+			for (uint32_t i = 0; i < FloatComponents(part.type) && filled < 4; i++)
+				values[filled++] = part.values[i];
+		}
+
+		// vec3(x) fills every component, otherwise they have to add up.
+		if (filled == 1)
+			std::fill(values + 1, values + count, values[0]);
+		else if (filled != count)
+			return false;
+
+		node.op = CG_Op::Constant;
+		node.inputs.clear();
+		std::copy(values, values + count, node.values);
+		return true;
+	}
+
+	// folds `id` in place or names the node that already computes it. inputs are final.
+	NodeId Simplify(std::vector<CG_Node>& nodes, NodeId id)
+	{
+		CG_Node& node = nodes[id];
+
+		switch (node.op)
+		{
+		case CG_Op::Add:
+		case CG_Op::Subtract:
+		case CG_Op::Multiply:
+		case CG_Op::Divide:
+		{
+			const CG_Node& a = nodes[node.inputs[0]];
+			const CG_Node& b = nodes[node.inputs[1]];
+
+			if (FoldBinary(node, a, b))
+				return id;
+
+			// identities, only when the other side already has the result's type.
+			bool addsZero = node.op == CG_Op::Add || node.op == CG_Op::Subtract;
+			bool timesOne = node.op == CG_Op::Multiply || node.op == CG_Op::Divide;
+
+			if (node.op == CG_Op::Add && IsValue(a, 0.0) && b.type == node.type)
+				return node.inputs[1];
+			if (node.op == CG_Op::Multiply && IsValue(a, 1.0) && b.type == node.type)
+				return node.inputs[1];
+			if (((addsZero && IsValue(b, 0.0)) || (timesOne && IsValue(b, 1.0))) && a.type == node.type)
+				return node.inputs[0];
+
+			return id;
+		}
+		case CG_Op::Negate:
+		{
+			const CG_Node& a = nodes[node.inputs[0]];
+
+			if (IsFloatConstant(a) && a.type == node.type)
+			{
+				for (uint32_t i = 0; i < FloatComponents(a.type); i++)
+					node.values[i] = -a.values[i];
+				node.op = CG_Op::Constant;
+				node.inputs.clear();
+				return id;
+			}
+
+			if (a.op == CG_Op::Negate && nodes[a.inputs[0]].type == node.type)
+				return a.inputs[0];
+
+			return id;
+		}
+		case CG_Op::Swizzle:
+			FoldSwizzle(node, nodes[node.inputs[0]]);
+			return id;
+		case CG_Op::Construct:
+			FoldConstruct(node, nodes);
+			return id;
+		default:
+			return id;
+		}
+	}
+
+	// equal keys compute equal values.
+	std::string Key(const std::vector<CG_Node>& nodes, const CG_Node& node)
+	{
+		std::ostringstream ss;
+		ss << (int)node.op << ':' << (int)node.type << ':' << node.text << ':';
+
+		if (node.op == CG_Op::Constant)
+		{
+			ss << std::setprecision(17);
+			for (uint32_t i = 0; i < Components(node.type); i++)
+				ss << node.values[i] << ',';
+		}
+
+		SmallVector<NodeId, 4> inputs = node.inputs;
+
+		// a * b == b * a, except for matrix products.
+		bool commutative = node.op == CG_Op::Add
+			|| (node.op == CG_Op::Multiply && !IsMatrix(nodes[inputs[0]].type) && !IsMatrix(nodes[inputs[1]].type));
+		if (commutative && inputs[1] < inputs[0])
+			std::swap(inputs[0], inputs[1]);
+
+		for (NodeId input : inputs)
+			ss << input << ',';
+
+		return ss.str();
+	}
+}
+
+CG_Node CG_Node::Constant(float value)
+{
+	return Constant(ShaderVarType::_FLOAT_, { value });
+}
+
+CG_Node CG_Node::Constant(ShaderVarType type, std::initializer_list<double> values)
+{
+	assert(values.size() == 1 || values.size() == Components(type));
+
+	CG_Node node;
+	node.op = CG_Op::Constant;
+	node.type = type;
+
+	uint32_t i = 0;
+	for (double value : values)
+		node.values[i++] = value;
+	for (; i < 4; i++)
+		node.values[i] = values.size() == 1 ? node.values[0] : 0.0;
+
+	return node;
+}
+
+CG_Node CG_Node::Variable(ShaderVarType type, const std::string& name)
+{
+	CG_Node node;
+	node.op = CG_Op::Variable;
+	node.type = type;
+	node.text = name;
+	return node;
+}
+
+CG_Node CG_Node::Operator(CG_Op op, ShaderVarType type)
+{
+	assert(IsArithmetic(op) && "Not An Operator.");
+
+	CG_Node node;
+	node.op = op;
+	node.type = type;
+	return node;
+}
+
+CG_Node CG_Node::Call(ShaderVarType type, const std::string& function)
+{
+	CG_Node node;
+	node.op = CG_Op::Call;
+	node.type = type;
+	node.text = function;
+	return node;
+}
+
+CG_Node CG_Node::Swizzle(ShaderVarType type, const std::string& mask)
+{
+	CG_Node node;
+	node.op = CG_Op::Swizzle;
+	node.type = type;
+	node.text = mask;
+	return node;
+}
+
+CG_Node CG_Node::Construct(ShaderVarType type)
+{
+	CG_Node node;
+	node.op = CG_Op::Construct;
+	node.type = type;
+	return node;
+}
+
+CG_Node CG_Node::Output(const std::string& name)
+{
+	CG_Node node;
+	node.op = CG_Op::Output;
+	node.text = name;
+	return node;
+}
+
+NodeId CodeGraph::Add(const CG_Node& node)
+{
+	nodes.push_back(node);
+	return (NodeId)nodes.size() - 1;
+}
+
+void CodeGraph::Connect(NodeId from, NodeId to, uint32_t slot)
+{
+	assert(from < nodes.size() && to < nodes.size() && "Unknown Node.");
+
+	auto& inputs = nodes[to].inputs;
+	while (inputs.size() <= slot)
+		inputs.push_back(InvalidNode);
+
+	inputs[slot] = from;
+}
+
+bool CodeGraph::Emit(std::string& glsl) const
+{
+	glsl.clear();
+
+	for (NodeId id = 0; id < (NodeId)nodes.size(); id++)
+		if (!CheckInputs(nodes, id))
+			return false;
+
+	// rewritten in place, the graph as it was built stays untouched.
+	std::vector<CG_Node> graph = nodes;
+
+	std::vector<NodeId> order;
+	if (!Sort(graph, order))
+	{
+		Console::Error("Code Graph Has A Cycle.");
+		return false;
+	}
+
+	// SIMPLIFY
+	// in dependency order, every input is folded and merged before it is read.
+	std::vector<NodeId> replaced(graph.size());
+	std::iota(replaced.begin(), replaced.end(), 0);
+
+	FlatHashMap<std::string, NodeId> unique;
+	for (NodeId id : order)
+	{
+		for (NodeId& input : graph[id].inputs)
+			input = replaced[input];
+
+		NodeId same = Simplify(graph, id);
+		if (same != id || graph[id].op == CG_Op::Output)
+		{
+			replaced[id] = same;
+			continue;
+		}
+
+		replaced[id] = unique.try_emplace(Key(graph, graph[id]), id).first->second;
+	}
+
+	// folding and merging left nodes behind that nothing reads anymore.
+	order.clear();
+	Sort(graph, order);
+
+	std::vector<uint32_t> uses(graph.size(), 0);
+	for (NodeId id : order)
+		for (NodeId input : graph[id].inputs)
+			uses[input]++;
+
+	// EMIT
+	std::vector<std::string> expressions(graph.size());
+	std::vector<bool> local(graph.size(), false);
+
+	// arithmetic gets parentheses when it is part of a bigger expression, so do
+	// negative literals and anything swizzled that is not a plain name.
+	auto operand = [&](NodeId input, bool swizzled = false) {
+		const std::string& expression = expressions[input];
+		bool literal = graph[input].op == CG_Op::Constant && (swizzled || expression[0] == '-');
+		bool bare = local[input] || !(IsArithmetic(graph[input].op) || literal);
+		return bare ? expression : "(" + expression + ")";
+	};
+
+	auto arguments = [&](const CG_Node& node) {
+		std::string text;
+		for (size_t i = 0; i < node.inputs.size(); i++)
+			text += (i ? ", " : "") + expressions[node.inputs[i]];
+		return text;
+	};
+
+	std::ostringstream ss;
+	uint32_t locals = 0;
+
+	for (NodeId id : order)
+	{
+		const CG_Node& node = graph[id];
+
+		std::string expression;
+		switch (node.op)
+		{
+		case CG_Op::Constant: expression = Literal(node); break;
+		case CG_Op::Variable: expression = node.text; break;
+		case CG_Op::Add: expression = operand(node.inputs[0]) + " + " + operand(node.inputs[1]); break;
+		case CG_Op::Subtract: expression = operand(node.inputs[0]) + " - " + operand(node.inputs[1]); break;
+		case CG_Op::Multiply: expression = operand(node.inputs[0]) + " * " + operand(node.inputs[1]); break;
+		case CG_Op::Divide: expression = operand(node.inputs[0]) + " / " + operand(node.inputs[1]); break;
+		case CG_Op::Negate: expression = "-" + operand(node.inputs[0]); break;
+		case CG_Op::Call: expression = node.text + "(" + arguments(node) + ")"; break;
+		case CG_Op::Swizzle: expression = operand(node.inputs[0], true) + "." + node.text; break;
+		case CG_Op::Construct: expression = ShaderVarTypeToGLSLTypeString(node.type) + "(" + arguments(node) + ")"; break;
+		case CG_Op::Output:
+			ss << "\t" << node.text << " = " << expressions[node.inputs[0]] << ";\n";
+			continue;
+		}
+
+		// computed once, read by name.
+		if (uses[id] > 1 && node.op != CG_Op::Constant && node.op != CG_Op::Variable)
+		{
+			std::string name = "_cg" + std::to_string(locals++);
+			ss << "\t" << ShaderVarTypeToGLSLTypeString(node.type) << " " << name << " = " << expression << ";\n";
+
+			expression = name;
+			local[id] = true;
+		}
+
+		expressions[id] = expression;
+	}
+
+	glsl = ss.str();
+	return true;
+}
+
+bool CodeGraph::Empty() const
+{
+	return nodes.empty();
+}
+
+uint32_t CodeGraph::GetNodeCount() const
+{
+	return (uint32_t)nodes.size();
+}
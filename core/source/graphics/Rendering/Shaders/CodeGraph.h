@@ -0,0 +1,98 @@
+#pragma once
+
+#include "datastructures/datastructures_pch.h"
+
+#include "ShaderTypes.h"
+
+#include <initializer_list>
+
+using NodeId = uint32_t;
+
+static constexpr NodeId InvalidNode = ~0u;
+
+enum class CG_Op : uint8_t {
+	// literal, `values` hold its components.
+	Constant,
+	// anything already declared by name, an input, a uniform member, a builtin.
+	Variable,
+
+	Add,
+	Subtract,
+	Multiply,
+	Divide,
+	Negate,
+
+	// glsl function, `text` is its name and the inputs its arguments.
+	Call,
+	// `text` is the component mask.
+	Swizzle,
+	// `type` constructor from the inputs.
+	Construct,
+
+	// assigns its input to the variable named `text`, only what reaches an output is emitted.
+	Output,
+};
+
+// one value in the code graph. inputs are filled in by ConnectNodes().
+struct CG_Node {
+	CG_Op op = CG_Op::Constant;
+	ShaderVarType type = ShaderVarType::_FLOAT_;
+	std::string text;
+	double values[4] = {};
+
+	SmallVector<NodeId, 4> inputs;
+
+	static CG_Node Constant(float value);
+	// one value per component, a single value fills them all.
+	static CG_Node Constant(ShaderVarType type, std::initializer_list<double> values);
+	static CG_Node Variable(ShaderVarType type, const std::string& name);
+	static CG_Node Operator(CG_Op op, ShaderVarType type);
+	static CG_Node Call(ShaderVarType type, const std::string& function);
+	static CG_Node Swizzle(ShaderVarType type, const std::string& mask);
+	static CG_Node Construct(ShaderVarType type);
+	static CG_Node Output(const std::string& name);
+};
+
+/*
+*
+*  FragColor = Color * 0.5 * 2.0
+*
+	auto color = shader.AddNode(CG_Node::Variable(ShaderVarType::_VEC4_, "Color"));
+	auto half = shader.AddNode(CG_Node::Constant(0.5f));
+	auto two = shader.AddNode(CG_Node::Constant(2.0f));
+
+	auto scale = shader.AddNode(CG_Node::Operator(CG_Op::Multiply, ShaderVarType::_FLOAT_));
+	shader.ConnectNodes(half, scale, 0);
+	shader.ConnectNodes(two, scale, 1);
+
+	auto result = shader.AddNode(CG_Node::Operator(CG_Op::Multiply, ShaderVarType::_VEC4_));
+	shader.ConnectNodes(color, result, 0);
+	shader.ConnectNodes(scale, result, 1);
+
+	auto out = shader.AddNode(CG_Node::Output("FragColor"));
+	shader.ConnectNodes(result, out, 0);
+
+	emits "FragColor = Color;", 0.5 * 2.0 folds to 1.0 and the multiply by one drops.
+*/
+
+// the body of a shader as a DAG of values.
+//
+// Emit() walks back from the outputs, so nodes no output reads are dropped.
+// on the way arithmetic on float constants is folded, identities (x + 0,
+// x * 1, -(-x)) are removed and equal nodes are merged. what is left is
+// printed in dependency order, values read more than once go into a local.
+class CodeGraph {
+public:
+	NodeId Add(const CG_Node& node);
+	void Connect(NodeId from, NodeId to, uint32_t slot);
+
+	// glsl statements for the body of main(). false on a cycle, an unconnected
+	// input or a node with the wrong number of inputs.
+	bool Emit(std::string& glsl) const;
+
+	bool Empty() const;
+	uint32_t GetNodeCount() const;
+
+private:
+	std::vector<CG_Node> nodes;
+};
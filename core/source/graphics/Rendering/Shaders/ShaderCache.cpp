@@ -0,0 +1,126 @@
+#include "ShaderCache.h"
+
+#include <debug/Console.h>
+#include <filesystem/AsyncIO.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+ShaderCache::ShaderCache(const std::string& directory)
+	: directory{ directory }
+{
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+
+	if (error)
+		Console::Warn("Shader Cache Directory Unavailable, Caching In Memory Only: ", directory);
+}
+
+uint64_t ShaderCache::Key(const std::string& source, VkShaderStageFlagBits stage, const std::string& defines)
+{
+	// FNV-1a, the separators keep "ab" + "c" apart from "a" + "bc".
+	uint64_t hash = 14695981039346656037ull;
+
+	auto add = [&](const std::string& text) {
+		for (unsigned char c : text)
+		{
+			hash ^= c;
+			hash *= 1099511628211ull;
+		}
+
+		hash ^= 0xff;
+		hash *= 1099511628211ull;
+	};
+
+	add(source);
+	add(std::to_string(stage));
+	add(defines);
+
+	return hash;
+}
+
+bool ShaderCache::Find(uint64_t key, SpirvCode& code)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto found = entries.find(key);
+		if (found != entries.end())
+		{
+			code = found->second;
+			return true;
+		}
+	}
+
+	// only read after LoadArchive(), no lock needed.
+	if (const FileSystem::ArchiveEntry* entry = archive.Find(key))
+	{
+		std::span<const uint8_t> view = archive.GetView(*entry);
+
+		if (!view.empty() && view.size() % sizeof(uint32_t) == 0)
+		{
+			code.resize(view.size() / sizeof(uint32_t));
+			std::memcpy(code.data(), view.data(), view.size());
+			return true;
+		}
+	}
+
+	std::vector<uint8_t> data = AsyncIO::ReadFile(GetPath(key), AsyncIO::Priority::High).get();
+	if (data.empty() || data.size() % sizeof(uint32_t) != 0)
+		return false;
+
+	code.resize(data.size() / sizeof(uint32_t));
+	std::memcpy(code.data(), data.data(), data.size());
+
+	std::lock_guard<std::mutex> lock(mutex);
+	entries.try_emplace(key, code);
+
+	return true;
+}
+
+void ShaderCache::Store(uint64_t key, const SpirvCode& code)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		entries.insert_or_assign(key, code);
+	}
+
+	// a failed write only costs a compile next run.
+	std::ofstream file(GetPath(key), std::ios::binary | std::ios::trunc);
+	if (file.is_open())
+		file.write(reinterpret_cast<const char*>(code.data()), code.size() * sizeof(uint32_t));
+}
+
+bool ShaderCache::WriteArchive(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	// stored, not compressed, so the runtime copies the code straight out of the mapping.
+	FileSystem::ArchiveWriter writer;
+
+	for (const auto& entry : entries)
+		writer.Add(entry.first, { reinterpret_cast<const uint8_t*>(entry.second.data()), entry.second.size() * sizeof(uint32_t) });
+
+	return writer.Write(path);
+}
+
+bool ShaderCache::LoadArchive(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return archive.Open(path);
+}
+
+uint32_t ShaderCache::GetEntryCount()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return (uint32_t)entries.size();
+}
+
+std::string ShaderCache::GetPath(uint64_t key)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.spv", (unsigned long long)key);
+
+	return (std::filesystem::path(directory) / name).generic_string();
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <graphics/gfx_pch.h>
+#include <filesystem/Archive.h>
+
+#include <mutex>
+
+using SpirvCode = std::vector<uint32_t>;
+
+// compiled SPIR-V keyed by everything that went into it.
+//
+// the key covers the generated glsl, the stage and the defines of a variant,
+// so an unchanged shader is never handed to the compiler again. entries are
+// kept in memory and written to `directory` as <key>.spv, a later run reads
+// them back from there. thread safe, variants compile in parallel.
+//
+// an archive packs every entry into one file. the shader cooker writes it
+// ahead of time and the runtime maps it at startup, a shader it holds is
+// never compiled and costs no file open of its own.
+class ShaderCache {
+public:
+	explicit ShaderCache(const std::string& directory);
+
+	ShaderCache(const ShaderCache&) = delete;
+	ShaderCache& operator=(const ShaderCache&) = delete;
+
+	static uint64_t Key(const std::string& source, VkShaderStageFlagBits stage, const std::string& defines);
+
+	// memory first, then the archive, then disk.
+	bool Find(uint64_t key, SpirvCode& code);
+	void Store(uint64_t key, const SpirvCode& code);
+
+	// every entry into one file at `path`, sorted by key.
+	bool WriteArchive(const std::string& path);
+	// maps an archive, false when it is missing or malformed. call before the first Find().
+	bool LoadArchive(const std::string& path);
+
+	uint32_t GetEntryCount();
+
+private:
+	std::string GetPath(uint64_t key);
+
+	std::mutex mutex;
+	std::string directory;
+
+	FlatHashMap<uint64_t, SpirvCode> entries;
+	FileSystem::Archive archive;
+};
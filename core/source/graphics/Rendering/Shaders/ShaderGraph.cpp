@@ -9,11 +9,52 @@
 #include <cstdio>  // For pipe, feof, fgets
 
 #include <filesystem>
+#include <algorithm>
 
 #include <debug/Console.h>
+#include <jobs/JobSystem.h>
+#include <filesystem/AsyncIO.h>
+
+#include <atomic>
+#include <cstring>
 
 #include "filesystem/Utils.h"
 
+namespace {
+	// runs a command line tool, its output is only shown when it fails.
+	bool RunTool(const std::string& cmd)
+	{
+		Console::Log("Running: cmd: ", cmd);
+
+		std::stringstream output;
+		// Capture command output
+		FILE* pipe = _popen(cmd.c_str(), "r"); // execute the command 
+		if (!pipe) {
+			Console::Fatal("Failed to execute command!");
+			return false;
+		}
+
+		char buffer[128];
+		while (!feof(pipe)) {
+			if (fgets(buffer, 128, pipe) != nullptr) {
+				output << buffer;
+			}
+		}
+
+		// Check result of the command
+		int result = _pclose(pipe);
+
+		if (result != 0) {
+			Console::Warn("System Command Failed! ErrorCode: ", result);
+			Console::Log("Errors: ", output.str());
+
+			return false;
+		}
+
+		return true;
+	}
+}
+
 
 ShaderGraph::ShaderGraph(VkDevice device, const std::string& filepath, VkShaderStageFlagBits stage)
 {
@@ -29,12 +70,16 @@ ShaderGraph::ShaderGraph(VkDevice device, const std::string& filepath, VkShaderS
 	this->ioTable[ShaderTableGroup::Inputs] = {};
 	this->ioTable[ShaderTableGroup::Outputs] = {};
 	this->ioTable[ShaderTableGroup::Uniforms] =  {};
+	this->ioTable[ShaderTableGroup::Buffers] = {};
+	this->ioTable[ShaderTableGroup::PushConstants] = {};
 
 }
 
 ShaderGraph::~ShaderGraph()
 {
-	vkDestroyShaderModule(device, shaderModule, nullptr);
+	for (Permutation& permutation : permutations)
+		if (permutation.module != VK_NULL_HANDLE)
+			vkDestroyShaderModule(device, permutation.module, nullptr);
 }
 
 void ShaderGraph::AddInput(int location, ShaderVarType type, const std::string& name, int binding)
@@ -49,6 +94,19 @@ void ShaderGraph::AddInput(int location, ShaderVarType type, const std::string&
 	ioTable[ShaderTableGroup::Inputs].push_back(elm);
 }
 
+void ShaderGraph::AddInstanceInput(int location, ShaderVarType type, const std::string& name, int binding)
+{
+	ShaderTableElement elm{
+		.name = name,
+		.type = type,
+		.location = location,
+		.binding = binding,
+		.rate = VK_VERTEX_INPUT_RATE_INSTANCE,
+	};
+
+	ioTable[ShaderTableGroup::Inputs].push_back(elm);
+}
+
 void ShaderGraph::AddOutput(int location, ShaderVarType type, const std::string& name)
 {
 	ShaderTableElement elm{
@@ -60,31 +118,94 @@ void ShaderGraph::AddOutput(int location, ShaderVarType type, const std::string&
 	ioTable[ShaderTableGroup::Outputs].push_back(elm);
 }
 
-void ShaderGraph::AddUniform(ShaderVarType type, const std::string& name)
+void ShaderGraph::AddUniform(int binding, const std::string& name, const std::string& members, bool dynamic)
 {
 	ShaderTableElement elm{
-	.name = name,
-	.type = type,
+		.name = name,
+		.binding = binding,
+		.members = members,
+		.dynamic = dynamic,
 	};
 
 	ioTable[ShaderTableGroup::Uniforms].push_back(elm);
 }
 
+void ShaderGraph::AddStorageBuffer(int binding, const std::string& name, const std::string& members, bool readonly)
+{
+	ShaderTableElement elm{
+		.name = name,
+		.binding = binding,
+		.members = members,
+		.readonly = readonly,
+	};
+
+	ioTable[ShaderTableGroup::Buffers].push_back(elm);
+}
+
+void ShaderGraph::AddPushConstants(const std::string& name, const std::string& members, uint32_t size)
+{
+	ShaderTableElement elm{
+		.name = name,
+		.members = members,
+		.size = size,
+	};
+
+	// a stage has a single push constant block.
+	ioTable[ShaderTableGroup::PushConstants].clear();
+	ioTable[ShaderTableGroup::PushConstants].push_back(elm);
+}
+
+void ShaderGraph::SetWorkgroupSize(uint32_t x, uint32_t y, uint32_t z)
+{
+	workgroup[0] = x;
+	workgroup[1] = y;
+	workgroup[2] = z;
+}
+
 void ShaderGraph::AddMain(const std::string& fn)
 {
 	func.clear();
 	func = fn;
 }
 
-void ShaderGraph::AddNode(CG_Node* node)
-{	
-	nodes.push_back(node);
+ShaderVariant ShaderGraph::AddSwitch(const std::string& name, ShaderSwitchMode mode)
+{
+	assert(switches.size() < 32 && "A ShaderVariant Holds 32 Switches.");
+
+	uint32_t constants = 0;
+	uint32_t defines = 0;
+	for (const ShaderSwitch& other : switches)
+		(other.mode == ShaderSwitchMode::Define ? defines : constants)++;
+
+	assert((mode != ShaderSwitchMode::Define || defines < MaxDefineSwitches) && "Too Many Define Switches, Use Specialization Constants.");
+
+	switches.push_back({
+		.name = name,
+		.mode = mode,
+		.constantId = constants,
+	});
+
+	return 1u << (switches.size() - 1);
+}
+
+void ShaderGraph::LinkCache(ShaderCache* cache)
+{
+	this->cache = cache;
+}
+
+void ShaderGraph::SetOptimization(ShaderOptimization optimization)
+{
+	this->optimization = optimization;
 }
 
-void ShaderGraph::ConnectNodes(CG_Node* left, CG_Node* right)
+NodeId ShaderGraph::AddNode(const CG_Node& node)
 {
-	edges[left] = right;
-	edges[right] = left;
+	return graph.Add(node);
+}
+
+void ShaderGraph::ConnectNodes(NodeId from, NodeId to, uint32_t slot)
+{
+	graph.Connect(from, to, slot);
 }
 
 
@@ -92,21 +213,176 @@ bool ShaderGraph::Compile()
 {
 	std::string hlslFilePath = directory + fileName + ShaderGraph::extension_GLSL;
 	FileSystem::CreateIFFNoneExist(hlslFilePath);
-	GenerateShaderData();
-	return ConvertSourceToSPIRV() && LoadSPIRVByteCode() && CreateModule();
+
+	std::string source;
+	if (!GenerateShaderData(source))
+		return false;
+
+	for (Permutation& permutation : permutations)
+		if (permutation.module != VK_NULL_HANDLE)
+			vkDestroyShaderModule(device, permutation.module, nullptr);
+
+	uint32_t defineCount = 0;
+	for (const ShaderSwitch& option : switches)
+		defineCount += option.mode == ShaderSwitchMode::Define;
+
+	// one module per combination of define switches, specialization switches share them.
+	permutations.clear();
+	permutations.resize(1u << defineCount);
+
+	for (uint32_t index = 0; index < (uint32_t)permutations.size(); index++)
+		permutations[index].defines = GetDefines(index);
+
+	std::atomic<bool> built{ true };
+	Jobs::ParallelFor((uint32_t)permutations.size(), 1, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t index = begin; index < end; index++)
+			if (!BuildPermutation(permutations[index], source, index))
+				built = false;
+	});
+
+	if (!built)
+		return false;
+
+	// without a device only the SPIR-V is built, for the shader cooker.
+	if (device == VK_NULL_HANDLE)
+		return true;
+
+	for (Permutation& permutation : permutations)
+		if (!CreateModule(permutation))
+			return false;
+
+	return true;
+}
+
+VkShaderModule ShaderGraph::Get(ShaderVariant variant) const
+{
+	uint32_t index = GetPermutation(variant);
+	return index < permutations.size() ? permutations[index].module : VK_NULL_HANDLE;
+}
+
+VkShaderStageFlagBits ShaderGraph::GetStage() const
+{
+	return stage;
+}
+
+uint64_t ShaderGraph::GetHash(ShaderVariant variant) const
+{
+	uint32_t index = GetPermutation(variant);
+	if (index >= permutations.size())
+		return 0;
+
+	uint64_t hash = permutations[index].hash;
+
+	// the same module specialized differently is a different shader.
+	for (VkBool32 value : GetSpecialization(variant).values)
+	{
+		hash ^= value;
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+ShaderSpecialization ShaderGraph::GetSpecialization(ShaderVariant variant) const
+{
+	ShaderSpecialization specialization;
+
+	for (uint32_t bit = 0; bit < (uint32_t)switches.size(); bit++)
+	{
+		const ShaderSwitch& option = switches[bit];
+		if (option.mode != ShaderSwitchMode::Specialization)
+			continue;
+
+		specialization.entries.push_back({
+			.constantID = option.constantId,
+			.offset = (uint32_t)(specialization.values.size() * sizeof(VkBool32)),
+			.size = sizeof(VkBool32),
+		});
+		specialization.values.push_back((variant >> bit) & 1 ? VK_TRUE : VK_FALSE);
+	}
+
+	return specialization;
+}
+
+uint32_t ShaderGraph::GetModuleCount() const
+{
+	return (uint32_t)permutations.size();
 }
-VkShaderModule ShaderGraph::Get()
+
+uint32_t ShaderGraph::GetPermutation(ShaderVariant variant) const
+{
+	uint32_t index = 0;
+	uint32_t packed = 0;
+
+	for (uint32_t bit = 0; bit < (uint32_t)switches.size(); bit++)
+	{
+		if (switches[bit].mode != ShaderSwitchMode::Define)
+			continue;
+
+		index |= ((variant >> bit) & 1) << packed++;
+	}
+
+	return index;
+}
+
+std::string ShaderGraph::GetDefines(uint32_t permutation) const
 {
-	return shaderModule;
+	std::string defines;
+
+	uint32_t bit = 0;
+	for (const ShaderSwitch& option : switches)
+	{
+		if (option.mode != ShaderSwitchMode::Define)
+			continue;
+
+		defines += " -D" + option.name + "=" + ((permutation >> bit++) & 1 ? "1" : "0");
+	}
+
+	return defines;
 }
 
-std::vector<VkVertexInputAttributeDescription> ShaderGraph::GetAttributes()
+bool ShaderGraph::BuildPermutation(Permutation& permutation, const std::string& source, uint32_t index)
 {
-	std::vector<VkVertexInputAttributeDescription> attributes;
+	std::string flags = GetOptimizerFlags();
+	uint64_t key = ShaderCache::Key(source, stage, permutation.defines + flags);
+
+	if (!cache || !cache->Find(key, permutation.code))
+	{
+		// every permutation writes its own file, they compile side by side.
+		std::string spvFilePath = directory + fileName + (index ? "." + std::to_string(index) : "") + ShaderGraph::extension_SPIRV;
+
+		if (!ConvertSourceToSPIRV(permutation.defines, spvFilePath) || !LoadSPIRVByteCode(spvFilePath, permutation.code))
+			return false;
+
+		// the optimizer is optional, without it the module is only bigger and slower to build.
+		bool optimized = flags.empty() || OptimizeSPIRV(spvFilePath, flags, permutation.code);
+		if (!optimized)
+			Console::Warn("SPIR-V Optimization Failed, Using The Unoptimized Module: ", fileName);
+
+		// kept out of the cache, the next run tries the optimizer again.
+		if (cache && optimized)
+			cache->Store(key, permutation.code);
+	}
+
+	// FNV-1a over the words, pipelines built from equal code are shared through it.
+	permutation.hash = 14695981039346656037ull;
+	for (uint32_t word : permutation.code)
+	{
+		permutation.hash ^= word;
+		permutation.hash *= 1099511628211ull;
+	}
+
+	return !permutation.code.empty();
+}
+
+VertexAttributeList ShaderGraph::GetAttributes() const
+{
+	VertexAttributeList attributes;
 
 	// build the attrutes list based on the current inputs.
-	auto list = ioTable[ShaderTableGroup::Inputs];
-	uint32_t offset = 0;
+	const auto& list = ioTable.at(ShaderTableGroup::Inputs);
+	// running offset of every binding.
+	FlatHashMap<int, uint32_t> offsets;
 
 	for (auto it = list.begin(); it != list.end(); it++)
 	{
@@ -174,112 +450,170 @@ std::vector<VkVertexInputAttributeDescription> ShaderGraph::GetAttributes()
 
 		}
 
+		// every format above is 32 bits per component, the next attribute starts right after this one.
+		uint32_t& offset = offsets[it->binding];
 		attr.offset = offset;
-		
-		bool isInt = it->type == ShaderVarType::_INT_
-			|| it->type == ShaderVarType::_IVEC2_
-			|| it->type == ShaderVarType::_IVEC3_
-			|| it->type == ShaderVarType::_IVEC4_;
+		offset += components_count * sizeof(uint32_t);
 
-		bool isBool = it->type == ShaderVarType::_BOOL_
-			|| it->type == ShaderVarType::_BVEC2_
-			|| it->type == ShaderVarType::_BVEC3_
-			|| it->type == ShaderVarType::_BVEC4_;
+		attributes.push_back(attr);
+	}
 
-		// calculate the next attributes offset, from the beginning of the buffer
-		float size = 0;
 
-		if (isInt) {
-			size = sizeof(int32_t) * components_count;
-		}
-		else if (isBool) {
-			size = sizeof(bool) * components_count;
-		}
-		else {
-			size = sizeof(float_t) * components_count;
+	return attributes;
+}
+
+// bytes of the 32 bit per component formats GetAttributes() emits.
+static uint32_t GetFormatSize(VkFormat format)
+{
+	switch (format)
+	{
+	case VK_FORMAT_R32_SINT:
+	case VK_FORMAT_R32_SFLOAT:
+		return 4;
+	case VK_FORMAT_R32G32_SINT:
+	case VK_FORMAT_R32G32_SFLOAT:
+		return 8;
+	case VK_FORMAT_R32G32B32_SINT:
+	case VK_FORMAT_R32G32B32_SFLOAT:
+		return 12;
+	case VK_FORMAT_R32G32B32A32_SINT:
+	case VK_FORMAT_R32G32B32A32_SFLOAT:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+VertexBindingList ShaderGraph::GetBindings() const
+{
+	VertexBindingList bindings;
+
+	// strides match the packing GetAttributes() uses.
+	VertexAttributeList attributes = GetAttributes();
+	const auto& list = ioTable.at(ShaderTableGroup::Inputs);
+
+	for (size_t i = 0; i < list.size(); i++)
+	{
+		uint32_t binding = (uint32_t)list[i].binding;
+		uint32_t end = attributes[i].offset + GetFormatSize(attributes[i].format);
+
+		auto found = std::find_if(bindings.begin(), bindings.end(), [binding](const VkVertexInputBindingDescription& b) { return b.binding == binding; });
+		if (found == bindings.end())
+		{
+			bindings.push_back({ .binding = binding, .stride = end, .inputRate = list[i].rate });
+			continue;
 		}
 
-		offset += components_count; // working in 32bit instead of 8s
+		found->stride = std::max(found->stride, end);
+	}
 
-		attributes.push_back(attr);
+	return bindings;
+}
+
+DescriptorBindingList ShaderGraph::GetDescriptorBindings() const
+{
+	DescriptorBindingList bindings;
+
+	for (const auto& elm : ioTable.at(ShaderTableGroup::Uniforms))
+	{
+		bindings.push_back({
+			.binding = (uint32_t)elm.binding,
+			.descriptorType = elm.dynamic ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC : VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+			.descriptorCount = 1,
+			.stageFlags = (VkShaderStageFlags)stage,
+		});
 	}
 
+	for (const auto& elm : ioTable.at(ShaderTableGroup::Buffers))
+	{
+		bindings.push_back({
+			.binding = (uint32_t)elm.binding,
+			.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = 1,
+			.stageFlags = (VkShaderStageFlags)stage,
+		});
+	}
 
-	return attributes;
+	return bindings;
 }
 
-bool ShaderGraph::ConvertSourceToSPIRV() {
+uint32_t ShaderGraph::GetPushConstantSize() const
+{
+	const auto& list = ioTable.at(ShaderTableGroup::PushConstants);
+	return list.empty() ? 0 : list[0].size;
+}
 
-	std::string hlslFilePath = directory + fileName + ShaderGraph::extension_GLSL ;
-	std::string spvFilePath = directory + fileName + ShaderGraph::extension_SPIRV;
+uint32_t ShaderGraph::GetWorkgroupSize() const
+{
+	return workgroup[0] * workgroup[1] * workgroup[2];
+}
 
-	auto str = FileSystem::ReadFileFromDisc(hlslFilePath);
+bool ShaderGraph::ConvertSourceToSPIRV(const std::string& defines, const std::string& spvFilePath) {
 
-	Console::Log("File Contents: \n", str);
+	std::string hlslFilePath = directory + fileName + ShaderGraph::extension_GLSL ;
 
 	bool isGeometryShader = (stage & VK_SHADER_STAGE_GEOMETRY_BIT) != 0;
 	bool isFragmentShader = (stage & VK_SHADER_STAGE_FRAGMENT_BIT) != 0;
+	bool isComputeShader = (stage & VK_SHADER_STAGE_COMPUTE_BIT) != 0;
 
-	std::string shader_stage = (isGeometryShader ? " geom " : isFragmentShader ? " frag " : " vert ");
+	std::string shader_stage = (isComputeShader ? " comp " : isGeometryShader ? " geom " : isFragmentShader ? " frag " : " vert ");
 
-	std::string cmd = "glslangValidator -S" + shader_stage  + "\"" + hlslFilePath + "\"" + " -V -o " + "\"" + spvFilePath + "\"";
-	Console::Log("Running: cmd: ", cmd);
-	
-	std::stringstream output;
-	// Capture command output
-	FILE* pipe = _popen(cmd.c_str(), "r"); // execute the command 
-	if (!pipe) {
-		Console::Fatal("Failed to execute command!");
-		return false;
-	}
+	std::string cmd = "glslangValidator -S" + shader_stage  + "\"" + hlslFilePath + "\"" + defines + " -V -o " + "\"" + spvFilePath + "\"";
 
-	char buffer[128];
-	while (!feof(pipe)) {
-		if (fgets(buffer, 128, pipe) != nullptr) {
-			output << buffer;
-		}
-	}
-	
-	// Check result of the command
-	int result = _pclose(pipe);
+	return RunTool(cmd);
+}
 
-	if (result != 0) {
-		Console::Warn("System Command Failed! ErrorCode: ", result);
-		Console::Log("Errors: ", output.str());
-			
-		return false;
+std::string ShaderGraph::GetOptimizerFlags() const
+{
+	std::string flags;
+
+	switch (optimization)
+	{
+	case ShaderOptimization::None:
+		return flags;
+	case ShaderOptimization::Performance:
+		flags = " -O";
+		break;
+	case ShaderOptimization::Size:
+		flags = " -Os";
+		break;
 	}
 
-	return true;
+#if !_DEBUG
+	// names and line info only matter to debuggers and validation messages.
+	flags += " --strip-debug";
+#endif
+
+	return flags;
 }
 
-bool ShaderGraph::LoadSPIRVByteCode() {
-	std::string spvFilePath = directory + fileName + ShaderGraph::extension_SPIRV;
+bool ShaderGraph::OptimizeSPIRV(const std::string& spvFilePath, const std::string& flags, SpirvCode& code)
+{
+	std::string optFilePath = spvFilePath.substr(0, spvFilePath.size() - ShaderGraph::extension_SPIRV.size()) + ".opt" + ShaderGraph::extension_SPIRV;
+
+	std::string cmd = "spirv-opt" + flags + " \"" + spvFilePath + "\" -o \"" + optFilePath + "\"";
 
-	// Open the SPIR-V file in binary mode
-	std::ifstream file(spvFilePath, std::ios::binary);
-	if (!file.is_open()) {
-		// Failed to open the file
+	SpirvCode optimized;
+	if (!RunTool(cmd) || !LoadSPIRVByteCode(optFilePath, optimized))
 		return false;
-	}
 
-	// Get the file size
-	file.seekg(0, std::ios::end);
-	std::streampos fileSize = file.tellg();
-	file.seekg(0, std::ios::beg);
+	Console::Log("Optimized SPIR-V: ", code.size() * sizeof(uint32_t), " -> ", optimized.size() * sizeof(uint32_t), " Bytes.");
+
+	code = std::move(optimized);
+	return true;
+}
 
-	// Read the file data into a vector of bytes
-	std::vector<char> fileData(fileSize);
-	file.read(fileData.data(), fileSize);
+bool ShaderGraph::LoadSPIRVByteCode(const std::string& spvFilePath, SpirvCode& code) {
 
-	// Close the file
-	file.close();
+	// already on a job worker, waiting here leaves the other variants reading side by side.
+	std::vector<uint8_t> data = AsyncIO::ReadFile(spvFilePath, AsyncIO::Priority::High).get();
 
 	// Convert the byte data to a vector of unsigned integers (SPIR-V bytecode)
-	data.assign(reinterpret_cast<const unsigned int*>(fileData.data()), reinterpret_cast<const unsigned int*>(fileData.data() + fileSize));
+	code.resize(data.size() / sizeof(uint32_t));
+	std::memcpy(code.data(), data.data(), code.size() * sizeof(uint32_t));
 
 	// Check if any data was read
-	return !data.empty();
+	return !code.empty();
 }
 
 std::string ShaderVarTypeToGLSLTypeString(ShaderVarType type) {
@@ -327,8 +661,15 @@ std::string ShaderVarTypeToGLSLTypeString(ShaderVarType type) {
 }
 
 
-void ShaderGraph::GenerateShaderData()
+bool ShaderGraph::GenerateShaderData(std::string& source)
 {
+	std::string body;
+	if (!graph.Emit(body))
+	{
+		Console::Error("Code Graph Of ", fileName, " Could Not Be Emitted.");
+		return false;
+	}
+
 	std::stringstream ss;
 
 	ss << "// ------------------------------------------------------------------ \n";
@@ -339,13 +680,30 @@ void ShaderGraph::GenerateShaderData()
 	ss << "#version 450" << std::endl;
 	ss << "\n";
 
+	// generate switches, defines come from the compiler flags of each permutation.
+	for (const ShaderSwitch& option : switches)
+	{
+		if (option.mode == ShaderSwitchMode::Define)
+			ss << "#ifndef " << option.name << "\n#define " << option.name << " 0\n#endif\n";
+		else
+			ss << "layout(constant_id=" << option.constantId << ") const bool " << option.name << " = false;\n";
+	}
+	if (!switches.empty())
+		ss << "\n";
+
+	if (stage == VK_SHADER_STAGE_COMPUTE_BIT)
+	{
+		ss << "layout(local_size_x=" << workgroup[0] << ", local_size_y=" << workgroup[1] << ", local_size_z=" << workgroup[2] << ") in;\n";
+		ss << "\n";
+	}
+
 	// generate inputs
 	{
-		auto elements_list = ioTable[ShaderTableGroup::Inputs];
+		const auto& elements_list = ioTable.at(ShaderTableGroup::Inputs);
 
 		for (auto i = elements_list.begin(); i != elements_list.end(); i++)
 		{
-			auto elm = *i;
+			const auto& elm = *i;
 			ss << "layout(location=" << std::to_string(elm.location) << ") in " << ShaderVarTypeToGLSLTypeString(elm.type) << " " << elm.name << ";\n";
 		}
 	}
@@ -353,12 +711,36 @@ void ShaderGraph::GenerateShaderData()
 
 	// generate uniforms
 	{
-		auto elements_list = ioTable[ShaderTableGroup::Uniforms];
+		const auto& elements_list = ioTable.at(ShaderTableGroup::Uniforms);
 
 		for (auto i = elements_list.begin(); i != elements_list.end(); i++)
 		{
-			auto elm = *i;
-			ss << "uniform " << ShaderVarTypeToGLSLTypeString(elm.type) << " " << elm.name << ";\n";
+			const auto& elm = *i;
+			ss << "layout(std140, set=0, binding=" << elm.binding << ") uniform " << elm.name << "_t {\n" << elm.members << "} " << elm.name << ";\n";
+		}
+	}
+	ss << "\n";
+
+	// generate storage buffers
+	{
+		const auto& elements_list = ioTable.at(ShaderTableGroup::Buffers);
+
+		for (auto i = elements_list.begin(); i != elements_list.end(); i++)
+		{
+			const auto& elm = *i;
+			ss << "layout(std430, set=0, binding=" << elm.binding << ") " << (elm.readonly ? "readonly " : "") << "buffer " << elm.name << "_t {\n" << elm.members << "} " << elm.name << ";\n";
+		}
+	}
+	ss << "\n";
+
+	// generate push constants
+	{
+		const auto& elements_list = ioTable.at(ShaderTableGroup::PushConstants);
+
+		for (auto i = elements_list.begin(); i != elements_list.end(); i++)
+		{
+			const auto& elm = *i;
+			ss << "layout(push_constant) uniform " << elm.name << "_t {\n" << elm.members << "} " << elm.name << ";\n";
 		}
 	}
 	ss << "\n";
@@ -366,11 +748,11 @@ void ShaderGraph::GenerateShaderData()
 	// generate outputs
 
 	{
-		auto elements_list = ioTable[ShaderTableGroup::Outputs];
+		const auto& elements_list = ioTable.at(ShaderTableGroup::Outputs);
 
 		for (auto i = elements_list.begin(); i != elements_list.end(); i++)
 		{
-			auto elm = *i;
+			const auto& elm = *i;
 			ss << "layout(location=" << i->location << ") out " << ShaderVarTypeToGLSLTypeString(elm.type) << " " << elm.name << "; \n";
 		}
 	}
@@ -381,27 +763,64 @@ void ShaderGraph::GenerateShaderData()
 	// ------------------------------------
 	// CODE GRAPH DECOMPOSITION
 	// ------------------------------------
+	ss << body;
 
 	ss << "}\n";
 
 	// write stream to file.
 	auto filepath = directory + fileName + ShaderGraph::extension_GLSL;
 
-	FileSystem::WriteToFile(filepath, ss.str());
+	source = ss.str();
+	FileSystem::WriteToFile(filepath, source);
 
+	return true;
 }
 
-bool ShaderGraph::CreateModule() {
+bool ShaderGraph::CreateModule(Permutation& permutation) {
 
 	VkShaderModuleCreateInfo create{
 			.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
 			.pNext = nullptr,
 			.flags = 0,
-			.codeSize = data.size() * sizeof(unsigned int),
-			.pCode = data.data(),
+			.codeSize = permutation.code.size() * sizeof(uint32_t),
+			.pCode = permutation.code.data(),
 	};
 
-	return vkCreateShaderModule(device, &create, nullptr, &shaderModule) == VK_SUCCESS;
+	return vkCreateShaderModule(device, &create, nullptr, &permutation.module) == VK_SUCCESS;
 }
 
+ShaderGraph* ShaderDefinition::Create(VkDevice device, ShaderCache* cache, const std::string& directory) const
+{
+	std::string filepath = GetPath(directory);
 
+	ShaderGraph* shader = new ShaderGraph(device, filepath, stage);
+	shader->LinkCache(cache);
+	define(*shader);
+
+	if (!shader->Compile())
+	{
+		Console::Warn("Shader Compilation Failed: ", filepath);
+	}
+
+	return shader;
+}
+
+void ShaderDefinition::CreateAll(VkDevice device, ShaderCache* cache, std::initializer_list<std::pair<const ShaderDefinition&, ShaderGraph*&>> shaders, const std::string& directory)
+{
+	Jobs::Counter created;
+
+	for (const auto& shader : shaders)
+		Jobs::Run([shader, device, cache, &directory] { shader.second = shader.first.Create(device, cache, directory); }, &created);
+
+	Jobs::Wait(created);
+}
+
+std::string ShaderDefinition::GetPath(const std::string& directory) const
+{
+	return (std::filesystem::path(directory) / (std::string(name) + ".hlsl")).generic_string();
+}
+
+std::string ShaderDefinition::GetDirectory()
+{
+	return (std::filesystem::current_path() / "Shaders").generic_string();
+}
@@ -2,41 +2,19 @@
 
 #include "datastructures/datastructures_pch.h"
 #include "Graphics/gfx_pch.h"
+#include "graphics/Descriptors/DescriptorLayoutCache.h"
 
+#include "ShaderTypes.h"
+#include "CodeGraph.h"
+#include "ShaderCache.h"
 
-enum class ShaderVarType {
-	// default single value
-	_BOOL_,
-	_INT_,
-	_UINT_,
-	_FLOAT_,
-	_DOUBLE_,
-	// boolean vectors 
-	_BVEC2_,
-	_BVEC3_,
-	_BVEC4_,
-	// integer vectors
-	_IVEC2_,
-	_IVEC3_,
-	_IVEC4_,
-	// double vectors
-	_DVEC2_,
-	_DVEC3_,
-	_DVEC4_,
-	// float vectors
-	_VEC2_,
-	_VEC3_,
-	_VEC4_,
-
-	// matricies
-	_MAT3x3_,
-	_MAT4x4_
-};
 
 enum class ShaderTableGroup {
 	Inputs,
 	Uniforms,
 	Outputs,
+	Buffers,
+	PushConstants,
 };
 
 struct ShaderTableElement {
@@ -44,81 +22,144 @@ struct ShaderTableElement {
 	ShaderVarType type;
 	int location = -1;
 	int binding = -1;
+	VkVertexInputRate rate = VK_VERTEX_INPUT_RATE_VERTEX;
+	// block declarations (uniform and storage buffers, push constants) only.
+	std::string members;
+	bool readonly = false;
+	// uniform blocks bound with a dynamic offset.
+	bool dynamic = false;
+	// push constants only, the size of the matching c++ struct.
+	uint32_t size = 0;
 };
 
-struct CG_Node
-{ };
-//
-//struct FloatNode : public CG_Node {
-//	
-//	CG_Node output;
-//	
-//	float value;
-//};
-//
-//template<typename TNODE>
-//struct MultiplyNode : public CG_Node {
-//	
-//	TNODE input_a; // input a
-//	TNODE input_b; // input b 
-//
-//	TNODE output; // out put node
-//};
-
-/*
-* 
-*  A * B = C 
-* 
-	auto n1 = Shader.AddNode(FloatNode{4})
-	auto n2 = Shader.AddNode(FloatNode{8})
-	
-	auto mNode = Shader.AddNode(MultiplyNode<FloatNode>{})
-	
-	Shader.ConnectNodes(n1.output, mNode.input_a) 
-	Shader.ConnectNodes(n2.output, mNode.input_b) 
+enum class ShaderSwitchMode {
+	// one module for both values, the pipeline picks one when it is built. reads as a bool.
+	Specialization,
+	// one module per value, for what a constant can not switch: declarations, io, array sizes. reads as 0 or 1 in #if.
+	Define,
+};
+
+struct ShaderSwitch {
+	std::string name;
+	ShaderSwitchMode mode = ShaderSwitchMode::Specialization;
+	// specialization switches only.
+	uint32_t constantId = 0;
+};
+
+enum class ShaderOptimization {
+	None,
+	// inlining, dead code and constant propagation (spirv-opt -O).
+	Performance,
+	// the same kind of passes, picked for a small module (spirv-opt -Os).
+	Size,
+};
 
-*/
+// bit i turns on switch i, in the order the switches were added.
+using ShaderVariant = uint32_t;
 
+// the specialization constants of one variant, a VkBool32 per specialization switch.
+struct ShaderSpecialization {
+	SmallVector<VkSpecializationMapEntry, 8> entries;
+	SmallVector<VkBool32, 8> values;
+};
+
+using ShaderTableList = SmallVector<ShaderTableElement, 8>;
+using VertexAttributeList = SmallVector<VkVertexInputAttributeDescription, 8>;
+using VertexBindingList = SmallVector<VkVertexInputBindingDescription, 4>;
 
 class ShaderGraph {
 public:
+	// VK_NULL_HANDLE builds the SPIR-V without creating modules.
 	ShaderGraph(VkDevice device, const std::string& filepath, VkShaderStageFlagBits stage);
 
 	~ShaderGraph();
 	
 	void AddInput(int location, ShaderVarType type, const std::string& name, int binding);
+	// input that advances once per instance, every input sharing its binding has to be per instance too.
+	void AddInstanceInput(int location, ShaderVarType type, const std::string& name, int binding);
 	void AddOutput(int location, ShaderVarType type, const std::string& name);
-	void AddUniform(ShaderVarType type, const std::string& name);
+	// std140 block in set 0. dynamic blocks are bound at an offset handed out by a UniformRing.
+	void AddUniform(int binding, const std::string& name, const std::string& members, bool dynamic = true);
+	// std430 block in set 0, `members` is the glsl between the braces.
+	void AddStorageBuffer(int binding, const std::string& name, const std::string& members, bool readonly = false);
+	// small per draw data written straight into the command buffer, `size` is the c++ struct's.
+	void AddPushConstants(const std::string& name, const std::string& members, uint32_t size);
+	// compute shaders only.
+	void SetWorkgroupSize(uint32_t x, uint32_t y = 1, uint32_t z = 1);
 	
 	void AddMain(const std::string& fn);
 
-	void AddNode(CG_Node* node);
-	void ConnectNodes(CG_Node* left, CG_Node* right);
-
+	// a feature switch named `name` in the glsl, returns its bit in ShaderVariant.
+	// at most MaxDefineSwitches of them may be defines, each one doubles the modules.
+	ShaderVariant AddSwitch(const std::string& name, ShaderSwitchMode mode = ShaderSwitchMode::Specialization);
+	// compiled SPIR-V is looked up and stored there, nullptr compiles every time.
+	void LinkCache(ShaderCache* cache);
+	// passes run over the SPIR-V before the module is created, debug info is stripped outside debug builds.
+	// the cache keeps the optimized code.
+	void SetOptimization(ShaderOptimization optimization);
+
+	// code graph statements, emitted into main() after the AddMain() code.
+	NodeId AddNode(const CG_Node& node);
+	// feeds the result of `from` into input `slot` of `to`.
+	void ConnectNodes(NodeId from, NodeId to, uint32_t slot);
+
+	// builds the module of every combination of define switches, in parallel on the job workers.
 	bool Compile();
 
-	VkShaderModule Get();
-
-	std::vector<VkVertexInputAttributeDescription> GetAttributes();
+	// the module `variant` runs, specialization switches are applied by the pipeline.
+	VkShaderModule Get(ShaderVariant variant = 0) const;
+	VkShaderStageFlagBits GetStage() const;
+	// of the SPIR-V and the specialization values of `variant`, stable between runs. 0 before Compile().
+	uint64_t GetHash(ShaderVariant variant = 0) const;
+	ShaderSpecialization GetSpecialization(ShaderVariant variant) const;
+	uint32_t GetModuleCount() const;
+	// the define switch bits of `variant`, packed. the index of the module it runs.
+	uint32_t GetPermutation(ShaderVariant variant) const;
+	// compiler flags of a module, -DNAME=0 or -DNAME=1 per define switch.
+	std::string GetDefines(uint32_t permutation) const;
+
+	// attribute offsets are packed per binding, in the order the inputs were added.
+	VertexAttributeList GetAttributes() const;
+	VertexBindingList GetBindings() const;
+	// set 0 layout of the uniform and storage buffers, visible to this shader's stage.
+	DescriptorBindingList GetDescriptorBindings() const;
+	// 0 without a push constant block.
+	uint32_t GetPushConstantSize() const;
+	uint32_t GetWorkgroupSize() const;
+
+	static constexpr uint32_t MaxDefineSwitches = 8;
 
 private:
-	void GenerateShaderData();
+	// one combination of define switches.
+	struct Permutation {
+		// compiler flags, -DNAME=0 or -DNAME=1 per define switch.
+		std::string defines;
+		SpirvCode code;
+		uint64_t hash = 0;
+		VkShaderModule module = VK_NULL_HANDLE;
+	};
+
+	bool GenerateShaderData(std::string& source);
+
+	bool BuildPermutation(Permutation& permutation, const std::string& source, uint32_t index);
 
-	bool CreateModule();
-	bool LoadSPIRVByteCode();
-	bool ConvertSourceToSPIRV();
+	bool CreateModule(Permutation& permutation);
+	bool LoadSPIRVByteCode(const std::string& spvFilePath, SpirvCode& code);
+	bool ConvertSourceToSPIRV(const std::string& defines, const std::string& spvFilePath);
+	// empty when nothing is run.
+	std::string GetOptimizerFlags() const;
+	// replaces `code` only when spirv-opt succeeded.
+	bool OptimizeSPIRV(const std::string& spvFilePath, const std::string& flags, SpirvCode& code);
 
 
 private:
 	const std::string extension_GLSL = ".glsl";
 	const std::string extension_SPIRV = ".spv";
 
-	std::vector<CG_Node*> nodes;
-	std::unordered_map<CG_Node*, CG_Node*> edges;
-
+	CodeGraph graph;
 
 	// shader generation elements
-	std::unordered_map<ShaderTableGroup, std::vector<ShaderTableElement>> ioTable;
+	FlatHashMap<ShaderTableGroup, ShaderTableList> ioTable;
 
 	std::string directory;
 	std::string fileName;
@@ -126,10 +167,32 @@ private:
 	std::string func;
 
 	VkShaderStageFlagBits stage;
+	uint32_t workgroup[3] = { 1, 1, 1 };
 
-	std::vector<unsigned int> data;
+	SmallVector<ShaderSwitch, 8> switches;
+	std::vector<Permutation> permutations;
+	ShaderCache* cache = nullptr;
+	ShaderOptimization optimization = ShaderOptimization::Performance;
 
-	VkShaderModule shaderModule;
 	VkDevice device;
 
-};
\ No newline at end of file
+};
+
+// a shader a pipeline creates, named so it can also be built ahead of time.
+// `define` adds its inputs, outputs and code to an empty graph.
+struct ShaderDefinition {
+	const char* name;
+	VkShaderStageFlagBits stage;
+	void (*define)(ShaderGraph& shader);
+
+	// compiled from `directory`/`name`, warns and still returns the graph when that fails.
+	ShaderGraph* Create(VkDevice device, ShaderCache* cache, const std::string& directory = GetDirectory()) const;
+	// every definition into its graph, compiled side by side so their cache and file reads overlap. waits once for all of them.
+	static void CreateAll(VkDevice device, ShaderCache* cache, std::initializer_list<std::pair<const ShaderDefinition&, ShaderGraph*&>> shaders, const std::string& directory = GetDirectory());
+
+	// the file the generated glsl is written next to.
+	std::string GetPath(const std::string& directory = GetDirectory()) const;
+
+	// Shaders/ in the working directory, where the runtime keeps them.
+	static std::string GetDirectory();
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+
+enum class ShaderVarType {
+	// default single value
+	_BOOL_,
+	_INT_,
+	_UINT_,
+	_FLOAT_,
+	_DOUBLE_,
+	// boolean vectors 
+	_BVEC2_,
+	_BVEC3_,
+	_BVEC4_,
+	// integer vectors
+	_IVEC2_,
+	_IVEC3_,
+	_IVEC4_,
+	// double vectors
+	_DVEC2_,
+	_DVEC3_,
+	_DVEC4_,
+	// float vectors
+	_VEC2_,
+	_VEC3_,
+	_VEC4_,
+
+	// matricies
+	_MAT3x3_,
+	_MAT4x4_
+};
+
+std::string ShaderVarTypeToGLSLTypeString(ShaderVarType type);
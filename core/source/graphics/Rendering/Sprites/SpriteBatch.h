@@ -0,0 +1,89 @@
+#pragma once
+
+#include <datastructures/SlotMap.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class RenderPipeline;
+using PipelineHandle = Handle32<RenderPipeline>;
+
+// one textured, tinted quad.
+// positions are in clip space until there is a camera.
+struct Sprite {
+	float x = 0, y = 0;
+	float width = 1, height = 1;
+	float rotation = 0;
+
+	// rgba8, 0xAABBGGRR
+	uint32_t color = 0xFFFFFFFF;
+
+	// invalid handle: the batcher's default pipeline.
+	PipelineHandle pipeline;
+	uint32_t texture = 0;
+
+	// drawn back to front by layer, submission order within a layer.
+	uint16_t layer = 0;
+};
+
+// the quads of one frame, stored as structure of arrays.
+//
+// filled on the simulation thread and handed to the renderer in the
+// FramePacket. the sort only touches `keys` and vertex generation walks
+// every array linearly.
+class SpriteBatch {
+public:
+	void Add(const Sprite& sprite) {
+		x.push_back(sprite.x);
+		y.push_back(sprite.y);
+		width.push_back(sprite.width);
+		height.push_back(sprite.height);
+		rotation.push_back(sprite.rotation);
+		color.push_back(sprite.color);
+		pipeline.push_back(sprite.pipeline);
+		keys.push_back(MakeKey(sprite));
+	}
+
+	void Reserve(size_t count) {
+		x.reserve(count);
+		y.reserve(count);
+		width.reserve(count);
+		height.reserve(count);
+		rotation.reserve(count);
+		color.reserve(count);
+		pipeline.reserve(count);
+		keys.reserve(count);
+	}
+
+	void Clear() {
+		x.clear();
+		y.clear();
+		width.clear();
+		height.clear();
+		rotation.clear();
+		color.clear();
+		pipeline.clear();
+		keys.clear();
+	}
+
+	uint32_t Size() const { return (uint32_t)keys.size(); }
+	bool Empty() const { return keys.empty(); }
+
+	// layer:16 | pipeline slot + 1:20 | texture:28
+	// the slot is enough to tell live pipelines apart, 0 is "no pipeline".
+	static uint64_t MakeKey(const Sprite& sprite) {
+		uint64_t pipelineBits = sprite.pipeline.IsValid() ? (uint64_t)sprite.pipeline.Index() + 1 : 0;
+
+		return ((uint64_t)sprite.layer << 48)
+			| ((pipelineBits & 0xFFFFF) << 28)
+			| ((uint64_t)sprite.texture & 0xFFFFFFF);
+	}
+
+	std::vector<float> x, y;
+	std::vector<float> width, height;
+	std::vector<float> rotation;
+	std::vector<uint32_t> color;
+	std::vector<PipelineHandle> pipeline;
+	std::vector<uint64_t> keys;
+};
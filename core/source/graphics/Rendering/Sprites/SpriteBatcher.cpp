@@ -0,0 +1,232 @@
+#include "SpriteBatcher.h"
+
+#include "graphics/Rendering/Pipelines/RenderPipelines.h"
+#include "graphics/UploadEngine.h"
+
+#include <jobs/JobSystem.h>
+#include <debug/Console.h>
+
+#include <algorithm>
+
+using RenderPipelines::Instance;
+
+namespace {
+	// sprites per job while writing instances.
+	constexpr uint32_t InstanceGrain = 4096;
+
+	// unit quad, scaled to the sprite by its instance.
+	const float QuadPositions[4][3] = { { -0.5f, -0.5f, 0.0f }, { 0.5f, -0.5f, 0.0f }, { -0.5f, 0.5f, 0.0f }, { 0.5f, 0.5f, 0.0f } };
+	const uint16_t QuadIndices[6] = { 0, 1, 2, 2, 1, 3 };
+}
+
+SpriteBatcher::SpriteBatcher(VkDevice device, VkPhysicalDevice physicalDevice, UploadEngine* uploadEngine, const VulkanAPI::DeviceFeatures& features, uint32_t maxSprites)
+	: device{ device }, physicalDevice{ physicalDevice }, features{ features }, maxSprites{ maxSprites }
+{
+	vertices = std::make_unique<Buffer>(device, physicalDevice, sizeof(QuadPositions), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, BufferMemory::Static);
+	indices = std::make_unique<Buffer>(device, physicalDevice, sizeof(QuadIndices), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, BufferMemory::Static);
+
+	vertices->Upload(uploadEngine, QuadPositions, sizeof(QuadPositions));
+	indices->Upload(uploadEngine, QuadIndices, sizeof(QuadIndices));
+
+	// storage as well, the cull pass reads it.
+	instances = std::make_unique<Buffer>(device, physicalDevice, (VkDeviceSize)maxSprites * sizeof(Instance), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, BufferMemory::Dynamic);
+
+	// worst case every sprite is its own draw.
+	commands = std::make_unique<IndirectDrawBuffer>(device, physicalDevice, maxSprites, BufferMemory::Dynamic, features);
+}
+
+void SpriteBatcher::SetDefaultPipeline(PipelineHandle pipeline)
+{
+	defaultPipeline = pipeline;
+}
+
+void SpriteBatcher::EnableCulling(ComputePipelines::FrustumCull* cull, CommandManager* commandManager)
+{
+	// culled draws start wherever their run starts in the instance buffer.
+	if (!features.drawIndirectFirstInstance)
+	{
+		Console::Warn("Sprite Culling Needs drawIndirectFirstInstance, Drawing Every Sprite.");
+		return;
+	}
+
+	this->cull = cull;
+	this->commandManager = commandManager;
+
+	drawIndices = std::make_unique<Buffer>(device, physicalDevice, (VkDeviceSize)maxSprites * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, BufferMemory::Dynamic);
+	visible = std::make_unique<Buffer>(device, physicalDevice, (VkDeviceSize)maxSprites * sizeof(Instance), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, BufferMemory::Dynamic);
+}
+
+bool SpriteBatcher::IsCulling()
+{
+	return cull != nullptr;
+}
+
+void SpriteBatcher::Prepare(uint32_t frame, const SpriteBatch& batch)
+{
+	this->frame = frame;
+	draws.clear();
+	indirect.clear();
+
+	spriteCount = batch.Size();
+	if (spriteCount > maxSprites)
+	{
+		Console::Warn("Sprite Batch Overflow, Dropping ", spriteCount - maxSprites, " Sprites.");
+		spriteCount = maxSprites;
+	}
+
+	if (spriteCount == 0)
+	{
+		commands->Write(frame, nullptr, 0);
+		return;
+	}
+
+	RadixSortIndices(batch.keys.data(), spriteCount, order, scratch);
+
+	// INSTANCES
+	// sorted position i is instance i.
+	Instance* out = static_cast<Instance*>(instances->Map(frame));
+
+	Jobs::ParallelFor(spriteCount, InstanceGrain, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++)
+		{
+			uint32_t s = order[i];
+			uint32_t rgba = batch.color[s];
+
+			Instance& instance = out[i];
+			instance.Offset.x = batch.x[s];
+			instance.Offset.y = batch.y[s];
+			instance.Scale.x = batch.width[s];
+			instance.Scale.y = batch.height[s];
+			instance.Rotation = batch.rotation[s];
+			instance.Color.r = (float)((rgba >> 0) & 0xFF) / 255.0f;
+			instance.Color.g = (float)((rgba >> 8) & 0xFF) / 255.0f;
+			instance.Color.b = (float)((rgba >> 16) & 0xFF) / 255.0f;
+			instance.Color.a = (float)((rgba >> 24) & 0xFF) / 255.0f;
+		}
+	});
+
+	// DRAWS
+	// a run of identical keys shares pipeline and texture, the layer only orders runs.
+	uint32_t first = 0;
+	for (uint32_t i = 1; i <= spriteCount; i++)
+	{
+		if (i < spriteCount && batch.keys[order[i]] == batch.keys[order[first]])
+			continue;
+
+		uint32_t s = order[first];
+		PipelineHandle pipeline = batch.pipeline[s].IsValid() ? batch.pipeline[s] : defaultPipeline;
+		uint32_t texture = (uint32_t)(batch.keys[s] & 0xFFFFFFF);
+
+		// neighbouring runs that only differ by layer still share state, keep them in one draw.
+		// culled draws are compacted out of order, there every layer keeps its own draw.
+		if (!cull && !draws.empty() && draws.back().pipeline == pipeline && draws.back().texture == texture)
+			draws.back().spriteCount += i - first;
+		else
+			draws.push_back({ pipeline, texture, first, i - first });
+
+		first = i;
+	}
+
+	for (const Draw& draw : draws)
+	{
+		indirect.push_back({
+			.indexCount = 6,
+			// counted up by the cull pass.
+			.instanceCount = cull ? 0 : draw.spriteCount,
+			.firstIndex = 0,
+			.vertexOffset = 0,
+			.firstInstance = draw.firstSprite,
+		});
+	}
+
+	commands->Write(frame, indirect.data(), (uint32_t)indirect.size());
+
+	if (cull)
+	{
+		uint32_t* drawIndex = static_cast<uint32_t*>(drawIndices->Map(frame));
+
+		for (uint32_t d = 0; d < (uint32_t)draws.size(); d++)
+			std::fill_n(drawIndex + draws[d].firstSprite, draws[d].spriteCount, d);
+	}
+}
+
+void SpriteBatcher::Cull(VkCommandBuffer cmd, DescriptorAllocator& descriptors, const ComputePipelines::Frustum& frustum)
+{
+	if (!cull || draws.empty())
+		return;
+
+	Buffer* commandBuffer = commands->GetCommands();
+
+	cull->BindBuffer(0, instances->Get(), instances->GetOffset(frame), instances->GetSize());
+	cull->BindBuffer(1, drawIndices->Get(), drawIndices->GetOffset(frame), drawIndices->GetSize());
+	cull->BindBuffer(2, visible->Get(), visible->GetOffset(frame), visible->GetSize());
+	cull->BindBuffer(3, commandBuffer->Get(), commandBuffer->GetOffset(frame), commandBuffer->GetSize());
+
+	ComputePipelines::FrustumCull::Constants constants
+	{
+		.frustum = frustum,
+		.count = spriteCount,
+	};
+
+	cull->Dispatch(cmd, descriptors, spriteCount, &constants, sizeof(constants));
+
+	// the draws read both through the graphics queue.
+	commandManager->ReleaseBuffer(cmd, VulkanAPI::CommandType::Compute, VulkanAPI::CommandType::Graphics,
+		visible->Get(), visible->GetOffset(frame), visible->GetSize(),
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+
+	commandManager->ReleaseBuffer(cmd, VulkanAPI::CommandType::Compute, VulkanAPI::CommandType::Graphics,
+		commandBuffer->Get(), commandBuffer->GetOffset(frame), commandBuffer->GetSize(),
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+}
+
+void SpriteBatcher::Record(VkCommandBuffer cmd, const PipelineTable& pipelines)
+{
+	if (draws.empty())
+		return;
+
+	// culled draws read the compacted copy, every draw's range in it matches the one in `instances`.
+	Buffer* instanceBuffer = cull ? visible.get() : instances.get();
+
+	VkBuffer vertexBuffers[] = { vertices->Get(), instanceBuffer->Get() };
+	VkDeviceSize offsets[] = { 0, instanceBuffer->GetOffset(frame) };
+
+	vkCmdBindVertexBuffers(cmd, 0, 2, vertexBuffers, offsets);
+	vkCmdBindIndexBuffer(cmd, indices->Get(), 0, VK_INDEX_TYPE_UINT16);
+
+	// one indirect call per pipeline change, textures are batched on but not bound yet.
+	uint32_t first = 0;
+	for (uint32_t i = 1; i <= (uint32_t)draws.size(); i++)
+	{
+		if (i < draws.size() && draws[i].pipeline == draws[first].pipeline)
+			continue;
+
+		// still compiling without a fallback, the range is skipped this frame.
+		const auto* pipeline = pipelines.get(draws[first].pipeline);
+		VkPipeline bound = pipeline ? (*pipeline)->Get() : VK_NULL_HANDLE;
+		if (bound)
+		{
+			vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, bound);
+			(*pipeline)->BindRasterState(cmd);
+
+			commands->Record(cmd, frame, first, i - first);
+		}
+
+		first = i;
+	}
+}
+
+uint32_t SpriteBatcher::GetSpriteCount()
+{
+	return spriteCount;
+}
+
+uint32_t SpriteBatcher::GetDrawCount()
+{
+	return (uint32_t)draws.size();
+}
+
+uint32_t SpriteBatcher::GetMaxSprites()
+{
+	return maxSprites;
+}
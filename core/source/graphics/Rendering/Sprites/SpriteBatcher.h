@@ -0,0 +1,89 @@
+#pragma once
+
+#include <graphics/gfx_pch.h>
+#include <graphics/Buffers/Buffer.h>
+#include <graphics/Buffers/IndirectDrawBuffer.h>
+#include <graphics/Rendering/Pipelines/RenderPipeline.h>
+#include <graphics/Rendering/Pipelines/ComputePipelines.h>
+
+#include "SpriteBatch.h"
+
+#include <memory>
+
+class UploadEngine;
+
+// turns a frame's SpriteBatch into as few draw calls as possible.
+//
+// Prepare() radix sorts the sprites by (layer, pipeline, texture), writes one
+// RenderPipelines::Instance per sprite into the frame's region of a
+// persistently mapped buffer across the job workers, and collapses runs of
+// equal keys into one indirect command each.
+// Record() then only binds and draws, it can run inside a secondary buffer.
+//
+// sprite pipelines take the Instanced2D vertex layout.
+//
+// with culling enabled the indirect commands leave Prepare() empty and the
+// FrustumCull pass fills them on the compute queue, the draws then read the
+// compacted instances it wrote.
+class SpriteBatcher {
+public:
+	SpriteBatcher(VkDevice device, VkPhysicalDevice physicalDevice, UploadEngine* uploadEngine, const VulkanAPI::DeviceFeatures& features, uint32_t maxSprites = 1 << 17);
+
+	// used by sprites submitted without a pipeline.
+	void SetDefaultPipeline(PipelineHandle pipeline);
+
+	// ignored on devices without drawIndirectFirstInstance.
+	void EnableCulling(ComputePipelines::FrustumCull* cull, CommandManager* commandManager);
+	bool IsCulling();
+
+	void Prepare(uint32_t frame, const SpriteBatch& batch);
+
+	// compute queue, after Prepare(). the pass's set comes from `descriptors`. hands the culled
+	// buffers over to the graphics queue, the graphics submission picks them up through
+	// CommandManager::AcquireOwnership().
+	void Cull(VkCommandBuffer cmd, DescriptorAllocator& descriptors, const ComputePipelines::Frustum& frustum);
+
+	void Record(VkCommandBuffer cmd, const PipelineTable& pipelines);
+
+	uint32_t GetSpriteCount();
+	uint32_t GetDrawCount();
+	uint32_t GetMaxSprites();
+
+private:
+	struct Draw {
+		PipelineHandle pipeline;
+		uint32_t texture;
+		uint32_t firstSprite;
+		uint32_t spriteCount;
+	};
+
+	VkDevice device;
+	VkPhysicalDevice physicalDevice;
+	VulkanAPI::DeviceFeatures features;
+	uint32_t maxSprites;
+	PipelineHandle defaultPipeline;
+
+	// one unit quad, never changes.
+	std::unique_ptr<Buffer> vertices;
+	std::unique_ptr<Buffer> indices;
+
+	std::unique_ptr<Buffer> instances;
+	// one command per Draw, in the same order.
+	std::unique_ptr<IndirectDrawBuffer> commands;
+
+	// CULLING
+	ComputePipelines::FrustumCull* cull = nullptr;
+	CommandManager* commandManager = nullptr;
+	// index of the draw every sorted instance belongs to.
+	std::unique_ptr<Buffer> drawIndices;
+	// visible instances, each draw keeps the range it has in `instances`.
+	std::unique_ptr<Buffer> visible;
+
+	uint32_t frame = 0;
+	uint32_t spriteCount = 0;
+
+	std::vector<uint32_t> order;
+	std::vector<uint32_t> scratch;
+	std::vector<Draw> draws;
+	std::vector<VkDrawIndexedIndirectCommand> indirect;
+};
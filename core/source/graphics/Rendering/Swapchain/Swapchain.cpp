@@ -1,7 +1,7 @@
 #include "Swapchain.h"
 
-Swapchain::Swapchain(VkDevice device, VkPhysicalDevice physicalDevice, GLFWwindow*	window, VkSurfaceKHR surface, VulkanAPI::QueueFamily queueFamily, Resolution resolution, uint32_t images)
-	: device{ device }, physicalDevice{ physicalDevice }, window{window}, surface { surface }, swapchain{ VK_NULL_HANDLE }, image_count{ images }, resolution{ resolution}, queueFamily{ queueFamily }
+Swapchain::Swapchain(VkDevice device, VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, VulkanAPI::QueueFamily queueFamily, Resolution resolution, uint32_t images)
+	: device{ device }, physicalDevice{ physicalDevice }, surface { surface }, swapchain{ VK_NULL_HANDLE }, image_count{ images }, resolution{ resolution}, queueFamily{ queueFamily }
 {
 	Create();
 }
@@ -19,6 +19,7 @@ void Swapchain::Create()
 	VkSurfaceFormatKHR format = SelectFormat(VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR);
 	VkPresentModeKHR presentMode = SelectPresentMode(VK_PRESENT_MODE_FIFO_KHR);
 	VkExtent2D imageExtent = SelectExtent(supportDetails.capabillities);
+	extent = imageExtent;
 
 	image_count = std::clamp(image_count, supportDetails.capabillities.minImageCount + 1, supportDetails.capabillities.maxImageCount);
 
@@ -76,6 +77,11 @@ VkImage Swapchain::GetImage(int idx)
 	return swapchainImages[idx];
 }
 
+VkExtent2D Swapchain::GetExtent()
+{
+	return extent;
+}
+
 SwapchainSupportDetails Swapchain::GetSupportDetails()
 {
 	SwapchainSupportDetails details;
@@ -134,11 +140,9 @@ VkExtent2D Swapchain::SelectExtent(const VkSurfaceCapabilitiesKHR& capabillities
 	if (capabillities.currentExtent.width != std::numeric_limits<uint32_t>::max())
 		return capabillities.currentExtent;
 	else {
-		int width, height;
-		glfwGetFramebufferSize(window, &width, &height);
-
-		extent.width = static_cast<uint32_t>(width);
-		extent.height = static_cast<uint32_t>(height);
+		// the size the main thread published, glfw may only be asked there.
+		extent.width = resolution.width;
+		extent.height = resolution.height;
 	}
 
 	extent.width = std::clamp(extent.width, capabillities.minImageExtent.width, capabillities.maxImageExtent.width);
@@ -14,7 +14,8 @@ struct SwapchainSupportDetails {
 class Swapchain {
 
 public:
-	Swapchain(VkDevice device, VkPhysicalDevice physicalDevice, struct GLFWwindow* window, VkSurfaceKHR surface, VulkanAPI::QueueFamily queueFamily, Resolution resolution, uint32_t images = 3);
+	// `resolution` is the framebuffer size the window reported, the extent when the surface leaves it to the swapchain.
+	Swapchain(VkDevice device, VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, VulkanAPI::QueueFamily queueFamily, Resolution resolution, uint32_t images = 3);
 	~Swapchain();
 
 	void Create();
@@ -23,6 +24,7 @@ public:
 
 	VkSwapchainKHR Get();
 	VkImage GetImage(int idx);
+	VkExtent2D GetExtent();
 
 private:
 	SwapchainSupportDetails GetSupportDetails();
@@ -39,6 +41,7 @@ private:
 
 	VkSurfaceKHR surface;
 	Resolution resolution;
+	VkExtent2D extent;
 
 	uint32_t image_count;
 
@@ -46,5 +49,4 @@ private:
 
 	VkDevice device;
 	VkPhysicalDevice physicalDevice;
-	struct GLFWwindow* window;
 };
\ No newline at end of file
@@ -3,23 +3,45 @@
 #define T_RENDER_PIPELINE
 
 #include "Graphics/Rendering/Pipelines/RenderPipeline.h"
+#include "Graphics/Rendering/Pipelines/ComputePipeline.h"
 #include "RenderPipelineUtils.h"
 
 namespace RenderPipelineFactory {
 	template<typename T>
-	static RenderPipeline* Create(VkDevice device, uint32_t width, uint32_t height) {
-		auto pPipeline = Utils::Create<T>(device);
+	static RenderPipeline* Create(VkDevice device, DescriptorLayoutCache* layouts, PipelineRegistry* registry, ShaderCache* shaders, const VulkanAPI::DeviceFeatures& features, uint32_t width, uint32_t height) {
+		auto pPipeline = Utils::Create<T>(device, layouts, registry, shaders, features);
 		pPipeline->Initillize(width, height);
 		return pPipeline;
 	}
 
 	template<typename T>
-	static RenderPipeline* Create(VkDevice device, Resolution resolution) {
-		return Create<T>(device, resolution.width, resolution.height);
+	static RenderPipeline* Create(VkDevice device, DescriptorLayoutCache* layouts, PipelineRegistry* registry, ShaderCache* shaders, const VulkanAPI::DeviceFeatures& features, Resolution resolution) {
+		return Create<T>(device, layouts, registry, shaders, features, resolution.width, resolution.height);
+	}
+
+	// returns before the pipeline is compiled, `fallback` is drawn with until it is.
+	template<typename T>
+	static RenderPipeline* CreateAsync(VkDevice device, DescriptorLayoutCache* layouts, PipelineRegistry* registry, ShaderCache* shaders, const VulkanAPI::DeviceFeatures& features, Resolution resolution, RenderPipeline* fallback = nullptr) {
+		auto pPipeline = Utils::Create<T>(device, layouts, registry, shaders, features);
+		pPipeline->CompileAsync(fallback);
+		pPipeline->Initillize(resolution.width, resolution.height);
+		return pPipeline;
 	}
 
 	static void Destroy(RenderPipeline* pPipeline) {
 		pPipeline->Cleanup();
 		delete pPipeline;
 	}
+
+	template<typename T>
+	static ComputePipeline* CreateCompute(VkDevice device, DescriptorLayoutCache* layouts, ShaderCache* shaders) {
+		auto pPipeline = Utils::CreateCompute<T>(device, layouts, shaders);
+		pPipeline->Initillize();
+		return pPipeline;
+	}
+
+	static void Destroy(ComputePipeline* pPipeline) {
+		pPipeline->Cleanup();
+		delete pPipeline;
+	}
 }
\ No newline at end of file
@@ -3,16 +3,31 @@
 namespace Utils {
 
 	template<typename T>
-	static RenderPipeline* Create(VkDevice device) {
+	static RenderPipeline* Create(VkDevice device, DescriptorLayoutCache* layouts, PipelineRegistry* registry, ShaderCache* shaders, const VulkanAPI::DeviceFeatures& features) {
 		static_assert(std::is_base_of<RenderPipeline, T>::value, "T Is Not a RenderPipeline!");
 
 		auto _ptr = new T();
 
 		auto _pipeline = reinterpret_cast<RenderPipeline*>(_ptr);
 		_pipeline->LinkDevice(device);
+		_pipeline->LinkLayoutCache(layouts);
+		_pipeline->LinkRegistry(registry);
+		_pipeline->LinkShaderCache(shaders);
+		_pipeline->LinkFeatures(features);
 
 		return _ptr;
 	}
 
+	template<typename T>
+	static ComputePipeline* CreateCompute(VkDevice device, DescriptorLayoutCache* layouts, ShaderCache* shaders) {
+		static_assert(std::is_base_of<ComputePipeline, T>::value, "T Is Not a ComputePipeline!");
+
+		auto _ptr = new T();
+		_ptr->LinkDevice(device);
+		_ptr->LinkLayoutCache(layouts);
+		_ptr->LinkShaderCache(shaders);
+
+		return _ptr;
+	}
 
 }
@@ -3,12 +3,24 @@
 
 #include "Graphics/Rendering/Utils/RenderPipelineFactory.h"
 #include "graphics/Rendering/Pipelines/RenderPipelines.h"
+#include "graphics/Rendering/Pipelines/ComputePipelines.h"
+#include "graphics/Rendering/Pipelines/PipelineRegistry.h"
 #include "Graphics/Rendering/Shaders/ShaderGraph.h"
+#include "graphics/Rendering/Shaders/ShaderCache.h"
 #include "graphics/Rendering/Framebuffers/Framebuffer.h"
 #include "graphics/Rendering/Swapchain/Swapchain.h"
 #include "graphics/CommandManager.h"
+#include "graphics/UploadEngine.h"
+#include "graphics/GpuTimer.h"
+#include "graphics/Buffers/Buffer.h"
+#include "graphics/Buffers/UniformRing.h"
+#include "graphics/Rendering/Sprites/SpriteBatcher.h"
+#include "graphics/Descriptors/DescriptorLayoutCache.h"
+#include "graphics/Descriptors/DescriptorAllocator.h"
+#include "graphics/Descriptors/BindlessTable.h"
 
 #include <filesystem>
+#include <memory>
 #include <debug/Console.h>
 
 
@@ -19,18 +31,64 @@ namespace vk
 	VkDevice Device = { VK_NULL_HANDLE };
 
 	VulkanAPI::QueueFamily QueueFamily;
+	VulkanAPI::DeviceFeatures Features;
 
 	CommandManager* commandManager;
-	Framebuffer* framebuffer;
-	Swapchain* swapchain;
+	UploadEngine* uploadEngine;
+	std::unique_ptr<Swapchain> swapchain;
 
-	VulkanAPI::FenceBlock Fences;
-	VulkanAPI::SemaphoreBlock Semaphores;
+	SlotMap<std::unique_ptr<Framebuffer>, FramebufferHandle> framebuffers;
+	FramebufferHandle mainFramebuffer;
+
+	// per frame slot, a slot's semaphores are free again once CommandManager::BeginFrame waited on it.
+	std::array<VulkanAPI::SemaphoreBlock, CommandManager::FramesInFlight> Semaphores;
+	// frame slot the acquired image was rendered in.
+	uint32_t PresentSlot = 0;
+
+	// gpu time of the scene, what the internal resolution is scaled by.
+	std::unique_ptr<GpuTimer> gpuTimer;
+	DynamicResolution dynamicResolution;
+	// the part of the framebuffer the scene is rendered into, blitted up to the swapchain.
+	Resolution InternalResolution{ 0, 0 };
 
 	VkSurfaceKHR Surface;
 	uint32_t CurrentFrameIndex = 0;
+	uint64_t FrameNumber = 0;
+
+	// written by the glfw callback on the main thread, consumed before the next frame is recorded.
+	// bit 63 marks a pending resize, width in bits 32..62 and height in the low 32 bits.
+	std::atomic<uint64_t> PendingResize{ 0 };
+	// last framebuffer size the window reported, packed like PendingResize without bit 63.
+	std::atomic<uint64_t> WindowSize{ 0 };
+
+	std::unique_ptr<DescriptorLayoutCache> descriptorLayouts;
+	std::unique_ptr<DescriptorAllocator> descriptorAllocator;
+	// only on devices with descriptor indexing.
+	std::unique_ptr<BindlessTable> bindless;
+
+	// every graphics pipeline is built through it, equal state is compiled once.
+	std::unique_ptr<PipelineRegistry> pipelineRegistry;
+	std::unique_ptr<ShaderCache> shaderCache;
+
+	PipelineTable renderPipelines;
+	PipelineHandle basic2D;
+	PipelineHandle instanced2D;
 
-	std::unordered_map<std::string, RenderPipeline*> renderPipelines;
+	ComputePipelineTable computePipelines;
+	ComputePipelineHandle frustumCull;
+
+	SlotMap<std::unique_ptr<Buffer>, BufferHandle> buffers;
+	BufferHandle quadVertexBuffer;
+	BufferHandle quadIndexBuffer;
+	BufferHandle dynamicVertexBuffer;
+
+	// per draw and per frame constants, rewound every frame.
+	std::unique_ptr<UniformRing> uniforms;
+
+	std::unique_ptr<SpriteBatcher> spriteBatcher;
+
+	// set by RenderFrame once it owns a swapchain image, PresentFrame only presents when it does.
+	bool ImageAcquired = false;
 
 	std::vector<std::string> layers = {};
 	std::vector<std::string> instance_extensions = {};
@@ -40,21 +98,20 @@ namespace vk
 
 #include <array>
 
-#pragma pack(push, 4)
-struct SQVertex {
-	float POS[3];
-	float UV[2];
-};
-#pragma pack(pop)
-
-constexpr std::array<SQVertex, 4> screenQuadVertices = {
-	// Positions          // Texture coordinates
-	SQVertex{-1.0f, -1.0f, 0.0f,  0.0f, 0.0f,},
-	SQVertex{ 1.0f, -1.0f, 0.0f,  1.0f, 0.0f,},
-	SQVertex{-1.0f,  1.0f, 0.0f,  0.0f, 1.0f,},
-	SQVertex{ 1.0f,  1.0f, 0.0f,  1.0f, 1.0f }
+#include <cmath>
+
+using RenderPipelines::Vertex;
+
+constexpr std::array<Vertex, 4> quadVertices = {
+	// Positions              // Colors
+	Vertex{ {-0.5f, -0.5f, 0.0f}, {0.20f, 0.40f, 0.80f, 1.0f} },
+	Vertex{ { 0.5f, -0.5f, 0.0f}, {0.20f, 0.80f, 0.40f, 1.0f} },
+	Vertex{ {-0.5f,  0.5f, 0.0f}, {0.80f, 0.40f, 0.20f, 1.0f} },
+	Vertex{ { 0.5f,  0.5f, 0.0f}, {0.80f, 0.80f, 0.20f, 1.0f} },
 };
 
+constexpr std::array<uint16_t, 6> quadIndices = { 0, 1, 2, 2, 1, 3 };
+
 
 
 #define PIPELINE_STR(pipe) #pipe
@@ -66,7 +123,7 @@ Renderer::Renderer() : window{nullptr}
 
 Renderer::~Renderer()
 {
-
+	StopRenderThread();
 }
 
 bool Renderer::Initilize(GLFWwindow* window)
@@ -78,6 +135,7 @@ bool Renderer::Initilize(GLFWwindow* window)
 	Resolution resoulution;
 	resoulution.width = static_cast<uint32_t>(width);
 	resoulution.height = static_cast<uint32_t>(height);
+	vk::WindowSize.store(PackSize(resoulution.width, resoulution.height), std::memory_order_release);
 
 	GetRequiredInfo();
 
@@ -90,18 +148,68 @@ bool Renderer::Initilize(GLFWwindow* window)
 	// Create Device
 	vk::QueueFamily = VulkanAPI::ReserveQueueFamily(vk::PhysicalDevice, vk::Surface);
 	vk::Device = VulkanAPI::CreateDevice(vk::Instance, vk::PhysicalDevice, vk::layers, vk::device_extensions, vk::QueueFamily);
+	vk::Features = VulkanAPI::QueryDeviceFeatures(vk::PhysicalDevice);
+
+	// queue submissions and uploads signal timeline semaphores, there is no binary fallback.
+	if (!vk::Features.timelineSemaphore)
+	{
+		Console::Error("Device Lacks Timeline Semaphores (Vulkan 1.2), Required By The Command Queues And The Upload Engine.");
+		return false;
+	}
 
-	vk::Fences = VulkanAPI::CreateFenceBlock(vk::Device);
-	vk::Semaphores = VulkanAPI::CreateSemaphoreBlock(vk::Device);
+	for (auto& semaphores : vk::Semaphores)
+		semaphores = VulkanAPI::CreateSemaphoreBlock(vk::Device);
 
 	vk::commandManager = new CommandManager(vk::Device, vk::QueueFamily);
+	vk::uploadEngine = new UploadEngine(vk::Device, vk::PhysicalDevice, vk::commandManager);
+	vk::gpuTimer = std::make_unique<GpuTimer>(vk::Device, vk::PhysicalDevice, vk::QueueFamily.graphics.value());
+
+	if (!vk::gpuTimer->IsSupported())
+		Console::Warn("GPU Timestamps Unavailable, Rendering At Full Resolution.");
+
+	vk::descriptorLayouts = std::make_unique<DescriptorLayoutCache>(vk::Device);
+	vk::descriptorAllocator = std::make_unique<DescriptorAllocator>(vk::Device);
+
+	vk::bindless = std::make_unique<BindlessTable>(vk::Device, vk::PhysicalDevice, vk::descriptorLayouts.get(), vk::Features);
+	if (!vk::bindless->IsSupported())
+		vk::bindless.reset();
+
+	vk::pipelineRegistry = std::make_unique<PipelineRegistry>(vk::Device, vk::Features);
+	// unchanged shaders skip the compiler, across runs too.
+	vk::shaderCache = std::make_unique<ShaderCache>((std::filesystem::current_path() / "Shaders" / "cache").generic_string());
+
+	// written by the ShaderCooker, shaders it holds are never compiled here.
+	auto shaderArchive = std::filesystem::current_path() / "Shaders" / "shaders.pak";
+	if (vk::shaderCache->LoadArchive(shaderArchive.generic_string()))
+		Console::Log("Shader Archive Mapped: ", shaderArchive);
+	else
+		Console::Log("No Shader Archive, Compiling Shaders At Startup: ", shaderArchive);
 
-	vk::swapchain = new Swapchain(vk::Device, vk::PhysicalDevice, window, vk::Surface, vk::QueueFamily, resoulution, 3);
+	vk::swapchain = std::make_unique<Swapchain>(vk::Device, vk::PhysicalDevice, vk::Surface, vk::QueueFamily, resoulution, 3);
 
-	vk::framebuffer = new Framebuffer(vk::Device, resoulution, vk::QueueFamily);
+	vk::mainFramebuffer = vk::framebuffers.insert(std::make_unique<Framebuffer>(vk::Device, vk::PhysicalDevice, resoulution, vk::QueueFamily));
 
-	//vk::renderPipelines.emplace(RenderPipelines::ScreenRenderPass, RenderPipelineFactory::Create<RenderPipelines::Basic2D>(vk::Device, resoulution));
-	vk::renderPipelines.emplace("Basic2D", RenderPipelineFactory::Create<RenderPipelines::Basic2D>(vk::Device, resoulution));
+	vk::basic2D = vk::renderPipelines.insert(std::unique_ptr<RenderPipeline>(RenderPipelineFactory::Create<RenderPipelines::Basic2D>(vk::Device, vk::descriptorLayouts.get(), vk::pipelineRegistry.get(), vk::shaderCache.get(), vk::Features, resoulution)));
+	// sprites are left out for the first frames instead of stalling startup on the compile.
+	vk::instanced2D = vk::renderPipelines.insert(std::unique_ptr<RenderPipeline>(RenderPipelineFactory::CreateAsync<RenderPipelines::Instanced2D>(vk::Device, vk::descriptorLayouts.get(), vk::pipelineRegistry.get(), vk::shaderCache.get(), vk::Features, resoulution)));
+
+	// static geometry goes through the staging ring once, the first frame acquires it.
+	vk::quadVertexBuffer = vk::buffers.insert(std::make_unique<Buffer>(vk::Device, vk::PhysicalDevice, sizeof(quadVertices), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, BufferMemory::Static));
+	vk::quadIndexBuffer = vk::buffers.insert(std::make_unique<Buffer>(vk::Device, vk::PhysicalDevice, sizeof(quadIndices), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, BufferMemory::Static));
+
+	vk::buffers[vk::quadVertexBuffer]->Upload(vk::uploadEngine, quadVertices.data(), sizeof(quadVertices));
+	vk::buffers[vk::quadIndexBuffer]->Upload(vk::uploadEngine, quadIndices.data(), sizeof(quadIndices));
+
+	// rewritten every frame.
+	vk::dynamicVertexBuffer = vk::buffers.insert(std::make_unique<Buffer>(vk::Device, vk::PhysicalDevice, sizeof(quadVertices), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, BufferMemory::Dynamic));
+
+	vk::uniforms = std::make_unique<UniformRing>(vk::Device, vk::PhysicalDevice);
+
+	vk::spriteBatcher = std::make_unique<SpriteBatcher>(vk::Device, vk::PhysicalDevice, vk::uploadEngine, vk::Features);
+	vk::spriteBatcher->SetDefaultPipeline(vk::instanced2D);
+
+	vk::frustumCull = vk::computePipelines.insert(std::unique_ptr<ComputePipeline>(RenderPipelineFactory::CreateCompute<ComputePipelines::FrustumCull>(vk::Device, vk::descriptorLayouts.get(), vk::shaderCache.get())));
+	vk::spriteBatcher->EnableCulling(static_cast<ComputePipelines::FrustumCull*>(vk::computePipelines[vk::frustumCull].get()), vk::commandManager);
 		
 
 	// bind to the window a resizing event
@@ -128,35 +236,218 @@ struct Color {
 	float a;
 };
 
-void Renderer::RenderFrame() {
+namespace {
+	uint64_t PackSize(uint32_t width, uint32_t height)
+	{
+		return ((uint64_t)(width & 0x7FFFFFFF) << 32) | height;
+	}
+
+	// acquire or present said the swapchain no longer matches the surface, without a
+	// resize event from the window. rebuilt at the start of the next frame, a resize
+	// the window already queued wins.
+	void RequestSwapchainRebuild()
+	{
+		uint64_t size = vk::WindowSize.load(std::memory_order_acquire);
+
+		// the render thread may not ask glfw, the surface knows its size on most platforms.
+		VkSurfaceCapabilitiesKHR capabilities;
+		if (vkGetPhysicalDeviceSurfaceCapabilitiesKHR(vk::PhysicalDevice, vk::Surface, &capabilities) == VK_SUCCESS && capabilities.currentExtent.width != UINT32_MAX)
+			size = PackSize(capabilities.currentExtent.width, capabilities.currentExtent.height);
 
-	VkCommandBuffer cmd = vk::commandManager->BeginSingleTimeCommand(CommandType::Graphics);
+		uint64_t none = 0;
+		vk::PendingResize.compare_exchange_strong(none, (1ull << 63) | size, std::memory_order_acq_rel);
+	}
+}
 
-	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, vk::renderPipelines["Basic2D"]->Get());
+void Renderer::RenderFrame(const FramePacket& packet) {
 
-	VkClearValue clearValues[2];
-	clearValues[0].color = { {0.1f, 0.1f, 0.1f, 0} }; // Start color of the gradient
+	ApplyPendingResize();
+
+	// waits until the gpu is done with the slot's previous frame, then recycles its pools.
+	vk::commandManager->BeginFrame(static_cast<uint32_t>(vk::FrameNumber++));
+	uint32_t frame = vk::commandManager->GetCurrentFrame();
+
+	// the slot's sets and retired bindless slots are no longer read by the gpu either.
+	vk::descriptorAllocator->BeginFrame(frame);
+	if (vk::bindless)
+		vk::bindless->BeginFrame(frame);
+	vk::uniforms->BeginFrame(frame);
+
+	// the slot's previous frame has completed, its gpu time steers the internal resolution.
+	vk::dynamicResolution.Update(vk::gpuTimer->Read(frame));
+
+	VulkanAPI::SemaphoreBlock& semaphores = vk::Semaphores[frame];
+
+	// the frame is copied straight into the image it presents, acquire it up front.
+	VkResult res = vkAcquireNextImageKHR(vk::Device, vk::swapchain->Get(), UINT64_MAX, semaphores.ImageAvailable, VK_NULL_HANDLE, &vk::CurrentFrameIndex);
+
+	vk::ImageAcquired = res == VK_SUCCESS || res == VK_SUBOPTIMAL_KHR;
+
+	// a suboptimal image is still drawn to, the swapchain is rebuilt before the next frame.
+	if (res == VK_SUBOPTIMAL_KHR || res == VK_ERROR_OUT_OF_DATE_KHR)
+		RequestSwapchainRebuild();
+
+	if (!vk::ImageAcquired) {
+		if (res != VK_ERROR_OUT_OF_DATE_KHR)
+			Console::Error("Could Not Aquire Next Image...");
+		return;
+	}
+
+	Framebuffer* framebuffer = vk::framebuffers[vk::mainFramebuffer].get();
+
+	// RESOLUTION
+	// the framebuffer stays at the output size, only its top left corner is rendered to.
+	Resolution internal = vk::dynamicResolution.Apply({ framebuffer->GetWidth(), framebuffer->GetHeight() });
+	if (internal.width != vk::InternalResolution.width || internal.height != vk::InternalResolution.height)
+	{
+		for (auto& pipeline : vk::renderPipelines)
+			pipeline->SetInternalRenderResolution(internal);
+
+		vk::InternalResolution = internal;
+	}
+
+	VkCommandBuffer cmd = vk::commandManager->BeginFrameCommand(CommandType::Graphics);
+	vk::gpuTimer->Begin(cmd, frame);
+
+	// take ownership of anything the transfer queue streamed in since the last frame.
+	TimelineWaitList waits;
+	uint64_t uploads = vk::uploadEngine->AcquireOwnership(cmd, CommandType::Graphics);
+	if (uploads > 0)
+		waits.push_back(vk::uploadEngine->GetWait(uploads));
+
+	// the swapchain image is first touched by the copy at the end of the frame.
+	waits.push_back({ semaphores.ImageAvailable, 0, VK_PIPELINE_STAGE_TRANSFER_BIT });
+
+	// per frame geometry, a small quad circling the static one.
+	{
+		float t = static_cast<float>(packet.time);
+		float x = 0.5f * std::cos(t);
+		float y = 0.5f * std::sin(t);
+		float pulse = 0.5f + 0.5f * std::sin(t * 3.0f);
+
+		Vertex* vertices = static_cast<Vertex*>(vk::buffers[vk::dynamicVertexBuffer]->Map(frame));
+		for (size_t i = 0; i < quadVertices.size(); i++)
+		{
+			vertices[i] = quadVertices[i];
+			vertices[i].Position.x = x + quadVertices[i].Position.x * 0.25f;
+			vertices[i].Position.y = y + quadVertices[i].Position.y * 0.25f;
+			vertices[i].Color.a = pulse;
+		}
+	}
+
+	// sort and expand the frame's sprites before any recording starts.
+	vk::spriteBatcher->Prepare(frame, packet.sprites);
+
+	// CULLING
+	// submitted to the compute queue before the graphics work is recorded, it overlaps with
+	// whatever the graphics queue still runs of the previous frame. the draws only wait for
+	// it where they read the indirect commands.
+	if (vk::spriteBatcher->IsCulling())
+	{
+		VkCommandBuffer compute = vk::commandManager->BeginFrameCommand(CommandType::Compute);
+		vk::spriteBatcher->Cull(compute, *vk::descriptorAllocator, ComputePipelines::Frustum::ClipSpace());
+		vk::commandManager->Submit(compute, CommandType::Compute);
+
+		vk::commandManager->AcquireOwnership(cmd, CommandType::Graphics, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, waits);
+	}
+
+	VkClearValue clearValues[1];
+	clearValues[0].color = { {0.1f, 0.1f, 0.1f, 1.0f} };
 
-	
 	VkRenderPassBeginInfo renderPassBegineInfo
 	{
 		.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-		.renderPass = vk::framebuffer->GetRenderPass(),
-		.framebuffer = vk::framebuffer->Get(),
-		.renderArea = { 0, 0, vk::framebuffer->GetWidth(), vk::framebuffer->GetHeight() },
+		.renderPass = framebuffer->GetRenderPass(),
+		.framebuffer = framebuffer->Get(),
+		.renderArea = { 0, 0, internal.width, internal.height },
 		.clearValueCount = _countof(clearValues), 
 		.pClearValues = clearValues,
 		
 	};
 
+	vkCmdBeginRenderPass(cmd, &renderPassBegineInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+	VkCommandBufferInheritanceInfo inheritance
+	{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+		.pNext = nullptr,
+		.renderPass = framebuffer->GetRenderPass(),
+		.subpass = 0,
+		.framebuffer = framebuffer->Get(),
+	};
+
+	// pipeline state is not inherited, every secondary binds what it draws with.
+	RenderPipeline* basic2DPipeline = vk::renderPipelines[vk::basic2D].get();
+	VkPipeline basic2D = basic2DPipeline->Get();
+	VkBuffer staticVertices = vk::buffers[vk::quadVertexBuffer]->Get();
+	VkBuffer indices = vk::buffers[vk::quadIndexBuffer]->Get();
+	VkBuffer dynamicVertices = vk::buffers[vk::dynamicVertexBuffer]->Get();
+	VkDeviceSize dynamicOffset = vk::buffers[vk::dynamicVertexBuffer]->GetOffset(frame);
+
+	// UNIFORMS
+	// one block per draw. the set points at the whole ring once, draws only differ in their dynamic offset.
+	VkDescriptorSet drawSet = VK_NULL_HANDLE;
+	uint32_t staticDraw = UniformRing::InvalidOffset;
+	uint32_t dynamicDraw = UniformRing::InvalidOffset;
+
+	if (basic2D)
+	{
+		RenderPipelines::Basic2D::DrawData draw;
+		staticDraw = vk::uniforms->Push(draw);
+		dynamicDraw = vk::uniforms->Push(draw);
+
+		drawSet = vk::descriptorAllocator->Allocate(basic2DPipeline->GetSetLayout());
+
+		DescriptorWriter writer;
+		writer.WriteBuffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, vk::uniforms->Get(), 0, sizeof(RenderPipelines::Basic2D::DrawData));
+		writer.Update(vk::Device, drawSet);
+	}
+
+	// the ring is full, the draws are skipped this frame.
+	bool drawBasic2D = drawSet && staticDraw != UniformRing::InvalidOffset && dynamicDraw != UniformRing::InvalidOffset;
+
+	vk::commandManager->RecordSecondary(cmd, inheritance, 1, [=](VkCommandBuffer secondary, uint32_t index) {
+		VkDeviceSize staticOffset = 0;
+
+		// every pipeline shares the internal resolution, the viewport outlives pipeline binds.
+		basic2DPipeline->SetViewport(secondary);
+
+		if (drawBasic2D)
+		{
+			vkCmdBindPipeline(secondary, VK_PIPELINE_BIND_POINT_GRAPHICS, basic2D);
+			basic2DPipeline->BindRasterState(secondary);
+			vkCmdBindIndexBuffer(secondary, indices, 0, VK_INDEX_TYPE_UINT16);
+
+			basic2DPipeline->BindDescriptorSet(secondary, drawSet, 1, &staticDraw);
+			vkCmdBindVertexBuffers(secondary, 0, 1, &staticVertices, &staticOffset);
+			vkCmdDrawIndexed(secondary, (uint32_t)quadIndices.size(), 1, 0, 0, 0);
+
+			basic2DPipeline->BindDescriptorSet(secondary, drawSet, 1, &dynamicDraw);
+			vkCmdBindVertexBuffers(secondary, 0, 1, &dynamicVertices, &dynamicOffset);
+			vkCmdDrawIndexed(secondary, (uint32_t)quadIndices.size(), 1, 0, 0, 0);
+		}
+
+		vk::spriteBatcher->Record(secondary, vk::renderPipelines);
+	});
+
+	vkCmdEndRenderPass(cmd);
+
+	// the upscale is left out, it costs the same at every internal resolution.
+	vk::gpuTimer->End(cmd, frame);
+
+	// COPY TO SWAPCHAIN
+	// the render pass leaves the framebuffer in TRANSFER_SRC, the blit upscales the rendered corner.
 	auto currentImage = vk::swapchain->GetImage(vk::CurrentFrameIndex);
-	
+	VkExtent2D extent = vk::swapchain->GetExtent();
+
 	VkImageSubresourceRange subresourceRange
-	{ VK_IMAGE_ASPECT_COLOR_BIT, 0, VK_REMAINING_MIP_LEVELS, 0,  VK_REMAINING_ARRAY_LAYERS };
+	{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
 
-	VkImageMemoryBarrier barrier
+	VkImageMemoryBarrier toTransfer
 	{
 		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		.srcAccessMask = 0,
+		.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
 		.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
 		.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
 		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
@@ -166,91 +457,74 @@ void Renderer::RenderFrame() {
 	};
 
 	vkCmdPipelineBarrier(cmd,
-		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
 		0,
 		0, nullptr,
 		0, nullptr,
-		1, &barrier
+		1, &toTransfer
 	);
 
-	vkCmdClearColorImage(cmd, currentImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clearValues[0].color, 1,&subresourceRange );
-	
-	vkCmdBeginRenderPass(cmd, &renderPassBegineInfo, VK_SUBPASS_CONTENTS_INLINE);
+	VkImageBlit blit
+	{
+		.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+		.srcOffsets = { { 0, 0, 0 }, { (int32_t)internal.width, (int32_t)internal.height, 1 } },
+		.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+		.dstOffsets = { { 0, 0, 0 }, { (int32_t)extent.width, (int32_t)extent.height, 1 } },
+	};
 
-	vkCmdEndRenderPass(cmd);
+	vkCmdBlitImage(cmd,
+		framebuffer->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		currentImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		1, &blit, VK_FILTER_LINEAR);
 
-	VkSubmitInfo submit{
-		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-		.pNext = nullptr,
-	};
+	VkImageMemoryBarrier toPresent = toTransfer;
+	toPresent.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	toPresent.dstAccessMask = 0;
+	toPresent.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	toPresent.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
-	vk::commandManager->EndSingleTimeCommand(cmd, CommandType::Graphics, vk::Fences.Drawing);
+	vkCmdPipelineBarrier(cmd,
+		VK_PIPELINE_STAGE_TRANSFER_BIT,
+		VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+		0,
+		0, nullptr,
+		0, nullptr,
+		1, &toPresent
+	);
 
-	while (vkGetFenceStatus(vk::Device, vk::Fences.Drawing) != VK_SUCCESS) {
-		Console::Log("Waiting For Drawing To Complete...");
-	};
-	Console::Log("Drawing Completed!");
+	// does not block, the next use of this frame slot waits for it.
+	vk::commandManager->Submit(cmd, CommandType::Graphics, waits, semaphores.RenderFinished);
+	vk::PresentSlot = frame;
 }
 
 void Renderer::PresentFrame()
 {
-	VkResult res = vkAcquireNextImageKHR(vk::Device, vk::swapchain->Get(), UINT64_MAX, vk::Semaphores.ImageAvailable, VK_NULL_HANDLE, &vk::CurrentFrameIndex);
-
-	if (res == VK_ERROR_OUT_OF_DATE_KHR || res == VK_SUBOPTIMAL_KHR) {
-		return;
-	}
-	else if (res != VK_SUCCESS) {
-		// ERROR
-		Console::Error("Could Not Aquire Next Image...");
+	if (!vk::ImageAcquired)
 		return;
-	}
-	auto cmd = vk::commandManager->BeginSingleTimeCommand(CommandType::Graphics);
-
-	auto swapchain_ref = vk::swapchain->Get();
-
-	auto currentImage = vk::swapchain->GetImage(vk::CurrentFrameIndex);
 
+	vk::ImageAcquired = false;
 
-	auto presentationQueue = vk::commandManager->GetPresentQueue();
-
-	VkImageMemoryBarrier barrier
-	{
-		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-		.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-		.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-		.image = currentImage,
-		.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}
-	};
-	
-	vkCmdPipelineBarrier(cmd,
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-		0, 
-		0, nullptr, 
-		0, nullptr, 
-		1, &barrier
-		);
-
-	vk::commandManager->EndSingleTimeCommand(cmd, CommandType::Graphics, vk::Fences.Presenting);
+	auto swapchain_ref = vk::swapchain->Get();
 
 	VkPresentInfoKHR present
 	{
 		.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR, 
 		.pNext = nullptr, 
 		.waitSemaphoreCount = 1, 
-		.pWaitSemaphores = &vk::Semaphores.ImageAvailable,
+		.pWaitSemaphores = &vk::Semaphores[vk::PresentSlot].RenderFinished,
 		.swapchainCount = 1,
 		.pSwapchains = &swapchain_ref,
 		.pImageIndices = &vk::CurrentFrameIndex,
 
 	};
 
-	res = vkQueuePresentKHR(presentationQueue, &present);
-
+	VkResult res = vkQueuePresentKHR(vk::commandManager->GetPresentQueue(), &present);
 
+	if (res == VK_SUBOPTIMAL_KHR || res == VK_ERROR_OUT_OF_DATE_KHR)
+		RequestSwapchainRebuild();
+	else if (res != VK_SUCCESS)
+		Console::Error("Could Not Present Frame...");
 }
 
 // 1. Get the new surface size
@@ -264,43 +538,182 @@ void Renderer::HandleResize(GLFWwindow* win, int width, int height)
 	std::string title = "Temporal [Vulkan]-(" + std::to_string(width) + ", " + std::to_string(height) + ")";
 	glfwSetWindowTitle(win, title.c_str());
 
+	// the swapchain may be in use by the render thread, defer the rebuild to the start of the next frame.
+	uint64_t size = PackSize((uint32_t)width, (uint32_t)height);
+	vk::WindowSize.store(size, std::memory_order_release);
+	vk::PendingResize.store((1ull << 63) | size, std::memory_order_release);
+}
+
+void Renderer::ApplyPendingResize()
+{
+	uint64_t pending = vk::PendingResize.exchange(0, std::memory_order_acq_rel);
+	if (pending == 0)
+		return;
+
 	Resolution res;
-	res.width = static_cast<uint32_t>(width);
-	res.height = static_cast<uint32_t>(height);
+	res.width = static_cast<uint32_t>((pending >> 32) & 0x7FFFFFFF);
+	res.height = static_cast<uint32_t>(pending & 0xFFFFFFFF);
+
+	// minimized, keep the old swapchain until the window comes back.
+	if (res.width == 0 || res.height == 0)
+		return;
 
+	vkDeviceWaitIdle(vk::Device);
 
-	delete vk::framebuffer;
-	delete vk::swapchain;
+	// the old framebuffer's handle goes stale, anything still holding it will no longer resolve.
+	vk::framebuffers.erase(vk::mainFramebuffer);
+	vk::swapchain.reset();
 	
 	VulkanAPI::FreeSurface(vk::Instance, vk::Surface);
 
-	vk::Surface = VulkanAPI::CreateSurfaceGLFW(vk::Instance, win);
+	vk::Surface = VulkanAPI::CreateSurfaceGLFW(vk::Instance, window);
 	
-	vk::swapchain = new Swapchain(vk::Device, vk::PhysicalDevice, win, vk::Surface, vk::QueueFamily, res, 3);
+	vk::swapchain = std::make_unique<Swapchain>(vk::Device, vk::PhysicalDevice, vk::Surface, vk::QueueFamily, res, 3);
 	
-	vk::framebuffer = new Framebuffer(vk::Device, res, vk::QueueFamily);
+	vk::mainFramebuffer = vk::framebuffers.insert(std::make_unique<Framebuffer>(vk::Device, vk::PhysicalDevice, res, vk::QueueFamily));
+}
+
+void Renderer::SetResolutionScaling(const DynamicResolution::Settings& settings)
+{
+	vk::dynamicResolution.SetSettings(settings);
+}
+
+Resolution Renderer::GetInternalResolution()
+{
+	return vk::InternalResolution;
+}
+
+void Renderer::StartRenderThread(uint32_t depth)
+{
+	if (threaded.load())
+		return;
+
+	queueDepth = std::clamp(depth, 1u, MaxQueuedFrames);
+	threaded.store(true);
+
+	renderThread = std::thread(&Renderer::RenderThreadLoop, this);
+}
+
+void Renderer::StopRenderThread()
+{
+	if (!threaded.exchange(false))
+		return;
+
+	// wake the render thread so it sees the flag, it drains what is queued first.
+	pushed.fetch_add(1, std::memory_order_release);
+	pushed.notify_one();
+
+	renderThread.join();
+}
+
+bool Renderer::IsThreaded()
+{
+	return threaded.load();
+}
+
+void Renderer::SubmitFrame(FramePacket packet)
+{
+	if (!IsThreaded())
+	{
+		RenderFrame(packet);
+		PresentFrame();
+		recycled.try_push(std::move(packet.sprites));
+		return;
+	}
+
+	// block while the render thread is `queueDepth` frames behind.
+	for (;;)
+	{
+		uint64_t seen = popped.load(std::memory_order_acquire);
+
+		if (packets.size() < queueDepth && packets.try_push(std::move(packet)))
+			break;
+
+		popped.wait(seen, std::memory_order_acquire);
+	}
+
+	pushed.fetch_add(1, std::memory_order_release);
+	pushed.notify_one();
+}
+
+SpriteBatch Renderer::AcquireSpriteBatch()
+{
+	SpriteBatch batch;
+	if (recycled.try_pop(batch))
+		batch.Clear();
+	return batch;
+}
+
+void Renderer::RenderThreadLoop()
+{
+	FramePacket packet;
 
+	for (;;)
+	{
+		if (packets.try_pop(packet))
+		{
+			popped.fetch_add(1, std::memory_order_release);
+			popped.notify_one();
+
+			RenderFrame(packet);
+			PresentFrame();
+
+			// the batcher copied the sprites out, the arrays go back to be refilled.
+			recycled.try_push(std::move(packet.sprites));
+			continue;
+		}
 
+		uint64_t seen = pushed.load(std::memory_order_acquire);
 
+		if (!packets.empty())
+			continue;
+
+		if (!threaded.load())
+			break;
+
+		pushed.wait(seen, std::memory_order_acquire);
+	}
 }
 
 
 void Renderer::Cleanup()
 {
-	for (const auto& entry : vk::renderPipelines)
+	StopRenderThread();
+
+	vkDeviceWaitIdle(vk::Device);
+
+	for (auto& pipeline : vk::renderPipelines)
 	{
-		auto pipeline = entry.second;
 		pipeline->Cleanup();
-		delete pipeline;
 	}
+	vk::renderPipelines.clear();
 
-	delete vk::framebuffer;
-	delete vk::swapchain;
+	for (auto& pipeline : vk::computePipelines)
+	{
+		pipeline->Cleanup();
+	}
+	vk::computePipelines.clear();
+
+	// the pipelines no longer reference any set or layout.
+	vk::pipelineRegistry.reset();
+	vk::shaderCache.reset();
+	vk::bindless.reset();
+	vk::descriptorAllocator.reset();
+	vk::descriptorLayouts.reset();
+
+	vk::framebuffers.clear();
+	vk::swapchain.reset();
+	// pending uploads still reference their destination buffers.
+	delete vk::uploadEngine;
+	vk::spriteBatcher.reset();
+	vk::uniforms.reset();
+	vk::gpuTimer.reset();
+	vk::buffers.clear();
 	delete vk::commandManager;
 
 
-	VulkanAPI::FreeFenceBlock(vk::Device, vk::Fences);
-	VulkanAPI::FreeSemaphoreBlock(vk::Device, vk::Semaphores);
+	for (auto& semaphores : vk::Semaphores)
+		VulkanAPI::FreeSemaphoreBlock(vk::Device, semaphores);
 
 	VulkanAPI::FreeDevice(vk::Device);
 	VulkanAPI::FreeSurface(vk::Instance, vk::Surface);
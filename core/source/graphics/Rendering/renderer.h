@@ -3,28 +3,80 @@
 #include <windows.h>
 
 #include <datastructures/datastructures_pch.h>
+#include <datastructures/RingBuffer.h>
 
 #include <graphics/gfx_pch.h>
+#include <graphics/Rendering/Sprites/SpriteBatch.h>
+#include <graphics/Rendering/Resolution/DynamicResolution.h>
 
+#include <atomic>
+#include <thread>
+
+// everything the render thread needs to draw one frame, built by the main/simulation thread.
+struct FramePacket {
+	uint64_t frame = 0;
+	double time = 0.0;
+	double deltaTime = 0.0;
+
+	SpriteBatch sprites;
+};
 
 class Renderer {
 
 public:
+	// upper bound for the render thread's queue depth.
+	static constexpr uint32_t MaxQueuedFrames = 4;
+
 	Renderer();
 	~Renderer();
 
 	bool Initilize(GLFWwindow* window);
 	void Cleanup();
 
-	void RenderFrame();
+	void RenderFrame(const FramePacket& packet = {});
 	void PresentFrame();
+
+	// bounds and frame budget of the dynamic resolution, not while the render thread runs.
+	// a minScale equal to maxScale pins the internal resolution.
+	void SetResolutionScaling(const DynamicResolution::Settings& settings);
+	// resolution the last frame was rendered at.
+	Resolution GetInternalResolution();
+
+	// moves RenderFrame/PresentFrame onto a dedicated thread fed through SubmitFrame().
+	// `queueDepth` bounds how many frames the submitting thread may run ahead of the gpu.
+	void StartRenderThread(uint32_t queueDepth = 2);
+	void StopRenderThread();
+	bool IsThreaded();
+
+	// queues a frame for the render thread, blocks while the queue is full.
+	// without a render thread the frame is rendered and presented inline.
+	void SubmitFrame(FramePacket packet);
+	// an empty sprite batch, the storage of one the renderer is done with so filling it does not
+	// allocate again. a new batch until frames came back. only the submitting thread may call it.
+	SpriteBatch AcquireSpriteBatch();
+
 protected:
 	static void HandleResize(GLFWwindow* win, int width, int height);
 
 private:
 	// MISC
 	void GetRequiredInfo();
+	void ApplyPendingResize();
+	void RenderThreadLoop();
 
 	GLFWwindow* window;
 
+	// RENDER THREAD
+	std::thread renderThread;
+	std::atomic<bool> threaded{ false };
+	uint32_t queueDepth = 2;
+
+	SPSCRingBuffer<FramePacket, MaxQueuedFrames> packets;
+	// consumed packets' sprite storage on its way back to the submitting thread.
+	// more slots than batches can be in flight, a push never fails.
+	SPSCRingBuffer<SpriteBatch, MaxQueuedFrames * 2> recycled;
+	// bumped on every push/pop so either side can sleep on the other.
+	std::atomic<uint64_t> pushed{ 0 };
+	std::atomic<uint64_t> popped{ 0 };
+
 };
\ No newline at end of file
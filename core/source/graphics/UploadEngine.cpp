@@ -0,0 +1,397 @@
+#include "UploadEngine.h"
+
+#include "graphics/CommandManager.h"
+
+#include <cstring>
+
+using namespace VulkanAPI;
+
+UploadEngine::UploadEngine(VkDevice device, VkPhysicalDevice physicalDevice, CommandManager* commandManager, VkDeviceSize stagingSize)
+	: device{ device }, commandManager{ commandManager }, capacity{ stagingSize }
+{
+	// without a dedicated transfer family the copies go through the graphics queue.
+	transferType = commandManager->GetQueueFamilyIndex(CommandType::Transfer) != VK_QUEUE_FAMILY_IGNORED ? CommandType::Transfer : CommandType::Graphics;
+	transferFamily = commandManager->GetQueueFamilyIndex(transferType);
+
+	staging = VulkanAPI::CreateBuffer(device, capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+	stagingMemory = VulkanAPI::AllocateBufferMemory(device, physicalDevice, staging, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	// the ring stays mapped for the lifetime of the engine.
+	VK_CHECK(vkMapMemory(device, stagingMemory, 0, capacity, 0, reinterpret_cast<void**>(&mapped)));
+
+	timeline = VulkanAPI::CreateTimelineSemaphore(device, 0);
+}
+
+UploadEngine::~UploadEngine()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		FlushLocked();
+	}
+
+	Wait(nextValue - 1);
+	Retire();
+
+	vkUnmapMemory(device, stagingMemory);
+	vkDestroyBuffer(device, staging, nullptr);
+	vkFreeMemory(device, stagingMemory, nullptr);
+	vkDestroySemaphore(device, timeline, nullptr);
+}
+
+uint64_t UploadEngine::UploadBuffer(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size, CommandType consumer)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	uint32_t dstFamily = commandManager->GetQueueFamilyIndex(consumer);
+	const uint8_t* src = static_cast<const uint8_t*>(data);
+
+	// anything larger than half the ring is streamed through it in chunks.
+	const VkDeviceSize chunk = capacity / 2;
+
+	for (VkDeviceSize written = 0; written < size; written += chunk)
+	{
+		VkDeviceSize bytes = std::min(chunk, size - written);
+		VkDeviceSize offset = AllocateStaging(bytes, 16);
+
+		memcpy(mapped + offset, src + written, bytes);
+
+		auto entry = std::find_if(pendingBuffers.begin(), pendingBuffers.end(), [dst](const BufferCopies& c) { return c.dst == dst; });
+		if (entry == pendingBuffers.end())
+		{
+			pendingBuffers.push_back({ dst, {} });
+			entry = pendingBuffers.end() - 1;
+		}
+
+		entry->regions.push_back({ .srcOffset = offset, .dstOffset = dstOffset + written, .size = bytes });
+	}
+
+	if (NeedsOwnershipTransfer(dstFamily))
+	{
+		pendingReleases.push_back({
+			.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+			.pNext = nullptr,
+			.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.dstAccessMask = 0,
+			.srcQueueFamilyIndex = transferFamily,
+			.dstQueueFamilyIndex = dstFamily,
+			.buffer = dst,
+			.offset = dstOffset,
+			.size = size,
+		});
+	}
+
+	pendingConsumers.insert(dstFamily);
+
+	return nextValue;
+}
+
+uint64_t UploadEngine::UploadImage(VkImage dst, VkExtent3D extent, const void* data, VkDeviceSize size, VkImageLayout finalLayout, CommandType consumer)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (size >= capacity)
+	{
+		Console::Error("Image Upload Does Not Fit The Staging Ring! Size: ", size);
+		return 0;
+	}
+
+	uint32_t dstFamily = commandManager->GetQueueFamilyIndex(consumer);
+
+	VkDeviceSize offset = AllocateStaging(size, 16);
+	memcpy(mapped + offset, data, size);
+
+	VkBufferImageCopy region
+	{
+		.bufferOffset = offset,
+		.bufferRowLength = 0,
+		.bufferImageHeight = 0,
+		.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+		.imageOffset = { 0, 0, 0 },
+		.imageExtent = extent,
+	};
+
+	pendingImages.push_back({ dst, region, finalLayout, dstFamily });
+	pendingConsumers.insert(dstFamily);
+
+	return nextValue;
+}
+
+uint64_t UploadEngine::Flush()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return FlushLocked();
+}
+
+uint64_t UploadEngine::AcquireOwnership(VkCommandBuffer cmd, CommandType consumer)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	FlushLocked();
+
+	auto found = acquires.find(commandManager->GetQueueFamilyIndex(consumer));
+	if (found == acquires.end())
+		return 0;
+
+	Acquires& pending = found->second;
+
+	if (!pending.buffers.empty() || !pending.images.empty())
+	{
+		vkCmdPipelineBarrier(cmd,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+			0,
+			0, nullptr,
+			(uint32_t)pending.buffers.size(), pending.buffers.data(),
+			(uint32_t)pending.images.size(), pending.images.data()
+		);
+	}
+
+	uint64_t value = pending.value;
+
+	pending.buffers.clear();
+	pending.images.clear();
+	pending.value = 0;
+
+	return value;
+}
+
+bool UploadEngine::IsComplete(uint64_t value)
+{
+	return VulkanAPI::GetTimelineValue(device, timeline) >= value;
+}
+
+void UploadEngine::Wait(uint64_t value)
+{
+	if (value == 0)
+		return;
+
+	VulkanAPI::WaitTimeline(device, timeline, value);
+}
+
+VkSemaphore UploadEngine::GetTimeline()
+{
+	return timeline;
+}
+
+VulkanAPI::TimelineWait UploadEngine::GetWait(uint64_t value, VkPipelineStageFlags stage)
+{
+	return { timeline, value, stage };
+}
+
+VkDeviceSize UploadEngine::AllocateStaging(VkDeviceSize size, VkDeviceSize alignment)
+{
+	assert(size < capacity && "Staging Allocation Does Not Fit The Ring.");
+
+	for (;;)
+	{
+		Retire();
+
+		if (inFlight.empty() && pendingBuffers.empty() && pendingImages.empty())
+			head = tail = 0;
+
+		VkDeviceSize offset = (head + alignment - 1) & ~(alignment - 1);
+
+		if (head >= tail)
+		{
+			// free space is [head, capacity) followed by [0, tail)
+			if (offset + size <= capacity) {
+				head = offset + size;
+				return offset;
+			}
+			if (size < tail) {
+				head = size;
+				return 0;
+			}
+		}
+		else if (offset + size < tail)
+		{
+			head = offset + size;
+			return offset;
+		}
+
+		// the ring is full, push out whatever is queued and wait for the oldest batch.
+		if (!pendingBuffers.empty() || !pendingImages.empty())
+			FlushLocked();
+
+		Wait(inFlight.front().value);
+	}
+}
+
+void UploadEngine::Retire()
+{
+	if (inFlight.empty())
+		return;
+
+	uint64_t completed = VulkanAPI::GetTimelineValue(device, timeline);
+
+	while (!inFlight.empty() && inFlight.front().value <= completed)
+	{
+		tail = inFlight.front().end;
+		commandManager->FreeCommandBuffer(transferType, inFlight.front().cmd);
+		inFlight.pop_front();
+	}
+}
+
+bool UploadEngine::NeedsOwnershipTransfer(uint32_t dstFamily)
+{
+	return dstFamily != VK_QUEUE_FAMILY_IGNORED && dstFamily != transferFamily;
+}
+
+uint64_t UploadEngine::FlushLocked()
+{
+	if (pendingBuffers.empty() && pendingImages.empty())
+		return nextValue - 1;
+
+	uint64_t value = nextValue++;
+
+	VkCommandBuffer cmd = commandManager->AllocateCommandBuffer(transferType);
+
+	VkCommandBufferBeginInfo begin{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.pNext = nullptr,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+	};
+
+	VK_CHECK(vkBeginCommandBuffer(cmd, &begin));
+
+	// BUFFERS
+	for (const auto& copy : pendingBuffers)
+	{
+		vkCmdCopyBuffer(cmd, staging, copy.dst, (uint32_t)copy.regions.size(), copy.regions.data());
+	}
+
+	// IMAGES
+	if (!pendingImages.empty())
+	{
+		std::vector<VkImageMemoryBarrier> toTransfer;
+		std::vector<VkImageMemoryBarrier> releases;
+
+		VkImageSubresourceRange range{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+		for (const auto& copy : pendingImages)
+		{
+			toTransfer.push_back({
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+				.pNext = nullptr,
+				.srcAccessMask = 0,
+				.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+				.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+				.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = copy.dst,
+				.subresourceRange = range
+			});
+
+			bool transfer = NeedsOwnershipTransfer(copy.dstFamily);
+
+			VkImageMemoryBarrier release
+			{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+				.pNext = nullptr,
+				.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+				.dstAccessMask = 0,
+				.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				.newLayout = copy.finalLayout,
+				.srcQueueFamilyIndex = transfer ? transferFamily : VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = transfer ? copy.dstFamily : VK_QUEUE_FAMILY_IGNORED,
+				.image = copy.dst,
+				.subresourceRange = range
+			};
+
+			releases.push_back(release);
+
+			if (transfer)
+			{
+				// the acquire repeats the layout transition on the consumer's queue.
+				release.srcAccessMask = 0;
+				release.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+				acquires[copy.dstFamily].images.push_back(release);
+			}
+		}
+
+		vkCmdPipelineBarrier(cmd,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0,
+			0, nullptr,
+			0, nullptr,
+			(uint32_t)toTransfer.size(), toTransfer.data()
+		);
+
+		for (const auto& copy : pendingImages)
+		{
+			vkCmdCopyBufferToImage(cmd, staging, copy.dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy.region);
+		}
+
+		vkCmdPipelineBarrier(cmd,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			0,
+			0, nullptr,
+			0, nullptr,
+			(uint32_t)releases.size(), releases.data()
+		);
+	}
+
+	// release the buffers to their consumers' queue families.
+	if (!pendingReleases.empty())
+	{
+		vkCmdPipelineBarrier(cmd,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			0,
+			0, nullptr,
+			(uint32_t)pendingReleases.size(), pendingReleases.data(),
+			0, nullptr
+		);
+
+		for (auto release : pendingReleases)
+		{
+			release.srcAccessMask = 0;
+			release.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+			acquires[release.dstQueueFamilyIndex].buffers.push_back(release);
+		}
+	}
+
+	VK_CHECK(vkEndCommandBuffer(cmd));
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo
+	{
+		.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+		.pNext = nullptr,
+		.waitSemaphoreValueCount = 0,
+		.pWaitSemaphoreValues = nullptr,
+		.signalSemaphoreValueCount = 1,
+		.pSignalSemaphoreValues = &value,
+	};
+
+	VkSubmitInfo submit
+	{
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.pNext = &timelineInfo,
+		.waitSemaphoreCount = 0,
+		.pWaitSemaphores = nullptr,
+		.pWaitDstStageMask = nullptr,
+		.commandBufferCount = 1,
+		.pCommandBuffers = &cmd,
+		.signalSemaphoreCount = 1,
+		.pSignalSemaphores = &timeline,
+	};
+
+	VK_CHECK(vkQueueSubmit(commandManager->GetQueue(transferType), 1, &submit, VK_NULL_HANDLE));
+
+	for (uint32_t family : pendingConsumers)
+	{
+		acquires[family].value = value;
+	}
+
+	inFlight.push_back({ cmd, value, head });
+
+	pendingBuffers.clear();
+	pendingImages.clear();
+	pendingReleases.clear();
+	pendingConsumers.clear();
+
+	return value;
+}
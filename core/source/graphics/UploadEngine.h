@@ -0,0 +1,98 @@
+#pragma once
+
+#include <graphics/gfx_pch.h>
+
+#include <mutex>
+
+class CommandManager;
+
+// Streams buffer and image data to the gpu on the transfer queue.
+//
+// data is copied into a persistently mapped staging ring, copies are batched
+// until Flush() and every batch signals the engine's timeline semaphore.
+// when the transfer queue lives in another family the engine records the
+// release half of the ownership transfer, the consumer records the acquire
+// half through AcquireOwnership() before using the resource.
+class UploadEngine {
+public:
+	// the device must have timeline semaphores enabled.
+	UploadEngine(VkDevice device, VkPhysicalDevice physicalDevice, CommandManager* commandManager, VkDeviceSize stagingSize = 64ull * 1024 * 1024);
+	~UploadEngine();
+
+	// returns the timeline value that is signaled once the copy has landed.
+	uint64_t UploadBuffer(VkBuffer dst, VkDeviceSize dstOffset, const void* data, VkDeviceSize size, VulkanAPI::CommandType consumer = VulkanAPI::CommandType::Graphics);
+	uint64_t UploadImage(VkImage dst, VkExtent3D extent, const void* data, VkDeviceSize size, VkImageLayout finalLayout, VulkanAPI::CommandType consumer = VulkanAPI::CommandType::Graphics);
+
+	// submits every queued copy as a single batch.
+	uint64_t Flush();
+
+	// records the acquire barriers for everything flushed towards `consumer`.
+	// returns the timeline value the consumer's submission has to wait on (0 when nothing is pending).
+	uint64_t AcquireOwnership(VkCommandBuffer cmd, VulkanAPI::CommandType consumer);
+
+	bool IsComplete(uint64_t value);
+	void Wait(uint64_t value);
+
+	VkSemaphore GetTimeline();
+	VulkanAPI::TimelineWait GetWait(uint64_t value, VkPipelineStageFlags stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+private:
+	struct BufferCopies {
+		VkBuffer dst;
+		std::vector<VkBufferCopy> regions;
+	};
+
+	struct ImageCopy {
+		VkImage dst;
+		VkBufferImageCopy region;
+		VkImageLayout finalLayout;
+		uint32_t dstFamily;
+	};
+
+	struct Acquires {
+		std::vector<VkBufferMemoryBarrier> buffers;
+		std::vector<VkImageMemoryBarrier> images;
+		uint64_t value = 0;
+	};
+
+	struct Batch {
+		VkCommandBuffer cmd;
+		uint64_t value;
+		VkDeviceSize end;
+	};
+
+	// returns the offset into the staging ring, blocks on in flight batches when the ring is full.
+	VkDeviceSize AllocateStaging(VkDeviceSize size, VkDeviceSize alignment);
+	void Retire();
+
+	uint64_t FlushLocked();
+	bool NeedsOwnershipTransfer(uint32_t dstFamily);
+
+	std::mutex mutex;
+
+	VkDevice device;
+	CommandManager* commandManager;
+
+	VulkanAPI::CommandType transferType;
+	uint32_t transferFamily;
+
+	// staging ring
+	VkBuffer staging;
+	VkDeviceMemory stagingMemory;
+	uint8_t* mapped;
+	VkDeviceSize capacity;
+	VkDeviceSize head = 0;
+	VkDeviceSize tail = 0;
+
+	VkSemaphore timeline;
+	uint64_t nextValue = 1;
+
+	// copies recorded at the next flush
+	std::vector<BufferCopies> pendingBuffers;
+	std::vector<ImageCopy> pendingImages;
+	std::vector<VkBufferMemoryBarrier> pendingReleases;
+	std::unordered_set<uint32_t> pendingConsumers;
+
+	std::unordered_map<uint32_t, Acquires> acquires;
+	std::deque<Batch> inFlight;
+};
@@ -3,6 +3,8 @@
 #include <datastructures/datastructures_pch.h>
 #include "memory/memory.h"
 
+#include <cstring>
+
 
 namespace VulkanAPI {
 
@@ -177,6 +179,70 @@ namespace VulkanAPI {
 		return device;
 	}
 
+	bool SupportsDeviceExtension(VkPhysicalDevice physicalDevice, const char* extension)
+	{
+		uint32_t count = 0;
+		vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, nullptr);
+
+		std::vector<VkExtensionProperties> extensions(count);
+		vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &count, extensions.data());
+
+		return std::any_of(extensions.begin(), extensions.end(), [&](const VkExtensionProperties& props) {
+			return strcmp(props.extensionName, extension) == 0;
+		});
+	}
+
+	DeviceFeatures QueryDeviceFeatures(VkPhysicalDevice physicalDevice)
+	{
+		bool pipelineLibraries = SupportsDeviceExtension(physicalDevice, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME)
+			&& SupportsDeviceExtension(physicalDevice, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+
+		VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT supportedLibrary{};
+		supportedLibrary.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+
+		VkPhysicalDeviceVulkan12Features supported12{};
+		supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		supported12.pNext = pipelineLibraries ? &supportedLibrary : nullptr;
+
+		VkPhysicalDeviceFeatures2 supported{};
+		supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supported.pNext = &supported12;
+
+		vkGetPhysicalDeviceFeatures2(physicalDevice, &supported);
+
+		VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT libraryProperties{};
+		libraryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+
+		VkPhysicalDeviceProperties2 properties2{};
+		properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties2.pNext = pipelineLibraries ? &libraryProperties : nullptr;
+
+		vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+
+		const VkPhysicalDeviceProperties& properties = properties2.properties;
+
+		DeviceFeatures features;
+		features.timelineSemaphore = supported12.timelineSemaphore;
+		features.multiDrawIndirect = supported.features.multiDrawIndirect;
+		features.drawIndirectFirstInstance = supported.features.drawIndirectFirstInstance;
+		features.drawIndirectCount = supported12.drawIndirectCount;
+		features.descriptorIndexing = supported12.descriptorIndexing
+			&& supported12.runtimeDescriptorArray
+			&& supported12.descriptorBindingPartiallyBound
+			&& supported12.descriptorBindingUpdateUnusedWhilePending
+			&& supported12.descriptorBindingSampledImageUpdateAfterBind
+			&& supported12.descriptorBindingStorageBufferUpdateAfterBind
+			&& supported12.shaderSampledImageArrayNonUniformIndexing;
+		// the instance asks for 1.3, a 1.3 device has the commands without enabling anything.
+		features.extendedDynamicState = properties.apiVersion >= VK_API_VERSION_1_3;
+		// without fast linking a linked pipeline costs about as much as a monolithic one.
+		features.graphicsPipelineLibrary = pipelineLibraries
+			&& supportedLibrary.graphicsPipelineLibrary
+			&& libraryProperties.graphicsPipelineLibraryFastLinking;
+
+		return features;
+	}
+
 	VkDevice CreateDevice(VkInstance instance, VkPhysicalDevice physicalDevice, std::vector<std::string> enabled_layers, std::vector<std::string> enabled_extensions, QueueFamily queueFamily) {
 		if (instance == VK_NULL_HANDLE || physicalDevice == VK_NULL_HANDLE)
 			return VK_NULL_HANDLE;
@@ -184,23 +250,66 @@ namespace VulkanAPI {
 		std::vector<const char*> layers;
 		std::transform(enabled_layers.begin(), enabled_layers.end(), std::back_inserter(layers), [](const std::string& str) {return str.c_str(); });
 
+		bool pipelineLibraries = SupportsDeviceExtension(physicalDevice, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME)
+			&& SupportsDeviceExtension(physicalDevice, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+
+		// optional, the pipeline registry links from libraries when they are there.
+		if (pipelineLibraries)
+		{
+			enabled_extensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+			enabled_extensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+		}
+
 		std::vector<const char*> extensions;
 		std::transform(enabled_extensions.begin(), enabled_extensions.end(), std::back_inserter(extensions), [](const std::string& str) {return str.c_str(); });
 
 
 		VkDevice device;
 
-		float priority = 1;
-
 		auto queues = queueFamily.GetCreateInfo();
 
 		VkPhysicalDeviceFeatures deviceFeatures{};
 
 		vkGetPhysicalDeviceFeatures(physicalDevice, &deviceFeatures);
 
+		// query the 1.2 feature set, only what the device reports gets enabled.
+		VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT supportedLibrary{};
+		supportedLibrary.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+
+		VkPhysicalDeviceVulkan12Features supported12{};
+		supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		supported12.pNext = pipelineLibraries ? &supportedLibrary : nullptr;
+
+		VkPhysicalDeviceFeatures2 supported{};
+		supported.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		supported.pNext = &supported12;
+
+		vkGetPhysicalDeviceFeatures2(physicalDevice, &supported);
+
+		VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT featuresLibrary{};
+		featuresLibrary.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+		featuresLibrary.graphicsPipelineLibrary = supportedLibrary.graphicsPipelineLibrary;
+
+		VkPhysicalDeviceVulkan12Features features12{};
+		features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		// timeline semaphores drive the upload engine.
+		features12.timelineSemaphore = supported12.timelineSemaphore;
+		// gpu driven draw counts.
+		features12.drawIndirectCount = supported12.drawIndirectCount;
+		// bindless textures and buffers.
+		features12.descriptorIndexing = supported12.descriptorIndexing;
+		features12.runtimeDescriptorArray = supported12.runtimeDescriptorArray;
+		features12.descriptorBindingPartiallyBound = supported12.descriptorBindingPartiallyBound;
+		features12.descriptorBindingUpdateUnusedWhilePending = supported12.descriptorBindingUpdateUnusedWhilePending;
+		features12.descriptorBindingSampledImageUpdateAfterBind = supported12.descriptorBindingSampledImageUpdateAfterBind;
+		features12.descriptorBindingStorageBufferUpdateAfterBind = supported12.descriptorBindingStorageBufferUpdateAfterBind;
+		features12.shaderSampledImageArrayNonUniformIndexing = supported12.shaderSampledImageArrayNonUniformIndexing;
+		// separately built pipeline parts.
+		features12.pNext = pipelineLibraries ? &featuresLibrary : nullptr;
+
 		VkDeviceCreateInfo info{
 			.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-			.pNext = nullptr,
+			.pNext = &features12,
 			.flags = 0,
 			.queueCreateInfoCount = (uint32_t)queues.size(),
 			.pQueueCreateInfos = queues.data(),
@@ -239,6 +348,17 @@ namespace VulkanAPI {
 		if (queueFamily.sparse_binding.has_value())
 			block.SparseBinding = AquireQueueHandle(device, queueFamily, CommandType::SparseBinding);
 
+		auto all = [&](CommandType type) {
+			std::vector<VkQueue> queues(queueFamily.GetQueueCount(type), VK_NULL_HANDLE);
+			for (uint32_t i = 0; i < queues.size(); i++)
+				vkGetDeviceQueue(device, queueFamily.Get(type).value(), i, &queues[i]);
+			return queues;
+		};
+
+		block.GraphicsQueues = all(CommandType::Graphics);
+		block.ComputeQueues = all(CommandType::Compute);
+		block.TransferQueues = all(CommandType::Transfer);
+
 		return block;
 	}
 
@@ -260,24 +380,9 @@ namespace VulkanAPI {
 
 		VkQueue queue{ VK_NULL_HANDLE };
 
-		switch (type)
-		{
-		case CommandType::Graphics:
-			vkGetDeviceQueue(device, queueFamily.graphics.value(), 0, &queue);
-			break;
-		case CommandType::Present:
-			vkGetDeviceQueue(device, queueFamily.present.value(), 0, &queue);
-			break;
-		case CommandType::Compute:
-			vkGetDeviceQueue(device, queueFamily.compute.value(), 0, &queue);
-			break;
-		case CommandType::Transfer:
-			vkGetDeviceQueue(device, queueFamily.transfer.value(), 0, &queue);
-			break;
-		case CommandType::SparseBinding:
-			vkGetDeviceQueue(device, queueFamily.sparse_binding.value(), 0, &queue);
-			break;
-		}
+		auto family = queueFamily.Get(type);
+		if (family.has_value())
+			vkGetDeviceQueue(device, family.value(), queueFamily.GetQueueIndex(type), &queue);
 
 		return queue;
 	}
@@ -419,15 +524,120 @@ namespace VulkanAPI {
 	{
 		if (block.ImageAvailable != VK_NULL_HANDLE)
 			vkDestroySemaphore(device, block.ImageAvailable, nullptr);
+		if (block.RenderFinished != VK_NULL_HANDLE)
+			vkDestroySemaphore(device, block.RenderFinished, nullptr);
 	}
 
 	SemaphoreBlock CreateSemaphoreBlock(VkDevice device)
 	{
 		SemaphoreBlock block;
 		block.ImageAvailable = CreateSemaphoreSyncObject(device);
+		block.RenderFinished = CreateSemaphoreSyncObject(device);
 		return block;
 	}
 
+	VkSemaphore CreateTimelineSemaphore(VkDevice device, uint64_t initialValue)
+	{
+		VkSemaphore semaphore = VK_NULL_HANDLE;
+
+		VkSemaphoreTypeCreateInfo type
+		{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+			.pNext = nullptr,
+			.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+			.initialValue = initialValue,
+		};
+
+		VkSemaphoreCreateInfo info
+		{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = &type,
+			.flags = 0,
+		};
+
+		VK_CHECK(vkCreateSemaphore(device, &info, nullptr, &semaphore));
+
+		return semaphore;
+	}
+
+	uint64_t GetTimelineValue(VkDevice device, VkSemaphore semaphore)
+	{
+		uint64_t value = 0;
+		VK_CHECK(vkGetSemaphoreCounterValue(device, semaphore, &value));
+		return value;
+	}
+
+	void WaitTimeline(VkDevice device, VkSemaphore semaphore, uint64_t value)
+	{
+		VkSemaphoreWaitInfo info
+		{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.semaphoreCount = 1,
+			.pSemaphores = &semaphore,
+			.pValues = &value,
+		};
+
+		VK_CHECK(vkWaitSemaphores(device, &info, UINT64_MAX));
+	}
+
+	uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeBits, VkMemoryPropertyFlags properties)
+	{
+		VkPhysicalDeviceMemoryProperties memory;
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memory);
+
+		for (uint32_t i = 0; i < memory.memoryTypeCount; i++)
+		{
+			if ((typeBits & (1 << i)) && (memory.memoryTypes[i].propertyFlags & properties) == properties)
+				return i;
+		}
+
+		Console::Error("Could Not Find A Suitable Memory Type! Properties: ", properties);
+		assert(false);
+		return 0;
+	}
+
+	VkBuffer CreateBuffer(VkDevice device, VkDeviceSize size, VkBufferUsageFlags usage)
+	{
+		VkBuffer buffer = VK_NULL_HANDLE;
+
+		VkBufferCreateInfo info
+		{
+			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.size = size,
+			.usage = usage,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+		};
+
+		VK_CHECK(vkCreateBuffer(device, &info, nullptr, &buffer));
+
+		return buffer;
+	}
+
+	VkDeviceMemory AllocateBufferMemory(VkDevice device, VkPhysicalDevice physicalDevice, VkBuffer buffer, VkMemoryPropertyFlags properties)
+	{
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+
+		VkMemoryRequirements memReqs;
+		vkGetBufferMemoryRequirements(device, buffer, &memReqs);
+
+		VkMemoryAllocateInfo allocInfo
+		{
+			.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+			.pNext = nullptr,
+			.allocationSize = memReqs.size,
+			.memoryTypeIndex = FindMemoryType(physicalDevice, memReqs.memoryTypeBits, properties),
+		};
+
+		VK_CHECK(vkAllocateMemory(device, &allocInfo, nullptr, &memory));
+		VK_CHECK(vkBindBufferMemory(device, buffer, memory, 0));
+
+		return memory;
+	}
+
 	QueueFamily ReserveQueueFamily(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface) {
 
 		QueueFamily family;
@@ -439,32 +649,55 @@ namespace VulkanAPI {
 
 		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, queues.data());
 
-		int i = 0;
-		for (auto q = queues.begin(); q != queues.end(); q++) {
-
-			if (q->queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-				family.graphics = i;
-			}
-			else if (q->queueFlags & VK_QUEUE_COMPUTE_BIT) {
-				family.compute = i;
-			}
-			else if (q->queueFlags & VK_QUEUE_TRANSFER_BIT) {
-				family.transfer = i;
-			}
-			else if (q->queueFlags & VK_QUEUE_SPARSE_BINDING_BIT) {
-				family.sparse_binding = i;
-			}
-
-			VkBool32 presentSupport = false;
-			vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport);
+		std::vector<VkBool32> presentSupport(count, VK_FALSE);
+		for (uint32_t i = 0; i < count; i++)
+			vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &presentSupport[i]);
 
-			if (presentSupport) {
-				family.present = i;
-			}
+		auto has = [&](uint32_t i, VkQueueFlags flags) { return (queues[i].queueFlags & flags) == flags; };
 
+		// returns the first family accepted by `pred`.
+		auto find = [&](auto pred) -> std::optional<uint32_t> {
+			for (uint32_t i = 0; i < count; i++)
+				if (pred(i))
+					return i;
+			return std::nullopt;
+		};
 
-			i++;
-
+		// GRAPHICS, prefer a family that can also present.
+		family.graphics = find([&](uint32_t i) { return has(i, VK_QUEUE_GRAPHICS_BIT) && presentSupport[i]; });
+		if (!family.graphics.has_value())
+			family.graphics = find([&](uint32_t i) { return has(i, VK_QUEUE_GRAPHICS_BIT); });
+
+		// PRESENT, stay on the graphics family when possible.
+		if (family.graphics.has_value() && presentSupport[family.graphics.value()])
+			family.present = family.graphics;
+		else
+			family.present = find([&](uint32_t i) { return presentSupport[i] == VK_TRUE; });
+
+		// COMPUTE, a family without graphics runs asynchronously to the graphics queue.
+		family.compute = find([&](uint32_t i) { return has(i, VK_QUEUE_COMPUTE_BIT) && !has(i, VK_QUEUE_GRAPHICS_BIT); });
+		if (!family.compute.has_value())
+			family.compute = find([&](uint32_t i) { return has(i, VK_QUEUE_COMPUTE_BIT); });
+
+		// TRANSFER, graphics and compute families support transfers even without the bit set.
+		// prefer a pure dma family, then the async compute family, then graphics.
+		family.transfer = find([&](uint32_t i) { return has(i, VK_QUEUE_TRANSFER_BIT) && !has(i, VK_QUEUE_GRAPHICS_BIT) && !has(i, VK_QUEUE_COMPUTE_BIT); });
+		if (!family.transfer.has_value() && family.HasAsyncCompute())
+			family.transfer = family.compute;
+		if (!family.transfer.has_value())
+			family.transfer = family.graphics;
+
+		// SPARSE BINDING
+		if (family.graphics.has_value() && has(family.graphics.value(), VK_QUEUE_SPARSE_BINDING_BIT))
+			family.sparse_binding = family.graphics;
+		else
+			family.sparse_binding = find([&](uint32_t i) { return has(i, VK_QUEUE_SPARSE_BINDING_BIT); });
+
+		// request as many queues as each used family offers, up to the cap.
+		for (auto index : { family.graphics, family.present, family.compute, family.transfer, family.sparse_binding })
+		{
+			if (index.has_value())
+				family.queueCounts[index.value()] = std::min(queues[index.value()].queueCount, MaxQueuesPerFamily);
 		}
 
 #if _DEBUG
@@ -475,6 +708,12 @@ namespace VulkanAPI {
 			<< "\t[" << (family.transfer.has_value() ? "X" : " ") << "]" << " Transfer\n" << "\t\t id: " << (family.transfer.has_value() ? std::to_string(family.transfer.value()) : " ") << "\n"
 			<< "\t[" << (family.sparse_binding.has_value() ? "X" : " ") << "]" << " Sparse Binding\n" << "\t\t id: " << (family.sparse_binding.has_value() ? std::to_string(family.sparse_binding.value()) : " ") << "\n"
 			<< "\n";
+
+		for (const auto& [index, queueCount] : family.queueCounts)
+			std::cout << "\tfamily " << index << ": " << queueCount << " queue(s)\n";
+
+		std::cout << "\tasync compute: " << (family.HasAsyncCompute() ? "yes" : "no")
+			<< ", dedicated transfer: " << (family.HasDedicatedTransfer() ? "yes" : "no") << "\n\n";
 #endif
 
 		return family;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <pch.h>
+#include <datastructures/datastructures_pch.h>
 
 #if _WIN32
 #define VK_USE_PLATFORM_WIN32_KHR
@@ -60,16 +61,53 @@ namespace VulkanAPI {
 	};
 	struct SemaphoreBlock {
 		VkSemaphore ImageAvailable;
+		VkSemaphore RenderFinished;
 	};
 
+	// a timeline semaphore value a submission has to wait on before `stage` may execute.
+	struct TimelineWait {
+		VkSemaphore semaphore = VK_NULL_HANDLE;
+		uint64_t value = 0;
+		VkPipelineStageFlags stage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	};
+
+	// optional device features, CreateDevice turns on every one the device supports.
+	struct DeviceFeatures {
+		bool timelineSemaphore = false;
+		// several draws per vkCmdDraw*Indirect call.
+		bool multiDrawIndirect = false;
+		// non zero firstInstance in indirect commands.
+		bool drawIndirectFirstInstance = false;
+		// vkCmdDraw*IndirectCount, the draw count is read from a buffer.
+		bool drawIndirectCount = false;
+		// runtime sized, partially bound descriptor arrays updated after bind, the bindless table.
+		bool descriptorIndexing = false;
+		// cull mode, front face and topology set while recording (core in 1.3, VK_EXT_extended_dynamic_state before).
+		bool extendedDynamicState = false;
+		// pipelines linked from separately built parts in little time (VK_EXT_graphics_pipeline_library).
+		bool graphicsPipelineLibrary = false;
+	};
+
+	// a submit rarely waits on more than a handful of timelines.
+	using TimelineWaitList = SmallVector<TimelineWait, 4>;
+
 	struct QueueHandleBlock {
 		VkQueue Graphics = VK_NULL_HANDLE;
 		VkQueue Present = VK_NULL_HANDLE;
 		VkQueue Compute = VK_NULL_HANDLE;
 		VkQueue Transfer = VK_NULL_HANDLE;
 		VkQueue SparseBinding = VK_NULL_HANDLE;
+
+		// every queue created on the family of a role, for parallel submission.
+		// roles sharing a family share these handles, submissions to one VkQueue must be externally synchronized.
+		std::vector<VkQueue> GraphicsQueues;
+		std::vector<VkQueue> ComputeQueues;
+		std::vector<VkQueue> TransferQueues;
 	};
 
+	// upper bound on queues requested from a single family.
+	constexpr uint32_t MaxQueuesPerFamily = 4;
+
 	struct QueueFamily {
 		std::optional<uint32_t> graphics;
 		std::optional<uint32_t> present;
@@ -77,52 +115,85 @@ namespace VulkanAPI {
 		std::optional<uint32_t> transfer;
 		std::optional<uint32_t> sparse_binding;
 
+		// number of queues to create per family index.
+		std::map<uint32_t, uint32_t> queueCounts;
+		// referenced by the create infos, must outlive vkCreateDevice.
+		std::vector<float> priorities;
+
+		std::optional<uint32_t> Get(CommandType type) const {
+			switch (type)
+			{
+			case CommandType::Graphics:
+				return graphics;
+			case CommandType::Present:
+				return present;
+			case CommandType::Compute:
+				return compute;
+			case CommandType::Transfer:
+				return transfer;
+			case CommandType::SparseBinding:
+				return sparse_binding;
+			}
+			return std::nullopt;
+		}
+
+		uint32_t GetQueueCount(CommandType type) const {
+			auto family = Get(type);
+			if (!family.has_value() || !queueCounts.contains(family.value()))
+				return 0;
+			return queueCounts.at(family.value());
+		}
+
+		// the queue a role submits to by default. roles sharing a family
+		// are spread across its queues so they can run in parallel.
+		uint32_t GetQueueIndex(CommandType type) const {
+			uint32_t count = GetQueueCount(type);
+			if (count == 0)
+				return 0;
+
+			uint32_t index = 0;
+			switch (type)
+			{
+			case CommandType::Compute:
+				index = (compute == graphics) ? 1 : 0;
+				break;
+			case CommandType::Transfer:
+				index = (transfer == graphics ? 1 : 0) + (transfer == compute ? 1 : 0);
+				break;
+			default:
+				break;
+			}
+
+			return index % count;
+		}
+
+		bool HasAsyncCompute() const { return compute.has_value() && compute != graphics; }
+		bool HasDedicatedTransfer() const { return transfer.has_value() && transfer != graphics && transfer != compute; }
 
 		std::vector<VkDeviceQueueCreateInfo> GetCreateInfo() {
 
-			float priority = 1.0f;
-
 			std::vector<VkDeviceQueueCreateInfo> queues;
 
-			if (graphics.has_value())
-				queues.push_back({
-					.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-					.pNext = nullptr,
-					.flags = 0,
-					.queueFamilyIndex = graphics.value(),
-					.queueCount = 1,
-					.pQueuePriorities = &priority
-					});
-			if (compute.has_value())
-				queues.push_back({
-					.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-					.pNext = nullptr,
-					.flags = 0,
-					.queueFamilyIndex = compute.value(),
-					.queueCount = 1,
-					.pQueuePriorities = &priority
-					});
-			if (transfer.has_value())
-				queues.push_back({
-					.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-					.pNext = nullptr,
-					.flags = 0,
-					.queueFamilyIndex = transfer.value(),
-					.queueCount = 1,
-					.pQueuePriorities = &priority
-					});
+			uint32_t maxCount = 0;
+			for (const auto& [index, count] : queueCounts)
+				maxCount = std::max(maxCount, count);
+
+			// the first queue of every family is the one graphics/present lands on.
+			priorities.assign(maxCount, 0.5f);
+			if (!priorities.empty())
+				priorities[0] = 1.0f;
 
-			if (sparse_binding.has_value())
+			// one entry per unique family, vkCreateDevice rejects duplicates.
+			for (const auto& [index, count] : queueCounts)
 				queues.push_back({
 					.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
 					.pNext = nullptr,
 					.flags = 0,
-					.queueFamilyIndex = sparse_binding.value(),
-					.queueCount = 1,
-					.pQueuePriorities = &priority
+					.queueFamilyIndex = index,
+					.queueCount = count,
+					.pQueuePriorities = priorities.data()
 					});
 
-
 			return queues;
 		};
 
@@ -135,6 +206,8 @@ namespace VulkanAPI {
 
 	VkPhysicalDevice GetPhysicalDevice(VkInstance instance);
 
+	bool SupportsDeviceExtension(VkPhysicalDevice physicalDevice, const char* extension);
+	DeviceFeatures QueryDeviceFeatures(VkPhysicalDevice physicalDevice);
 	VkDevice CreateDevice(VkInstance instance, VkPhysicalDevice physicalDevice, std::vector<std::string> enabled_layers, std::vector<std::string> enabled_extensions, VulkanAPI::QueueFamily queueFamily);
 	void FreeDevice(VkDevice& device);
 
@@ -161,6 +234,15 @@ namespace VulkanAPI {
 	void FreeSemaphoreBlock(VkDevice device, SemaphoreBlock& block);
 	SemaphoreBlock CreateSemaphoreBlock(VkDevice device);
 
+	VkSemaphore CreateTimelineSemaphore(VkDevice device, uint64_t initialValue = 0);
+	uint64_t GetTimelineValue(VkDevice device, VkSemaphore semaphore);
+	void WaitTimeline(VkDevice device, VkSemaphore semaphore, uint64_t value);
+
+	// BUFFERS
+	uint32_t FindMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeBits, VkMemoryPropertyFlags properties);
+	VkBuffer CreateBuffer(VkDevice device, VkDeviceSize size, VkBufferUsageFlags usage);
+	VkDeviceMemory AllocateBufferMemory(VkDevice device, VkPhysicalDevice physicalDevice, VkBuffer buffer, VkMemoryPropertyFlags properties);
+
 
 
 }
@@ -0,0 +1,275 @@
+#include "JobSystem.h"
+
+#include "WorkStealingDeque.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
+
+namespace Jobs {
+
+	struct Job {
+		JobFunction fn;
+		Counter* counter;
+	};
+
+	namespace {
+
+		constexpr size_t DequeCapacity = 4096;
+
+		struct Worker {
+			std::thread thread;
+			WorkStealingDeque<Job*, DequeCapacity> deque;
+		};
+
+		std::vector<std::unique_ptr<Worker>> workers;
+		std::atomic<bool> running{ false };
+
+		// submissions from non worker threads, and overflow of full deques.
+		std::mutex injectionMutex;
+		std::deque<Job*> injection;
+
+		// jobs sitting in any queue, idle workers sleep while this is zero.
+		std::atomic<uint32_t> queued{ 0 };
+		std::mutex sleepMutex;
+		std::condition_variable sleepCv;
+
+		// non worker threads block here in Wait().
+		std::mutex waitMutex;
+		std::condition_variable waitCv;
+
+		thread_local uint32_t workerIndex = UINT32_MAX;
+
+		bool IsWorker() {
+			return workerIndex < workers.size();
+		}
+
+		void Enqueue(Job* job) {
+			if (!IsWorker() || !workers[workerIndex]->deque.Push(job))
+			{
+				std::lock_guard<std::mutex> lock(injectionMutex);
+				injection.push_back(job);
+			}
+
+			queued.fetch_add(1, std::memory_order_release);
+
+			{
+				std::lock_guard<std::mutex> lock(sleepMutex);
+			}
+			sleepCv.notify_one();
+		}
+
+		Job* FindJob() {
+			Job* job = nullptr;
+
+			if (IsWorker() && workers[workerIndex]->deque.Pop(job))
+				return job;
+
+			{
+				std::lock_guard<std::mutex> lock(injectionMutex);
+				if (!injection.empty()) {
+					job = injection.front();
+					injection.pop_front();
+					return job;
+				}
+			}
+
+			// steal, starting from the next worker over so thieves spread out.
+			uint32_t count = (uint32_t)workers.size();
+			uint32_t start = IsWorker() ? workerIndex + 1 : 0;
+
+			for (uint32_t i = 0; i < count; i++)
+			{
+				uint32_t victim = (start + i) % count;
+				if (victim != workerIndex && workers[victim]->deque.Steal(job))
+					return job;
+			}
+
+			return nullptr;
+		}
+
+		void Release(Counter* counter) {
+			std::vector<Job*> ready;
+			bool done = false;
+
+			{
+				std::lock_guard<std::mutex> lock(counter->mutex);
+				done = counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1;
+				if (done)
+					ready.swap(counter->continuations);
+			}
+
+			// the counter may be gone from here on.
+			for (Job* job : ready)
+				Enqueue(job);
+
+			if (done)
+			{
+				{
+					std::lock_guard<std::mutex> lock(waitMutex);
+				}
+				waitCv.notify_all();
+			}
+		}
+
+		void Execute(Job* job) {
+			job->fn();
+
+			if (job->counter)
+				Release(job->counter);
+
+			delete job;
+		}
+
+		bool TryExecuteOne() {
+			Job* job = FindJob();
+			if (!job)
+				return false;
+
+			queued.fetch_sub(1, std::memory_order_acq_rel);
+			Execute(job);
+			return true;
+		}
+
+		void WorkerLoop(uint32_t index) {
+			workerIndex = index;
+
+			while (running.load(std::memory_order_acquire))
+			{
+				if (TryExecuteOne())
+					continue;
+
+				std::unique_lock<std::mutex> lock(sleepMutex);
+				sleepCv.wait(lock, [] { return queued.load(std::memory_order_acquire) > 0 || !running.load(std::memory_order_acquire); });
+			}
+		}
+	}
+
+	void Initialize(uint32_t workerCount)
+	{
+		if (running.load())
+			return;
+
+		if (workerCount == 0)
+			workerCount = std::max(1u, std::thread::hardware_concurrency());
+
+		running.store(true);
+
+		workers.clear();
+		for (uint32_t i = 0; i < workerCount; i++)
+			workers.push_back(std::make_unique<Worker>());
+
+		// workers only start once the vector is complete, they index into it while stealing.
+		for (uint32_t i = 0; i < workerCount; i++)
+			workers[i]->thread = std::thread(WorkerLoop, i);
+	}
+
+	void Shutdown()
+	{
+		if (!running.load())
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(sleepMutex);
+			running.store(false);
+		}
+		sleepCv.notify_all();
+
+		for (auto& worker : workers)
+			worker->thread.join();
+
+		// whatever is left never runs, the counters waiting on it are abandoned with it.
+		Job* job = nullptr;
+		for (auto& worker : workers)
+			while (worker->deque.Pop(job))
+				delete job;
+
+		for (Job* pending : injection)
+			delete pending;
+
+		injection.clear();
+		workers.clear();
+		queued.store(0);
+	}
+
+	void Run(JobFunction fn, Counter* counter, Counter* dependency)
+	{
+		if (counter)
+			counter->pending.fetch_add(1, std::memory_order_acq_rel);
+
+		Job* job = new Job{ std::move(fn), counter };
+
+		if (workers.empty())
+		{
+			Execute(job);
+			return;
+		}
+
+		if (dependency)
+		{
+			std::lock_guard<std::mutex> lock(dependency->mutex);
+			if (!dependency->IsDone()) {
+				dependency->continuations.push_back(job);
+				return;
+			}
+		}
+
+		Enqueue(job);
+	}
+
+	void Wait(Counter& counter)
+	{
+		while (!counter.IsDone())
+		{
+			if (IsWorker())
+			{
+				// keep the core busy instead of parking the worker.
+				if (!TryExecuteOne())
+					std::this_thread::yield();
+			}
+			else
+			{
+				std::unique_lock<std::mutex> lock(waitMutex);
+				waitCv.wait(lock, [&] { return counter.IsDone(); });
+			}
+		}
+
+		// the releasing thread may still hold the counter's lock, let it finish before the counter can go away.
+		std::lock_guard<std::mutex> lock(counter.mutex);
+	}
+
+	void ParallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t begin, uint32_t end)>& fn)
+	{
+		if (count == 0)
+			return;
+
+		grain = std::max(1u, grain);
+
+		if (workers.empty() || count <= grain)
+		{
+			fn(0, count);
+			return;
+		}
+
+		Counter counter;
+
+		for (uint32_t begin = 0; begin < count; begin += grain)
+		{
+			uint32_t end = std::min(count, begin + grain);
+			Run([&fn, begin, end] { fn(begin, end); }, &counter);
+		}
+
+		Wait(counter);
+	}
+
+	uint32_t GetWorkerCount()
+	{
+		return (uint32_t)workers.size();
+	}
+
+	uint32_t GetWorkerIndex()
+	{
+		return IsWorker() ? workerIndex : GetWorkerCount();
+	}
+}
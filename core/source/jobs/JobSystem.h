@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Work stealing task scheduler.
+//
+// one worker thread per core, each owning a Chase-Lev deque. jobs pushed from
+// a worker land in its own deque, jobs from any other thread go through a
+// shared injection queue. idle workers steal from each other.
+//
+// waiting on a Counter from a worker keeps executing other jobs, so workers
+// are never parked on a dependency. other threads block until it is done.
+namespace Jobs {
+
+	using JobFunction = std::function<void()>;
+
+	struct Job;
+
+	// tracks outstanding jobs. reaching zero wakes waiters and releases the
+	// jobs that were submitted with this counter as their dependency.
+	// a counter must outlive every job referencing it.
+	struct Counter {
+		Counter() = default;
+		Counter(const Counter&) = delete;
+		Counter& operator=(const Counter&) = delete;
+
+		bool IsDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+		std::atomic<uint32_t> pending{ 0 };
+
+		std::mutex mutex;
+		std::vector<Job*> continuations;
+	};
+
+	// workerCount 0 spawns one worker per hardware thread.
+	void Initialize(uint32_t workerCount = 0);
+	void Shutdown();
+
+	// queues `job`. when `counter` is set it is incremented now and decremented once the job ran.
+	// when `dependency` is set the job is held back until that counter reaches zero.
+	// without workers (not initialized) the job runs inline.
+	void Run(JobFunction job, Counter* counter = nullptr, Counter* dependency = nullptr);
+
+	void Wait(Counter& counter);
+
+	// splits [0, count) into ranges of `grain` indices and runs them across the workers.
+	// returns once every range finished.
+	void ParallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t begin, uint32_t end)>& fn);
+
+	uint32_t GetWorkerCount();
+
+	// index of the calling worker in [0, GetWorkerCount()), GetWorkerCount() for any other thread.
+	uint32_t GetWorkerIndex();
+}
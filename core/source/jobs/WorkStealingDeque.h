@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+
+namespace Jobs {
+
+	// Chase-Lev work stealing deque (Le, Pop, Cohen, Zappa Nardelli - PPoPP 2013).
+	//
+	// the owning worker pushes and pops at the bottom, every other worker steals
+	// from the top. capacity is fixed, Push() fails instead of growing.
+	template<typename T, size_t Capacity>
+	class WorkStealingDeque {
+		static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	public:
+		// owner only.
+		bool Push(T item) {
+			int64_t b = bottom.load(std::memory_order_relaxed);
+			int64_t t = top.load(std::memory_order_acquire);
+
+			if (b - t >= (int64_t)Capacity)
+				return false;
+
+			buffer[b & Mask].store(item, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			bottom.store(b + 1, std::memory_order_relaxed);
+
+			return true;
+		}
+
+		// owner only.
+		bool Pop(T& out) {
+			int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+			bottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t t = top.load(std::memory_order_relaxed);
+
+			if (t > b) {
+				// empty
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return false;
+			}
+
+			out = buffer[b & Mask].load(std::memory_order_relaxed);
+
+			if (t == b) {
+				// last item, race the thieves for it.
+				bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+				bottom.store(b + 1, std::memory_order_relaxed);
+				return won;
+			}
+
+			return true;
+		}
+
+		// any thread.
+		bool Steal(T& out) {
+			int64_t t = top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t b = bottom.load(std::memory_order_acquire);
+
+			if (t >= b)
+				return false;
+
+			T item = buffer[t & Mask].load(std::memory_order_relaxed);
+
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return false;
+
+			out = item;
+			return true;
+		}
+
+		size_t Size() const {
+			int64_t b = bottom.load(std::memory_order_relaxed);
+			int64_t t = top.load(std::memory_order_relaxed);
+			return b > t ? (size_t)(b - t) : 0;
+		}
+
+	private:
+		static constexpr int64_t Mask = (int64_t)Capacity - 1;
+
+		alignas(64) std::atomic<int64_t> top{ 0 };
+		alignas(64) std::atomic<int64_t> bottom{ 0 };
+		alignas(64) std::array<std::atomic<T>, Capacity> buffer{};
+	};
+
+}
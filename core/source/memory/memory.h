@@ -1,7 +1,6 @@
 #pragma once
 
 #include <graphics/vulkan_api.h>
-#include <map>
 
 enum class MemoryType {
 	Instance,
@@ -12,7 +11,7 @@ enum class MemoryType {
 namespace Memory {
 
 
-	std::map<MemoryType, std::vector<void*>> MemoryPool;
+	FlatHashMap<MemoryType, std::vector<void*>> MemoryPool;
 	/// DOX TEST!!!
 	void* Allocate(void* pUserData, size_t size, size_t alignment, VkSystemAllocationScope scope) {
 
@@ -24,11 +23,7 @@ namespace Memory {
 		{
 		case MemoryType::Instance:
 		{
-			// if this is the first time this is running..
-			// the pools need to be initilized..
-			if (MemoryPool.find(type) == MemoryPool.end())
-				MemoryPool.insert({ MemoryType::Instance, {} });
-
+			// the pool is created on first use.
 			MemoryPool[MemoryType::Instance].push_back(memory);
 		}
 			break;
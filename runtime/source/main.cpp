@@ -5,6 +5,8 @@
 #include <GLFW/glfw3.h>
 
 #include <graphics/Rendering/renderer.h>
+#include <jobs/JobSystem.h>
+#include <filesystem/AsyncIO.h>
 #include <debug/Console.h>
 
 namespace glfw
@@ -29,6 +31,9 @@ Renderer renderer;
 
 #define ENABLE_AUTOMATED_TESTING 1
 #define ENABLE_VISUAL_TESTING 1
+#define ENABLE_RENDER_THREAD 1
+// sprites pushed through the batcher every frame, 0 disables the stress scene. try 100000.
+#define SPRITE_DEMO_COUNT 0
 
 #if ENABLE_AUTOMATED_TESTING
 #include "UnitTests.hpp"
@@ -45,6 +50,12 @@ int main() {
 	Console::Log("Process Started.");
 	Console::Log("Starting Test");
 
+	Jobs::Initialize();
+	Console::Log("Job System Started, Workers: ", Jobs::GetWorkerCount());
+
+	// shaders and assets load through it.
+	AsyncIO::Initialize();
+
 	Console::Log("Initillizing Window ", "Width: ", WIDTH, " Height: ", HEIGHT);
 	InitilizeWindow();
 	Console::Success("Window Initilized Successfully");
@@ -57,15 +68,59 @@ int main() {
 	Console::Success("Renderer Initilized Successfully");
 	Console::Log("Starting Update Loop");
 
+#if ENABLE_RENDER_THREAD
+	// the main thread only pumps events and builds frames, the render thread draws them.
+	renderer.StartRenderThread(2);
+#endif
+
+	uint64_t frame = 0;
+	double last = glfwGetTime();
+
 	while (!glfwWindowShouldClose(glfw::window)) {
 		//Console::Info("Updating");
-
-		renderer.RenderFrame();
-		renderer.PresentFrame();
 		glfwPollEvents();
+
+		double now = glfwGetTime();
+
+		FramePacket packet;
+		// storage of a frame the renderer finished, refilled without allocating.
+		packet.sprites = renderer.AcquireSpriteBatch();
+		packet.frame = ++frame;
+		packet.time = now;
+		packet.deltaTime = now - last;
+		last = now;
+
+#if SPRITE_DEMO_COUNT
+		{
+			constexpr uint32_t columns = 316;
+			constexpr float cell = 2.0f / columns;
+
+			SpriteBatch& sprites = packet.sprites;
+			sprites.Reserve(SPRITE_DEMO_COUNT);
+
+			for (uint32_t i = 0; i < SPRITE_DEMO_COUNT; i++)
+			{
+				Sprite sprite;
+				sprite.x = -1.0f + cell * ((i % columns) + 0.5f);
+				sprite.y = -1.0f + cell * ((i / columns) + 0.5f);
+				sprite.width = sprite.height = cell * 0.75f;
+				sprite.rotation = (float)now + i * 0.01f;
+				sprite.color = 0xFF000000 | (i * 2654435761u >> 8);
+				sprite.layer = i % 4;
+
+				sprites.Add(sprite);
+			}
+		}
+#endif
+
+		renderer.SubmitFrame(std::move(packet));
 	}
+
+	renderer.StopRenderThread();
 	Console::Log("Application Closed, Performing Cleanup.");
 	renderer.Cleanup();
+	AsyncIO::Shutdown();
+	Jobs::Shutdown();
 
 	Console::Log("Cleanup Finished Closing Process.");
 #endif
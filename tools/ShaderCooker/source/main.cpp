@@ -0,0 +1,68 @@
+#include <atomic>
+#include <filesystem>
+
+#include <graphics/Rendering/Pipelines/PipelineShaders.h>
+#include <jobs/JobSystem.h>
+#include <filesystem/AsyncIO.h>
+#include <debug/Console.h>
+
+// ShaderCooker [shader directory] [archive]
+//
+// generates the glsl of every pipeline shader and all of its variants, compiles
+// them to SPIR-V on the job workers and packs the result into one archive the
+// runtime loads at startup. defaults to Shaders/ and Shaders/shaders.pak.
+//
+// the cache key covers the optimizer flags, cook with the configuration the
+// runtime is built in or it compiles the shaders again.
+int main(int argc, char** argv)
+{
+	std::string directory = argc > 1 ? argv[1] : ShaderDefinition::GetDirectory();
+	std::string archive = argc > 2 ? argv[2] : (std::filesystem::path(directory) / "shaders.pak").generic_string();
+
+	Jobs::Initialize();
+	AsyncIO::Initialize();
+
+	ShaderCache cache((std::filesystem::path(directory) / "cache").generic_string());
+
+	const auto& definitions = PipelineShaders::GetDefinitions();
+	std::atomic<uint32_t> failed{ 0 };
+
+	// each definition compiles its own variants in parallel too.
+	Jobs::ParallelFor((uint32_t)definitions.size(), 1, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++)
+		{
+			const ShaderDefinition& definition = definitions[i];
+
+			// no device, the graph only produces SPIR-V into the cache.
+			ShaderGraph shader(VK_NULL_HANDLE, definition.GetPath(directory), definition.stage);
+			shader.LinkCache(&cache);
+			definition.define(shader);
+
+			if (!shader.Compile())
+			{
+				Console::Error("Shader Compilation Failed: ", definition.name);
+				failed++;
+			}
+		}
+	});
+
+	bool written = failed == 0 && cache.WriteArchive(archive);
+
+	AsyncIO::Shutdown();
+	Jobs::Shutdown();
+
+	if (failed > 0)
+	{
+		Console::Error("Shader Cooking Failed: ", failed.load(), " Of ", definitions.size(), " Shaders Did Not Compile");
+		return 1;
+	}
+
+	if (!written)
+	{
+		Console::Error("Shader Archive Could Not Be Written: ", archive);
+		return 1;
+	}
+
+	Console::Log("Shader Archive Written: ", archive, " (", cache.GetEntryCount(), " Modules)");
+	return 0;
+}